@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <boost/sml/utility/actor_runtime.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr auto actors = 1'000;
+constexpr auto hops = 10;
+#else
+constexpr auto actors = 100'000;
+constexpr auto hops = 1'000;
+#endif
+
+struct packet {
+  unsigned next{};
+  int hops{};
+};
+struct disconnect {};
+
+void forward(const packet &);
+
+struct session {
+  auto operator()() const noexcept {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      * "connected"_s + event<packet> / [](const packet& p) { forward(p); } = "active"_s,
+        "active"_s + event<packet> / [](const packet& p) { forward(p); },
+        "active"_s + event<disconnect> = X
+    );
+    // clang-format on
+  }
+};
+
+using actor_t = sml::utility::actor<sml::sm<session>>;
+std::vector<actor_t *> sessions{};
+
+void forward(const packet &p) {
+  if (p.hops) {
+    const auto next = p.next * 1103515245u + 12345u;
+    sessions[next % sessions.size()]->send(packet{next, p.hops - 1});
+  }
+}
+
+int main() {
+  for (auto workers = 1u; workers <= 64u; workers *= 2) {
+    sml::utility::actor_runtime runtime{workers};
+    sessions.clear();
+    for (auto i = 0; i < actors; ++i) {
+      sessions.push_back(&runtime.spawn<sml::sm<session>>());
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (auto i = 0u; i < sessions.size(); ++i) {
+      sessions[i]->send(packet{i, hops});
+    }
+    runtime.wait_idle();
+    const auto finish = std::chrono::high_resolution_clock::now();
+
+    const auto events = static_cast<double>(actors) * (hops + 1);
+    const auto seconds = std::chrono::duration<double>(finish - start).count();
+    std::printf("workers: %2u, events/sec: %.0f\n", workers, events / seconds);
+  }
+}
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <boost/sml/utility/process_batch.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+#include "benchmark.hpp"
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr auto instances = 10'000;
+constexpr auto rounds = 1;
+#else
+constexpr auto instances = 1'000'000;
+constexpr auto rounds = 10;
+#endif
+
+struct tick {
+  int value{};
+};
+
+struct stats {
+  long sum = 0;
+};
+
+struct cycle {
+  auto operator()() const noexcept {
+    using namespace sml;
+    const auto add = [](const tick& t, stats& s) { s.sum += t.value; };
+    const auto sub = [](const tick& t, stats& s) { s.sum -= t.value; };
+    // clang-format off
+    return make_transition_table(
+      * "s0"_s + event<tick> / add = "s1"_s,
+        "s1"_s + event<tick> / sub = "s2"_s,
+        "s2"_s + event<tick> / add = "s3"_s,
+        "s3"_s + event<tick> / sub = "s4"_s,
+        "s4"_s + event<tick> / add = "s5"_s,
+        "s5"_s + event<tick> / sub = "s6"_s,
+        "s6"_s + event<tick> / add = "s7"_s,
+        "s7"_s + event<tick> / sub = "s0"_s
+    );
+    // clang-format on
+  }
+};
+
+int main() {
+  std::mt19937 random{};
+  stats s{};
+  std::vector<sml::sm<cycle>> sms(instances, sml::sm<cycle>{s});
+  for (auto i = 0u; i < sms.size(); ++i) {
+    for (auto n = 0u; n < random() % 8; ++n) {
+      sms[i].process_event(tick{1});
+    }
+  }
+
+  /// every instance receives the event once per round, in random order
+  std::vector<std::pair<std::size_t, tick>> batch(instances);
+  for (auto i = 0u; i < batch.size(); ++i) {
+    batch[i] = {i, tick{static_cast<int>(random() % 100)}};
+  }
+  std::shuffle(batch.begin(), batch.end(), random);
+  std::vector<char> handled(batch.size());
+
+  benchmark_execution_speed([&] {
+    for (auto n = 0; n < rounds; ++n) {
+      for (auto i = 0u; i < batch.size(); ++i) {
+        handled[i] = sms[batch[i].first].process_event(batch[i].second);
+      }
+    }
+  });
+  benchmark_execution_speed([&] {
+    for (auto n = 0; n < rounds; ++n) {
+      sml::utility::process_batch(sms.data(), batch.begin(), batch.end(), handled.begin());
+    }
+  });
+}
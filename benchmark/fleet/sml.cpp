@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <boost/sml/utility/fleet.hpp>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "benchmark.hpp"
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr auto instances = 10'000;
+constexpr auto events = 100'000;
+#else
+constexpr auto instances = 10'000'000;
+constexpr auto events = 50'000'000;
+#endif
+
+struct collision {};
+struct tick {};
+
+struct stats {
+  long collisions = 0;
+};
+
+struct particle {
+  auto operator()() const noexcept {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      * "moving"_s + event<collision> / [](stats& s) { ++s.collisions; } = "bouncing"_s,
+        "bouncing"_s + event<tick> = "moving"_s,
+        "bouncing"_s + event<collision> / [](stats& s) { ++s.collisions; }
+    );
+    // clang-format on
+  }
+};
+
+template <class T>
+void simulate(T &process_event) {
+  std::mt19937 random{};
+  for (auto i = 0; i < events; ++i) {
+    const auto instance = random() % instances;
+    if (i % 2) {
+      process_event(instance, collision{});
+    } else {
+      process_event(instance, tick{});
+    }
+  }
+}
+
+int main() {
+  stats s{};
+  {
+    std::vector<sml::sm<particle>> particles(instances, sml::sm<particle>{s});
+    auto process_event = [&](const unsigned i, const auto &event) { particles[i].process_event(event); };
+    benchmark_execution_speed([&] { simulate(process_event); });
+    benchmark_memory_usage(particles[0]);
+  }
+  {
+    sml::utility::fleet<sml::sm<particle>> particles{instances, s};
+    auto process_event = [&](const unsigned i, const auto &event) { particles.process_event(i, event); };
+    benchmark_execution_speed([&] { simulate(process_event); });
+#if !defined(CHECK_COMPILE_TIME)
+    std::printf("memory usage: %db\n", sml::sm<particle>::instance_size());
+#endif
+  }
+  {
+    sml::utility::fleet<sml::sm<particle>> particles{instances, s};
+    benchmark_execution_speed([&] {
+      for (auto n = 0; n < events / instances; ++n) {
+        for (auto i = 0u; i < particles.size(); ++i) {
+          particles.process_event(i, tick{});
+        }
+      }
+    });
+    benchmark_execution_speed([&] {
+      for (auto n = 0; n < events / instances; ++n) {
+        particles.broadcast(tick{});
+      }
+    });
+  }
+  if (!s.collisions) {
+    return 1;
+  }
+}
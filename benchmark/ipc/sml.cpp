@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/sml.hpp>
+#include <boost/sml/utility/ipc_channel.hpp>
+#include <chrono>
+#include <cstdio>
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr long events = 100'000;
+#else
+constexpr long events = 10'000'000;
+#endif
+
+struct packet {
+  long sequence{};
+  int bytes{};
+};
+struct stream_end {};
+
+struct stats {
+  long packets = 0;
+  long bytes = 0;
+};
+
+struct protocol {
+  auto operator()() const noexcept {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      * "receiving"_s + event<packet> / [](const packet& p, stats& s) { ++s.packets; s.bytes += p.bytes; },
+        "receiving"_s + event<stream_end> = X
+    );
+    // clang-format on
+  }
+};
+
+using protocol_sm = sml::sm<protocol>;
+using channel_t = sml::utility::ipc_channel<protocol_sm>;
+
+/// the packet capture process is forked, the state machine is driven by the current process
+template <class TProduce, class TConsume>
+bool run(const char *name, const TProduce &produce, const TConsume &consume) {
+  const auto start = std::chrono::high_resolution_clock::now();
+  const auto producer = ::fork();
+  if (!producer) {
+    produce();
+    ::_exit(0);
+  }
+  stats s{};
+  protocol_sm sm{s};
+  consume(sm);
+  const auto finish = std::chrono::high_resolution_clock::now();
+  ::waitpid(producer, nullptr, 0);
+
+  const auto seconds = std::chrono::duration<double>(finish - start).count();
+  std::printf("%s: events/sec: %.0f\n", name, events / seconds);
+  return s.packets == events && sm.is(sml::X);
+}
+
+int main() {
+  int sockets[2];
+  ::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets);
+  const auto unix_socket = run(
+      "unix socket",
+      [&] {
+        for (auto i = 0l; i < events; ++i) {
+          const packet p{i, 64};
+          (void)::write(sockets[0], &p, sizeof(p));
+        }
+        const auto end = stream_end{};
+        (void)::write(sockets[0], &end, sizeof(end));
+      },
+      [&](protocol_sm &sm) {
+        packet p{};
+        while (!sm.is(sml::X)) {
+          if (::read(sockets[1], &p, sizeof(p)) == sizeof(p)) {
+            sm.process_event(p);
+          } else {
+            sm.process_event(stream_end{});
+          }
+        }
+      });
+
+  const auto fd = ::memfd_create("protocol", 0);
+  sml::utility::shared_segment segment{fd, channel_t::segment_size()};
+  channel_t channel{segment.data(), segment.size()};
+  const auto shared_memory = run(
+      "ipc_channel",
+      [&] {
+        for (auto i = 0l; i < events; ++i) {
+          channel.send(packet{i, 64});
+        }
+        channel.send(stream_end{});
+      },
+      [&](protocol_sm &sm) {
+        while (!sm.is(sml::X)) {
+          channel.run_once(sm);
+        }
+      });
+
+  if (!unix_socket || !shared_memory) {
+    std::printf("failed\n");
+    return 1;
+  }
+}
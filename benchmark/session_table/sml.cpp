@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <boost/sml/utility/session_table.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "benchmark.hpp"
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr auto sessions_size = 10'000;
+constexpr auto events_size = 100'000;
+#else
+constexpr auto sessions_size = 1'000'000;
+constexpr auto events_size = 10'000'000;
+#endif
+
+struct packet {
+  int bytes{};
+};
+struct timeout {};
+
+struct session {
+  auto operator()() const noexcept {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      * "connected"_s + event<packet> [([](const packet& p) { return p.bytes > 0; })] = "active"_s,
+        "connected"_s + event<timeout> = X,
+        "active"_s + event<packet> [([](const packet& p) { return p.bytes > 0; })],
+        "active"_s + event<timeout> = X
+    );
+    // clang-format on
+  }
+};
+
+int main() {
+  std::mt19937_64 random{};
+  std::vector<std::uint64_t> ids(sessions_size);
+  for (auto& id : ids) {
+    id = random();
+  }
+  std::vector<std::uint64_t> keys(events_size);
+  std::vector<packet> packets(events_size);
+  for (auto i = 0u; i < keys.size(); ++i) {
+    keys[i] = ids[random() % ids.size()];
+    packets[i].bytes = static_cast<int>(i % 1500) + 1;
+  }
+
+  sml::utility::session_table<sml::sm<session>, std::uint64_t> sessions{sessions_size};
+  for (const auto id : ids) {
+    sessions.emplace(id);
+  }
+
+  auto handled = std::size_t{};
+  benchmark_execution_speed([&] {
+    for (auto i = 0u; i < keys.size(); ++i) {
+      handled += sessions.dispatch(keys[i], packets[i]);
+    }
+  });
+  benchmark_execution_speed([&] { handled += sessions.dispatch(keys.begin(), keys.end(), packets.begin()); });
+
+  for (const auto id : ids) {
+    sessions.dispatch(id, timeout{});
+  }
+  if (handled != keys.size() * 2 || !sessions.empty()) {
+    std::printf("failed\n");
+    return 1;
+  }
+}
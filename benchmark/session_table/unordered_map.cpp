@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "benchmark.hpp"
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr auto sessions_size = 10'000;
+constexpr auto events_size = 100'000;
+#else
+constexpr auto sessions_size = 1'000'000;
+constexpr auto events_size = 10'000'000;
+#endif
+
+struct packet {
+  int bytes{};
+};
+struct timeout {};
+
+struct session {
+  auto operator()() const noexcept {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      * "connected"_s + event<packet> [([](const packet& p) { return p.bytes > 0; })] = "active"_s,
+        "connected"_s + event<timeout> = X,
+        "active"_s + event<packet> [([](const packet& p) { return p.bytes > 0; })],
+        "active"_s + event<timeout> = X
+    );
+    // clang-format on
+  }
+};
+
+int main() {
+  std::mt19937_64 random{};
+  std::vector<std::uint64_t> ids(sessions_size);
+  for (auto& id : ids) {
+    id = random();
+  }
+  std::vector<std::uint64_t> keys(events_size);
+  std::vector<packet> packets(events_size);
+  for (auto i = 0u; i < keys.size(); ++i) {
+    keys[i] = ids[random() % ids.size()];
+    packets[i].bytes = static_cast<int>(i % 1500) + 1;
+  }
+
+  std::unordered_map<std::uint64_t, sml::sm<session>> sessions{};
+  sessions.reserve(sessions_size);
+  for (const auto id : ids) {
+    sessions.emplace(id, sml::sm<session>{});
+  }
+
+  auto handled = std::size_t{};
+  benchmark_execution_speed([&] {
+    for (auto i = 0u; i < keys.size(); ++i) {
+      const auto it = sessions.find(keys[i]);
+      if (it != sessions.end()) {
+        handled += it->second.process_event(packets[i]);
+      }
+    }
+  });
+
+  for (const auto id : ids) {
+    auto& sm = sessions.at(id);
+    sm.process_event(timeout{});
+    if (sm.is(sml::X)) {
+      sessions.erase(id);
+    }
+  }
+  if (handled != keys.size() || !sessions.empty()) {
+    std::printf("failed\n");
+    return 1;
+  }
+}
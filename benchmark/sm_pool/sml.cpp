@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <boost/sml/utility/sm_pool.hpp>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include "benchmark.hpp"
+
+namespace sml = boost::sml;
+
+#if defined(CHECK_COMPILE_TIME)
+constexpr auto sessions_size = 10'000;
+#else
+constexpr auto sessions_size = 10'000'000;
+#endif
+
+struct accept {};
+struct request {};
+struct hangup {};
+
+struct stats {
+  int accepted = 0;
+  int requests = 0;
+};
+
+struct session {
+  auto operator()() const noexcept {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      * "listening"_s + on_entry<_> / [](stats& s) { ++s.accepted; },
+        "listening"_s + event<accept> = "handshake"_s,
+        "handshake"_s + event<request> / defer,
+        "handshake"_s + event<accept> = "established"_s,
+        "established"_s + event<request> / [](stats& s) { ++s.requests; },
+        "established"_s + event<hangup> = X
+    );
+    // clang-format on
+  }
+};
+
+using session_t = sml::sm<session, sml::defer_queue<std::deque>>;
+
+template <class T>
+void serve(T& session) {
+  session.process_event(accept{});
+  session.process_event(request{});
+  session.process_event(accept{});
+  session.process_event(hangup{});
+}
+
+int main() {
+  stats s{};
+  benchmark_execution_speed([&] {
+    for (auto i = 0; i < sessions_size; ++i) {
+      std::unique_ptr<session_t> session{new session_t{s}};
+      serve(*session);
+    }
+  });
+
+  sml::utility::sm_pool<session_t> sessions{16, s};
+  benchmark_execution_speed([&] {
+    for (auto i = 0; i < sessions_size; ++i) {
+      auto session = sessions.acquire();
+      serve(*session);
+    }
+  });
+
+  if (s.accepted != sessions_size * 2 + 16 || s.requests != sessions_size * 2 || sessions.size() != 16) {
+    std::printf("failed\n");
+    return 1;
+  }
+}
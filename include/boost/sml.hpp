@@ -490,12 +490,22 @@ struct string<T> {
 }
 namespace back {
 namespace policies {
+struct async_executor_policy__ {};
+template <class T>
+struct async_executor : aux::pair<async_executor_policy__, async_executor<T>> {
+  using type = T;
+};
+}
+}
+namespace back {
+namespace policies {
 struct defer_queue_policy__ {};
-template <template <class...> class T>
-struct defer_queue : aux::pair<back::policies::defer_queue_policy__, defer_queue<T>> {
+template <template <class...> class T, class TAllocator = void>
+struct defer_queue : aux::pair<back::policies::defer_queue_policy__, defer_queue<T, TAllocator>> {
   template <class U>
   using rebind = T<U>;
   using flag = bool;
+  using allocator = TAllocator;
 };
 }
 }
@@ -545,9 +555,95 @@ class queue_event {
   void (*dtor)(aux::byte *);
   void (*move)(aux::byte (&)[size], queue_event &&);
 };
+template <class T, class = void>
+struct is_coalescing : aux::false_type {};
+template <class T>
+struct is_coalescing<T, aux::void_t<aux::integral_constant<bool, T::coalesce>>> : aux::integral_constant<bool, T::coalesce> {};
+template <class... Ts>
+using coalescing_events_t = aux::join_t<aux::conditional_t<is_coalescing<Ts>::value, aux::type_list<Ts>, aux::type_list<>>...>;
+template <class TQueue, class TEvents, class = aux::apply_t<coalescing_events_t, TEvents>>
+class coalescing_queue;
+template <class TQueue, class... TEvents, class... TCoalescing>
+class coalescing_queue<TQueue, aux::type_list<TEvents...>, aux::type_list<TCoalescing...>> : public TQueue {
+  using ids_t = aux::type_id<TCoalescing...>;
+  template <class T>
+  static constexpr int slot(const aux::true_type &) {
+    return aux::get_id<int, T>((ids_t *)0);
+  }
+  template <class>
+  static constexpr int slot(const aux::false_type &) {
+    return -1;
+  }
+  static int slot(const int id) {
+    static constexpr int slots[] = {slot<TEvents>(is_coalescing<TEvents>{})...};
+    return slots[id];
+  }
+  void acquire(const int id) {
+    const auto index = slot(id);
+    if (index >= 0) {
+      ++pending_[index];
+    }
+  }
+  void release(const int id) {
+    const auto index = slot(id);
+    if (index >= 0) {
+      --pending_[index];
+    }
+  }
+
+ public:
+  using value_type = typename TQueue::value_type;
+  using TQueue::TQueue;
+  void push(value_type &&event) {
+    acquire(event.id);
+    TQueue::push(static_cast<value_type &&>(event));
+  }
+  void push_back(value_type &&event) {
+    acquire(event.id);
+    TQueue::push_back(static_cast<value_type &&>(event));
+  }
+  value_type &front() {
+    auto &event = TQueue::front();
+    front_ = event.id;
+    return event;
+  }
+  void pop() {
+    release(front_);
+    TQueue::pop();
+  }
+  template <class TIterator>
+  auto erase(const TIterator &it) {
+    release(it->id);
+    return TQueue::erase(it);
+  }
+  bool superseded(const int id) const {
+    const auto index = slot(id);
+    return index >= 0 && pending_[index] > 1;
+  }
+
+ private:
+  int pending_[sizeof...(TCoalescing)]{};
+  int front_{};
+};
+template <class TQueue>
+constexpr bool is_superseded(const TQueue &, const int) {
+  return false;
+}
+template <class TQueue, class TEvents, class TCoalescing>
+bool is_superseded(const coalescing_queue<TQueue, TEvents, TCoalescing> &queue, const int id) {
+  return queue.superseded(id);
+}
+template <class TQueue, class TIterator>
+constexpr bool refill(TQueue &, TIterator &) {
+  return false;
+}
+template <class TQueue, class TEvents, class TCoalescing, class TIterator>
+bool refill(coalescing_queue<TQueue, TEvents, TCoalescing> &queue, TIterator &it) {
+  return refill(static_cast<TQueue &>(queue), it);
+}
 template <class TEvent>
 class queue_event_call {
-  using call_t = void (*)(void *, const TEvent &);
+  using call_t = void (*)(void *, TEvent &&);
 
  public:
   queue_event_call() = default;
@@ -562,13 +658,18 @@ struct queue_handler : queue_event_call<TEvents>... {
       : queue_event_call<TEvents>(queue_handler::push_impl<TQueue, TEvents>)..., queue_{&queue} {}
   template <class TEvent>
   void operator()(const TEvent &event) {
-    static_cast<queue_event_call<TEvent> *>(this)->call(queue_, event);
+    static_cast<queue_event_call<TEvent> *>(this)->call(queue_, TEvent(event));
+  }
+  template <class TEvent,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_const_t<aux::remove_reference_t<TEvent>>, TEvent>::value)>
+  void operator()(TEvent &&event) {
+    static_cast<queue_event_call<TEvent> *>(this)->call(queue_, static_cast<TEvent &&>(event));
   }
 
  private:
   template <class TQueue, class TEvent>
-  static auto push_impl(void *queue, const TEvent &event) {
-    static_cast<TQueue *>(queue)->push(event);
+  static auto push_impl(void *queue, TEvent &&event) {
+    static_cast<TQueue *>(queue)->push(static_cast<TEvent &&>(event));
   }
   void *queue_{};
 };
@@ -580,13 +681,18 @@ struct deque_handler : queue_event_call<TEvents>... {
       : queue_event_call<TEvents>(deque_handler::push_impl<TDeque, TEvents>)..., deque_{&deque} {}
   template <class TEvent>
   void operator()(const TEvent &event) {
-    static_cast<queue_event_call<TEvent> *>(this)->call(deque_, event);
+    static_cast<queue_event_call<TEvent> *>(this)->call(deque_, TEvent(event));
+  }
+  template <class TEvent,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_const_t<aux::remove_reference_t<TEvent>>, TEvent>::value)>
+  void operator()(TEvent &&event) {
+    static_cast<queue_event_call<TEvent> *>(this)->call(deque_, static_cast<TEvent &&>(event));
   }
 
  private:
   template <class TDeque, class TEvent>
-  static auto push_impl(void *deque, const TEvent &event) {
-    static_cast<TDeque *>(deque)->push_back(event);
+  static auto push_impl(void *deque, TEvent &&event) {
+    static_cast<TDeque *>(deque)->push_back(static_cast<TEvent &&>(event));
   }
   void *deque_{};
 };
@@ -596,6 +702,7 @@ struct _ {};
 struct initial {};
 struct unexpected {};
 struct entry_exit {};
+struct no_action {};
 struct terminate_state {
   static auto c_str() { return "terminate"; }
 };
@@ -605,6 +712,9 @@ struct internal_event {
 struct anonymous : internal_event {
   static auto c_str() { return "anonymous"; }
 };
+struct timeout {
+  static auto c_str() { return "timeout"; }
+};
 template <class T, class TEvent = T>
 struct on_entry : internal_event, entry_exit {
   static auto c_str() { return "on_entry"; }
@@ -719,6 +829,9 @@ using get_sub_internal_events =
                 typename get_sub_internal_events_impl<typename Ts::dst_state, typename Ts::event>::type...>;
 template <class... Ts>
 using get_events = aux::type_list<typename Ts::event...>;
+template <class... Ts>
+using get_timeout_transitions = aux::join_t<
+    typename aux::conditional<aux::is_same<timeout, typename Ts::event>::value, aux::type_list<Ts>, aux::type_list<>>::type...>;
 template <class T>
 struct get_exception : aux::type_list<> {};
 template <class T>
@@ -734,6 +847,82 @@ template <class... Ts>
 using get_history_states = aux::join_t<
     typename aux::conditional<!Ts::history && Ts::initial, aux::type_list<typename Ts::src_state>, aux::type_list<>>::type...>;
 template <class>
+struct is_sub_sm : aux::false_type {};
+template <class T>
+struct is_sub_sm<sm<T>> : aux::true_type {};
+template <class TStates, class TInitialStates, class TTransitions>
+struct regions_masks;
+template <class... TStates, class... TInitialStates, class... TTransitions>
+struct regions_masks<aux::type_list<TStates...>, aux::type_list<TInitialStates...>, aux::type_list<TTransitions...>> {
+  using ids_t = aux::type_id<TStates...>;
+  using mask_t = unsigned long long;
+  struct masks {
+    mask_t value[sizeof...(TStates)];
+  };
+  static constexpr masks make() {
+    constexpr int initial[] = {aux::get_id<int, TInitialStates>((ids_t *)0)...};
+    constexpr int src[] = {-1, aux::get_id<int, typename TTransitions::src_state>((ids_t *)0)...};
+    constexpr int dst[] = {-1, aux::get_id<int, typename TTransitions::dst_state>((ids_t *)0)...};
+    masks m{};
+    for (auto r = 0; r < int(sizeof...(TInitialStates)); ++r) {
+      m.value[initial[r]] |= mask_t(1) << r;
+    }
+    for (auto changed = true; changed;) {
+      changed = false;
+      for (auto i = 1; i <= int(sizeof...(TTransitions)); ++i) {
+        const auto mask = m.value[dst[i]] | m.value[src[i]];
+        changed |= mask != m.value[dst[i]];
+        m.value[dst[i]] = mask;
+      }
+    }
+    return m;
+  }
+  static constexpr mask_t sub_sms() {
+    constexpr masks m = make();
+    constexpr bool sub_sm[] = {is_sub_sm<TStates>::value...};
+    mask_t mask = 0;
+    for (auto i = 0; i < int(sizeof...(TStates)); ++i) {
+      mask |= sub_sm[i] ? m.value[i] : 0;
+    }
+    return mask;
+  }
+  template <class... Ts>
+  static constexpr mask_t get(const aux::type_list<Ts...> &) {
+    constexpr masks m = make();
+    mask_t mask = sub_sms();
+    (void)aux::swallow{0, (mask |= m.value[aux::get_id<int, Ts>((ids_t *)0)], 0)...};
+    return mask;
+  }
+  template <class TDep, class... TDeps>
+  static constexpr bool has_dep(const aux::type_list<TDeps...> &) {
+    constexpr bool deps[] = {false, aux::is_same<TDep, aux::remove_const_t<aux::remove_reference_t<TDeps>>>::value...};
+    auto found = false;
+    for (const auto dep : deps) {
+      found |= dep;
+    }
+    return found;
+  }
+  template <class TDep>
+  static constexpr mask_t deps_regions() {
+    constexpr masks m = make();
+    mask_t mask = 0;
+    (void)aux::swallow{0, (mask |= has_dep<TDep>(typename TTransitions::deps{})
+                                       ? m.value[aux::get_id<int, typename TTransitions::src_state>((ids_t *)0)]
+                                       : 0,
+                           0)...};
+    return mask;
+  }
+};
+template <unsigned long long, class, class = aux::index_sequence<>>
+struct masked_regions;
+template <unsigned long long Mask, int... Rs>
+struct masked_regions<Mask, aux::index_sequence<>, aux::index_sequence<Rs...>> : aux::index_sequence<Rs...> {};
+template <unsigned long long Mask, int N, int... Ns, int... Rs>
+struct masked_regions<Mask, aux::index_sequence<N, Ns...>, aux::index_sequence<Rs...>>
+    : masked_regions<Mask, aux::index_sequence<Ns...>,
+                     aux::conditional_t<((Mask >> N) & 1u) != 0, aux::index_sequence<Rs..., N>, aux::index_sequence<Rs...>>> {
+};
+template <class>
 struct get_sub_sm : aux::type_list<> {};
 template <class T>
 struct get_sub_sm<sm<T>> : aux::join_t<aux::type_list<T>, typename sm<T>::state_machines> {};
@@ -809,7 +998,7 @@ template <class T, class... Ts>
 struct transitions<T, Ts...> {
   template <class TEvent, class SM, class TDeps, class TSubs>
   static bool execute(const TEvent &event, SM &sm, TDeps &deps, TSubs &subs, typename SM::state_t &current_state) {
-    if (aux::get<T>(sm.transitions_).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{})) {
+    if (aux::get<T>(sm.transitions()).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{})) {
       return true;
     }
     return transitions<Ts...>::execute(event, sm, deps, subs, current_state);
@@ -823,12 +1012,12 @@ struct transitions<T> {
   }
   template <class TEvent, class SM, class TDeps, class TSubs>
   static bool execute_impl(const TEvent &event, SM &sm, TDeps &deps, TSubs &subs, typename SM::state_t &current_state) {
-    return aux::get<T>(sm.transitions_).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
+    return aux::get<T>(sm.transitions()).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
   }
   template <class _, class TEvent, class SM, class TDeps, class TSubs>
   static bool execute_impl(const on_exit<_, TEvent> &event, SM &sm, TDeps &deps, TSubs &subs,
                            typename SM::state_t &current_state) {
-    aux::get<T>(sm.transitions_).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
+    aux::get<T>(sm.transitions()).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
     return false;
   }
 };
@@ -999,6 +1188,25 @@ struct get_event_mapping_impl_helper<on_exit<T1, T2>, TMappings>
     : decltype(get_event_mapping_impl<on_exit<T1, T2>>((TMappings *)0)) {};
 template <class T, class TMappings>
 using get_event_mapping_t = get_event_mapping_impl_helper<T, TMappings>;
+template <class... Ts>
+constexpr bool has_actions(const aux::type_list<Ts...> &) {
+  constexpr bool actions[] = {false, !aux::is_base_of<no_action, typename Ts::action>::value...};
+  auto result = false;
+  for (const auto action : actions) {
+    result |= action;
+  }
+  return result;
+}
+template <class... TStates, class... TTransitions>
+constexpr bool has_actions(const aux::inherit<state_mappings<TStates, TTransitions>...> *) {
+  return has_actions(aux::join_t<TTransitions...>{});
+}
+constexpr bool has_actions(...) { return false; }
+aux::type_list<> get_mapped_states_impl(...);
+template <class... Ts, class... TTransitions>
+aux::type_list<Ts...> get_mapped_states_impl(aux::inherit<state_mappings<Ts, TTransitions>...> *);
+template <class TMappings>
+using get_mapped_states_t = decltype(get_mapped_states_impl((TMappings *)0));
 }
 namespace back {
 namespace policies {
@@ -1146,16 +1354,312 @@ void log_guard(const aux::type<TLogger> &, TDeps &deps, const aux::zero_wrapper<
 }
 namespace back {
 namespace policies {
+struct occupancy_policy__ {
+  template <class T>
+  void occupy(const T &) {}
+  template <class T>
+  void change(const T &, const T &) {}
+  template <class T>
+  auto create_counter(const T &) {
+    return *this;
+  }
+  template <class T>
+  static void add(const T *, int, long) {}
+  __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
+};
+template <template <class...> class TAtomic, int Shards, class>
+class occupancy_impl;
+template <template <class...> class TAtomic, int Shards, class TTag, class T, int N>
+class occupancy_impl<TAtomic, Shards, aux::pair<TTag, T[N]>> {
+  static_assert(Shards > 0, "At least one shard is required");
+  struct alignas(64) shard {
+    TAtomic<long> counters[N]{};
+  };
+  template <int R>
+  class counter {
+   public:
+    explicit counter(const T (&states)[R]) : current_(states) {
+      for (auto i = 0; i < R; ++i) {
+        states_[i] = states[i];
+      }
+    }
+    ~counter() {
+      for (auto i = 0; i < R; ++i) {
+        change(states_[i], current_[i]);
+      }
+    }
+
+   private:
+    T states_[R];
+    const T (&current_)[R];
+  };
+
+ public:
+  occupancy_impl() = default;
+  occupancy_impl(const occupancy_impl &) = delete;
+  occupancy_impl &operator=(const occupancy_impl &) = delete;
+  ~occupancy_impl() { add(states_, regions_, -1); }
+  template <int R>
+  void occupy(const T (&states)[R]) {
+    states_ = states;
+    regions_ = R;
+    add(states, R, 1);
+  }
+  static void change(const T from, const T to) {
+    if (from != to) {
+      auto &s = local();
+      --s.counters[from];
+      ++s.counters[to];
+    }
+  }
+  template <int R>
+  auto create_counter(const T (&states)[R]) {
+    return counter<R>{states};
+  }
+  static void add(const T *states, const int regions, const long n) {
+    auto &s = local();
+    for (auto i = 0; i < regions; ++i) {
+      s.counters[states[i]] += n;
+    }
+  }
+  static long count(const T state) {
+    auto count = 0l;
+    for (auto i = 0; i < Shards; ++i) {
+      count += shards()[i].counters[state].load();
+    }
+    return count;
+  }
+
+ private:
+  static shard *shards() {
+    static shard shards[Shards];
+    return shards;
+  }
+  static shard &local() { return local(aux::integral_constant<bool, Shards == 1>{}); }
+  static shard &local(aux::true_type) { return shards()[0]; }
+  static shard &local(aux::false_type) {
+    static TAtomic<unsigned> threads{0u};
+    static thread_local auto &s = shards()[threads++ % Shards];
+    return s;
+  }
+  const T *states_ = nullptr;
+  int regions_ = 0;
+};
+template <template <class...> class TAtomic, int Shards = 1>
+struct occupancy : aux::pair<occupancy_policy__, occupancy<TAtomic, Shards>> {
+  template <class T>
+  using rebind = occupancy_impl<TAtomic, Shards, T>;
+};
+}
+}
+namespace back {
+namespace policies {
+struct parallel_regions_policy__ {};
+template <class T, class = void>
+struct is_thread_safe : aux::false_type {};
+template <class T>
+struct is_thread_safe<T, aux::void_t<aux::integral_constant<bool, T::thread_safe>>>
+    : aux::integral_constant<bool, T::thread_safe> {};
+template <class TRegionsMasks, class T, class TDep = aux::remove_const_t<aux::remove_reference_t<T>>>
+constexpr unsigned long long shared_deps_regions() {
+  return is_thread_safe<TDep>::value ? 0 : TRegionsMasks::template deps_regions<TDep>();
+}
+template <class TRegionsMasks, class... TDeps>
+constexpr bool disjoint_deps(const aux::type_list<TDeps...> &) {
+  constexpr unsigned long long masks[] = {0, shared_deps_regions<TRegionsMasks, TDeps>()...};
+  auto disjoint = true;
+  for (const auto mask : masks) {
+    disjoint &= !(mask & (mask - 1));
+  }
+  return disjoint;
+}
+template <class TExecutor>
+struct parallel_regions : aux::pair<parallel_regions_policy__, parallel_regions<TExecutor>> {
+  using executor = TExecutor;
+  template <class F>
+  void execute(F &f, const int n) {
+    executor_->bulk_execute(f, n);
+  }
+  TExecutor *executor_ = nullptr;
+};
+}
+}
+namespace back {
+namespace policies {
 struct process_queue_policy__ {};
-template <template <class...> class T>
-struct process_queue : aux::pair<back::policies::process_queue_policy__, process_queue<T>> {
+template <template <class...> class T, class TAllocator = void>
+struct process_queue : aux::pair<back::policies::process_queue_policy__, process_queue<T, TAllocator>> {
   template <class U>
   using rebind = T<U>;
+  using allocator = TAllocator;
+};
+template <class T, class = void>
+struct event_priority : aux::integral_constant<int, 0> {};
+template <class T>
+struct event_priority<T, aux::void_t<aux::integral_constant<int, T::priority>>> : aux::integral_constant<int, T::priority> {
+  static_assert(T::priority >= 0, "Event priority has to be a non-negative number!");
+};
+template <template <class...> class T, class TQueueEvent>
+class priority_queue;
+template <template <class...> class T, template <class...> class TQueueEvent, class... TEvents>
+class priority_queue<T, TQueueEvent<TEvents...>> {
+  using bucket_t = T<TQueueEvent<TEvents...>>;
+  static constexpr auto levels = aux::max<event_priority<TEvents>::value...>() + 1;
+  template <class TAllocator>
+  static const TAllocator &allocator(int, const TAllocator &allocator) {
+    return allocator;
+  }
+  template <class TAllocator, int... Ns>
+  priority_queue(const TAllocator &allocator, const aux::index_sequence<Ns...> &)
+      : buckets_{bucket_t(priority_queue::allocator(Ns, allocator))...} {}
+
+ public:
+  using value_type = TQueueEvent<TEvents...>;
+  using container_type = typename bucket_t::container_type;
+  priority_queue() = default;
+  template <class TAllocator>
+  explicit priority_queue(const TAllocator &allocator) : priority_queue(allocator, aux::make_index_sequence<levels>{}) {}
+  void push(value_type &&event) {
+    static constexpr int priorities[] = {event_priority<TEvents>::value...};
+    buckets_[priorities[event.id]].push(static_cast<value_type &&>(event));
+    ++size_;
+  }
+  value_type &front() {
+    top_ = levels - 1;
+    while (buckets_[top_].empty()) {
+      --top_;
+    }
+    return buckets_[top_].front();
+  }
+  void pop() {
+    buckets_[top_].pop();
+    --size_;
+  }
+  bool empty() const { return !size_; }
+
+ private:
+  bucket_t buckets_[levels];
+  int size_{};
+  int top_{};
+};
+template <template <class...> class T, class TAllocator = void>
+struct priority_process_queue : aux::pair<back::policies::process_queue_policy__, priority_process_queue<T, TAllocator>> {
+  template <class U>
+  using rebind = priority_queue<T, U>;
+  using allocator = TAllocator;
+};
+}
+}
+namespace back {
+namespace policies {
+struct seqlock_policy__ {
+  template <class T>
+  void publish(const T &) {}
+  template <class T>
+  auto create_publisher(const T &) {
+    return *this;
+  }
+  template <class T, int N>
+  void load(const T (&states)[N], T (&out)[N]) const {
+    for (auto i = 0; i < N; ++i) {
+      out[i] = states[i];
+    }
+  }
+  __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
+};
+template <template <class...> class TAtomic, class T, bool = (sizeof(T) <= sizeof(unsigned long long))>
+class seqlock_impl;
+template <class TSeqlock, class T, int N>
+struct seqlock_publisher {
+  ~seqlock_publisher() { seqlock.publish(states); }
+  TSeqlock &seqlock;
+  const T (&states)[N];
+};
+template <template <class...> class TAtomic, class T, int N>
+class seqlock_impl<TAtomic, T[N], true> {
+  using word_t = unsigned long long;
+  static word_t pack(const T (&states)[N]) {
+    word_t word = 0;
+    for (auto i = 0; i < N; ++i) {
+      word |= word_t(states[i]) << (i * sizeof(T) * 8);
+    }
+    return word;
+  }
+
+ public:
+  void publish(const T (&states)[N]) {
+    const auto word = pack(states);
+    if (word != published_) {
+      published_ = word;
+      word_.store(word);
+    }
+  }
+  auto create_publisher(const T (&states)[N]) { return seqlock_publisher<seqlock_impl, T, N>{*this, states}; }
+  void load(const T (&)[N], T (&out)[N]) const {
+    const auto word = word_.load();
+    for (auto i = 0; i < N; ++i) {
+      out[i] = T(word >> (i * sizeof(T) * 8));
+    }
+  }
+
+ private:
+  TAtomic<word_t> word_{0ull};
+  word_t published_{};
+};
+template <template <class...> class TAtomic, class T, int N>
+class seqlock_impl<TAtomic, T[N], false> {
+ public:
+  void publish(const T (&states)[N]) {
+    auto changed = false;
+    for (auto i = 0; i < N; ++i) {
+      changed |= published_[i] != states[i];
+      published_[i] = states[i];
+    }
+    if (changed) {
+      const auto sequence = sequence_.load();
+      sequence_.store(sequence + 1u);
+      for (auto i = 0; i < N; ++i) {
+        states_[i].store(states[i]);
+      }
+      sequence_.store(sequence + 2u);
+    }
+  }
+  auto create_publisher(const T (&states)[N]) { return seqlock_publisher<seqlock_impl, T, N>{*this, states}; }
+  void load(const T (&)[N], T (&out)[N]) const {
+    for (;;) {
+      const auto sequence = sequence_.load();
+      if (sequence & 1u) {
+        continue;
+      }
+      for (auto i = 0; i < N; ++i) {
+        out[i] = states_[i].load();
+      }
+      if (sequence_.load() == sequence) {
+        return;
+      }
+    }
+  }
+
+ private:
+  TAtomic<unsigned> sequence_{0u};
+  TAtomic<T> states_[N]{};
+  T published_[N]{};
+};
+template <template <class...> class TAtomic>
+struct seqlock : aux::pair<seqlock_policy__, seqlock<TAtomic>> {
+  template <class T>
+  using rebind = seqlock_impl<TAtomic, T>;
 };
 }
 }
 namespace back {
 namespace policies {
+struct shared_transitions_policy__ {};
+struct shared_transitions : aux::pair<shared_transitions_policy__, shared_transitions> {};
+}
+}
+namespace back {
+namespace policies {
 struct testing_policy__ {};
 struct testing : aux::pair<testing_policy__, testing> {};
 }
@@ -1163,13 +1667,43 @@ struct testing : aux::pair<testing_policy__, testing> {};
 namespace back {
 namespace policies {
 struct thread_safety_policy__ {
-  auto create_lock() { return *this; }
+  using per_region = aux::false_type;
+  using optimistic = aux::false_type;
+  template <class T, class TStates>
+  auto create_lock(const T &, TStates &, const bool) {
+    return *this;
+  }
+  template <class TStates>
+  auto create_batch_lock(TStates &) {
+    return *this;
+  }
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
 };
 template <class TLock>
 struct thread_safe : aux::pair<thread_safety_policy__, thread_safe<TLock>> {
-  using type = thread_safe;
-  auto create_lock() {
+  using per_region = aux::false_type;
+  using optimistic = aux::false_type;
+  template <class>
+  using rebind = thread_safe;
+  template <class T, class TStates>
+  auto create_lock(const T &, TStates &, const bool locked) {
+    struct lock_guard {
+      explicit lock_guard(TLock *lock) : lock_{lock} {
+        if (lock_) {
+          lock_->lock();
+        }
+      }
+      ~lock_guard() {
+        if (lock_) {
+          lock_->unlock();
+        }
+      }
+      TLock *lock_;
+    };
+    return lock_guard{locked ? nullptr : &lock};
+  }
+  template <class TStates>
+  auto create_batch_lock(TStates &) {
     struct lock_guard {
       explicit lock_guard(TLock &lock) : lock_{lock} { lock_.lock(); }
       ~lock_guard() { lock_.unlock(); }
@@ -1179,10 +1713,157 @@ struct thread_safe : aux::pair<thread_safety_policy__, thread_safe<TLock>> {
   }
   TLock lock;
 };
+template <class TLock, int N>
+struct thread_safe_regions_impl {
+  using per_region = aux::true_type;
+  using optimistic = aux::false_type;
+  template <int... Rs, class TStates>
+  auto create_lock(const aux::index_sequence<Rs...> &, TStates &, const bool locked) {
+    struct lock_guard {
+      explicit lock_guard(TLock (*locks)[N]) : locks_{locks} {
+        if (locks_) {
+#if defined(__cpp_fold_expressions)
+          ((*locks_)[Rs].lock(), ...);
+#else
+          (void)aux::swallow{0, ((*locks_)[Rs].lock(), 0)...};
+#endif
+        }
+      }
+      ~lock_guard() {
+        if (locks_) {
+#if defined(__cpp_fold_expressions)
+          ((*locks_)[Rs].unlock(), ...);
+#else
+          (void)aux::swallow{0, ((*locks_)[Rs].unlock(), 0)...};
+#endif
+        }
+      }
+      TLock (*locks_)[N];
+    };
+    return lock_guard{locked ? nullptr : &locks};
+  }
+  template <class TStates>
+  auto create_batch_lock(TStates &) {
+    struct lock_guard {
+      explicit lock_guard(TLock (&locks)[N]) : locks_{locks} {
+        for (auto &lock : locks_) {
+          lock.lock();
+        }
+      }
+      ~lock_guard() {
+        for (auto &lock : locks_) {
+          lock.unlock();
+        }
+      }
+      TLock (&locks_)[N];
+    };
+    return lock_guard{locks};
+  }
+  TLock locks[N];
+};
+template <class TLock>
+struct thread_safe_regions : aux::pair<thread_safety_policy__, thread_safe_regions<TLock>> {
+  template <class>
+  struct rebind_impl;
+  template <class T, int N>
+  struct rebind_impl<T[N]> {
+    static_assert(N <= 64, "thread_safe_regions supports up to 64 orthogonal regions");
+    using type = thread_safe_regions_impl<TLock, N>;
+  };
+  template <class T>
+  using rebind = typename rebind_impl<T>::type;
+};
+template <class TLock, template <class...> class TAtomic, class>
+class optimistic_thread_safe_impl;
+template <class TLock, template <class...> class TAtomic, class T, int N>
+class optimistic_thread_safe_impl<TLock, TAtomic, T[N]> {
+  using word_t = unsigned long long;
+  static_assert(sizeof(T) * N < sizeof(word_t), "optimistic_thread_safe supports up to 7 bytes of states (all regions)");
+  static constexpr word_t locked = 1ull << (sizeof(word_t) * 8 - 1);
+  static word_t pack(const T (&states)[N]) {
+    word_t word = 0;
+    for (auto i = 0; i < N; ++i) {
+      word |= word_t(states[i]) << (i * sizeof(T) * 8);
+    }
+    return word;
+  }
+  static void unpack(const word_t word, T (&states)[N]) {
+    for (auto i = 0; i < N; ++i) {
+      states[i] = T(word >> (i * sizeof(T) * 8));
+    }
+  }
+  struct lock_guard {
+    lock_guard(optimistic_thread_safe_impl *self, T (&states)[N]) : self_{self}, states_{states} {
+      if (self_) {
+        self_->lock_.lock();
+        unpack(self_->word_.fetch_or(locked), states_);
+      }
+    }
+    ~lock_guard() {
+      if (self_) {
+        self_->word_.store(pack(states_));
+        self_->lock_.unlock();
+      }
+    }
+    optimistic_thread_safe_impl *self_;
+    T (&states_)[N];
+  };
+
+ public:
+  using per_region = aux::false_type;
+  using optimistic = aux::true_type;
+  template <class TRegions>
+  auto create_lock(const TRegions &, T (&states)[N], const bool locked) {
+    return lock_guard{locked ? nullptr : this, states};
+  }
+  auto create_batch_lock(T (&states)[N]) { return lock_guard{this, states}; }
+  word_t load(T (&states)[N]) const {
+    const auto word = word_.load();
+    unpack(word, states);
+    return word;
+  }
+  void store(const T (&states)[N]) { word_.store(pack(states)); }
+  static bool is_locked(const word_t word) { return word & locked; }
+  bool commit(word_t &word, T (&states)[N], const T (&new_states)[N]) {
+    const auto new_word = pack(new_states);
+    if (new_word == word || word_.compare_exchange_weak(word, new_word)) {
+      return true;
+    }
+    unpack(word, states);
+    return false;
+  }
+
+ private:
+  TAtomic<word_t> word_{0ull};
+  TLock lock_;
+};
+template <class TLock, template <class...> class TAtomic>
+struct optimistic_thread_safe : aux::pair<thread_safety_policy__, optimistic_thread_safe<TLock, TAtomic>> {
+  template <class T>
+  using rebind = optimistic_thread_safe_impl<TLock, TAtomic, T>;
+};
+}
+}
+namespace back {
+namespace policies {
+struct timer_service_policy__ {};
+template <class T>
+struct timer_service : aux::pair<timer_service_policy__, timer_service<T>> {
+  using type = T;
+};
+template <class T, int Regions>
+struct region_timers {
+  using base = typename T::timer;
+  struct timer : base {
+    void *deps = nullptr;
+    void *subs = nullptr;
+  };
+  timer timers[Regions];
+};
 }
 }
 namespace back {
-struct no_policy : policies::thread_safety_policy__ {
+struct no_policy : policies::thread_safety_policy__, policies::seqlock_policy__, policies::occupancy_policy__ {
   using type = no_policy;
   template <class>
   using rebind = no_policy;
@@ -1190,6 +1871,7 @@ struct no_policy : policies::thread_safety_policy__ {
   using defer = no_policy;
   using const_iterator = no_policy;
   using flag = no_policy;
+  using allocator = void;
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
 };
 template <class TDefault, class>
@@ -1213,6 +1895,16 @@ struct sm_policy {
   using process_queue_policy =
       decltype(get_policy<no_policy, policies::process_queue_policy__>((aux::inherit<TPolicies...> *)0));
   using logger_policy = decltype(get_policy<no_policy, policies::logger_policy__>((aux::inherit<TPolicies...> *)0));
+  using parallel_regions_policy =
+      decltype(get_policy<no_policy, policies::parallel_regions_policy__>((aux::inherit<TPolicies...> *)0));
+  using seqlock_policy = decltype(get_policy<no_policy, policies::seqlock_policy__>((aux::inherit<TPolicies...> *)0));
+  using occupancy_policy = decltype(get_policy<no_policy, policies::occupancy_policy__>((aux::inherit<TPolicies...> *)0));
+  using shared_transitions_policy =
+      decltype(get_policy<no_policy, policies::shared_transitions_policy__>((aux::inherit<TPolicies...> *)0));
+  using async_executor_policy =
+      decltype(get_policy<no_policy, policies::async_executor_policy__>((aux::inherit<TPolicies...> *)0));
+  using timer_service_policy =
+      decltype(get_policy<no_policy, policies::timer_service_policy__>((aux::inherit<TPolicies...> *)0));
   using testing_policy = decltype(get_policy<no_policy, policies::testing_policy__>((aux::inherit<TPolicies...> *)0));
   using dispatch_policy =
       decltype(get_policy<default_dispatch_policy, policies::dispatch_policy__>((aux::inherit<TPolicies...> *)0));
@@ -1248,15 +1940,59 @@ struct composable : aux::is<aux::pool, decltype(composable_impl<T>(0))> {};
 #endif
 #endif
 namespace back {
+template <class T, class TPool>
+using has_ctor_parameter = aux::integral_constant<bool, aux::is_base_of<aux::pool_type<T>, TPool>::value ||
+                                                            aux::is_base_of<aux::pool_type<T &>, TPool>::value ||
+                                                            aux::is_base_of<aux::pool_type<const T &>, TPool>::value>;
+template <class TQueue, class TPool>
+TQueue make_queue(const aux::type<void> &, const TPool &) {
+  return TQueue{};
+}
+template <class TQueue, class TAllocator, class TPool>
+TQueue make_queue(const aux::type<TAllocator> &, const TPool &p) {
+  static_assert(has_ctor_parameter<TAllocator, TPool>::value,
+                "State Machine is missing the allocator constructor parameter required by the queue policy!");
+  return TQueue(aux::try_get<TAllocator>(&p));
+}
+template <class TPool>
+no_policy make_parallel_regions(const aux::type<no_policy> &, const TPool &) {
+  return {};
+}
+template <class TExecutor, class TPool>
+policies::parallel_regions<TExecutor> make_parallel_regions(const aux::type<policies::parallel_regions<TExecutor>> &,
+                                                            const TPool &p) {
+  static_assert(aux::is_base_of<aux::pool_type<TExecutor &>, TPool>::value,
+                "State Machine is missing the executor constructor parameter (passed by reference) required by the parallel "
+                "regions policy!");
+  policies::parallel_regions<TExecutor> parallel_regions{};
+  parallel_regions.executor_ = &aux::try_get<TExecutor>(&p);
+  return parallel_regions;
+}
+template <class TQueue, class TEvents>
+using coalescing_queue_t =
+    aux::conditional_t<aux::is_same<no_policy, TQueue>::value || !aux::size<aux::apply_t<coalescing_events_t, TEvents>>::value,
+                       TQueue, coalescing_queue<TQueue, TEvents>>;
+template <class TSM, class TMappings, class = typename TSM::thread_safety_t::per_region>
+struct dispatch_regions : aux::make_index_sequence<TSM::regions> {};
+template <class TSM, class TMappings>
+struct dispatch_regions<TSM, TMappings, aux::true_type> {
+  using masks_t = typename TSM::regions_masks_t;
+  static constexpr auto mask = TSM::has_unexpected_events::value ? ~0ull : masks_t::get(get_mapped_states_t<TMappings>{});
+  using type = typename masked_regions<mask, aux::make_index_sequence<TSM::regions>>::type;
+};
+template <class TSM, class TMappings>
+using dispatch_regions_t = typename dispatch_regions<TSM, TMappings>::type;
 template <class TSM>
 struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux::none_type, typename TSM::sm> {
   using sm_t = typename TSM::sm;
-  using thread_safety_t = typename TSM::thread_safety_policy::type;
   template <class T>
   using defer_queue_t = typename TSM::defer_queue_policy::template rebind<T>;
   using defer_flag_t = typename TSM::defer_queue_policy::flag;
+  using defer_event_t = aux::conditional_t<aux::is_same<no_policy, defer_flag_t>::value, no_policy, const void *>;
+  using defer_allocator_t = typename TSM::defer_queue_policy::allocator;
   template <class T>
   using process_queue_t = typename TSM::process_queue_policy::template rebind<T>;
+  using process_allocator_t = typename TSM::process_queue_policy::allocator;
   using logger_t = typename TSM::logger_policy::type;
   using dispatch_t = typename TSM::dispatch_policy;
   using transitions_t = decltype(aux::declval<sm_t>().operator()());
@@ -1272,12 +2008,44 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   using events_ids_t = aux::apply_t<aux::inherit, events_t>;
   using has_unexpected_events = typename aux::is_base_of<unexpected, aux::apply_t<aux::inherit, events_t>>::type;
   using has_entry_exits = typename aux::is_base_of<entry_exit, aux::apply_t<aux::inherit, events_t>>::type;
-  using defer_t = defer_queue_t<aux::apply_t<queue_event, events_t>>;
-  using process_t = process_queue_t<aux::apply_t<queue_event, events_t>>;
+  using defer_t = coalescing_queue_t<defer_queue_t<aux::apply_t<queue_event, events_t>>, events_t>;
+  using process_t = coalescing_queue_t<process_queue_t<aux::apply_t<queue_event, events_t>>, events_t>;
   using deps = aux::apply_t<merge_deps, transitions_t>;
   using state_t = aux::conditional_t<(aux::size<states_t>::value > 0xFF), unsigned short, aux::byte>;
   static constexpr auto regions = aux::size<initial_states_t>::value;
   static_assert(regions > 0, "At least one initial state is required");
+  using thread_safety_t = typename TSM::thread_safety_policy::template rebind<state_t[regions]>;
+  using parallel_regions_t = typename TSM::parallel_regions_policy;
+  using has_parallel_regions = aux::integral_constant<bool, !aux::is_same<no_policy, parallel_regions_t>::value>;
+  using regions_masks_t = regions_masks<states_t, initial_states_t, aux::apply_t<aux::type_list, transitions_t>>;
+  using seqlock_t = typename TSM::seqlock_policy::template rebind<state_t[regions]>;
+  using occupancy_t = typename TSM::occupancy_policy::template rebind<aux::pair<TSM, state_t[aux::size<states_t>::value]>>;
+  using has_shared_transitions =
+      aux::integral_constant<bool, !aux::is_same<no_policy, typename TSM::shared_transitions_policy>::value>;
+  using transitions_storage_t = aux::conditional_t<has_shared_transitions::value, no_policy, transitions_t>;
+  using async_executor_t = typename TSM::async_executor_policy::type;
+  using async_pending_t = aux::conditional_t<aux::is_same<no_policy, async_executor_t>::value, no_policy, unsigned>;
+  using timer_service_t = typename TSM::timer_service_policy::type;
+  using timeout_transitions_t = aux::apply_t<get_timeout_transitions, transitions_t>;
+  using has_timeouts = aux::integral_constant<bool, (aux::size<timeout_transitions_t>::value > 0)>;
+  using timers_t =
+      aux::conditional_t<has_timeouts::value, policies::region_timers<timer_service_t, regions>, no_policy>;
+  static_assert(!has_timeouts::value || !aux::is_same<no_policy, timer_service_t>::value,
+                "`after` transitions require sml::timer_service policy!");
+  static_assert(!thread_safety_t::optimistic::value || !aux::size<aux::apply_t<get_sub_sms, states_t>>::value,
+                "optimistic_thread_safe policy doesn't support sub state machines!");
+  static_assert(!thread_safety_t::per_region::value || (aux::is_same<no_policy, typename TSM::defer_queue_policy>::value &&
+                                                         aux::is_same<no_policy, typename TSM::process_queue_policy>::value &&
+                                                         aux::is_same<no_policy, typename TSM::seqlock_policy>::value),
+                "thread_safe_regions policy can't be combined with defer/process queue or seqlock policies!");
+  using has_optimistic_transitions =
+      aux::integral_constant<bool, thread_safety_t::optimistic::value && !has_entry_exits::value &&
+                                       !has_unexpected_events::value && !has_timeouts::value && !has_parallel_regions::value &&
+                                       aux::is_same<no_policy, logger_t>::value &&
+                                       aux::is_same<no_policy, typename TSM::occupancy_policy>::value &&
+                                       aux::is_same<no_policy, async_executor_t>::value>;
+  template <class TMappings>
+  using is_optimistic_t = aux::integral_constant<bool, has_optimistic_transitions::value && !has_actions((TMappings *)0)>;
 #if !BOOST_SML_DISABLE_EXCEPTIONS
   using exceptions = aux::apply_t<aux::unique_t, aux::apply_t<get_exceptions, events_t>>;
   using has_exceptions = aux::integral_constant<bool, (aux::size<exceptions>::value > 0)>;
@@ -1286,31 +2054,265 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   template <class TPool>
   sm_impl(aux::init, const TPool &p) : sm_impl{p, aux::is_empty<sm_t>{}} {}
   template <class TPool>
-  sm_impl(const TPool &p, aux::false_type) : sm_t{aux::try_get<sm_t>(&p)}, transitions_{(*this)()} {
+  sm_impl(const TPool &p, aux::false_type)
+      : sm_t{aux::try_get<sm_t>(&p)},
+        transitions_{make_transitions(static_cast<sm_t &>(*this), has_shared_transitions{})},
+        parallel_regions_(make_parallel_regions(aux::type<parallel_regions_t>{}, p)),
+        defer_(make_queue<defer_t>(aux::type<defer_allocator_t>{}, p)),
+        process_(make_queue<process_t>(aux::type<process_allocator_t>{}, p)) {
     initialize(typename sm_impl<TSM>::initial_states_t{});
+    publish_states();
+    occupancy_.occupy(current_state_);
   }
   template <class TPool>
-  sm_impl(const TPool &p, aux::true_type) : transitions_{aux::try_get<sm_t>(&p)()} {
+  sm_impl(const TPool &p, aux::true_type)
+      : transitions_{make_transitions(aux::try_get<sm_t>(&p), has_shared_transitions{})},
+        parallel_regions_(make_parallel_regions(aux::type<parallel_regions_t>{}, p)),
+        defer_(make_queue<defer_t>(aux::type<defer_allocator_t>{}, p)),
+        process_(make_queue<process_t>(aux::type<process_allocator_t>{}, p)) {
     initialize(typename sm_impl<TSM>::initial_states_t{});
+    publish_states();
+    occupancy_.occupy(current_state_);
   }
   template <class TEvent, class TDeps, class TSubs>
-  bool process_event(const TEvent &event, TDeps &deps, TSubs &subs) {
+  bool process_event(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked = false) {
+    if (defer_while_pending(event, async_pending_)) {
+      return true;
+    }
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS
     const auto handled = process_event_impl<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(
-        event, deps, subs, states_t{}, aux::make_index_sequence<regions>{});
+        event, deps, subs, states_t{}, aux::make_index_sequence<regions>{}, locked);
 #else
-    const auto handled =
-        process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, has_exceptions{});
+    const auto handled = process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                                       has_exceptions{});
+#endif
+    process_pending_events<TEvent>(handled, deps, subs, locked);
+    return handled;
+  }
+  template <class TEvent, class TDeps, class TSubs,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_reference_t<TEvent>, TEvent>::value)>
+  bool process_event(TEvent &&event, TDeps &deps, TSubs &subs, const bool locked = false) {
+    if (defer_while_pending(event, async_pending_)) {
+      return true;
+    }
+    const auto handled = process_event_owned(event, deps, subs, locked, aux::type<defer_queue_t<TEvent>>{});
+    process_pending_events<TEvent>(handled, deps, subs, locked);
+    return handled;
+  }
+  template <class TState, class TEvent, class TDeps, class TSubs>
+  bool process_event_in(const TEvent &event, TDeps &deps, TSubs &subs) {
+#if BOOST_SML_DISABLE_EXCEPTIONS
+    return process_event_in<TState>(event, deps, subs,
+                                    aux::integral_constant<bool, regions == 1 && !thread_safety_t::optimistic::value>{});
+#else
+    return process_event_in<TState>(
+        event, deps, subs,
+        aux::integral_constant<bool, regions == 1 && !has_exceptions::value && !thread_safety_t::optimistic::value>{});
 #endif
+  }
+  template <class TState, class TEvent, class TDeps, class TSubs>
+  bool process_event_in(const TEvent &event, TDeps &deps, TSubs &subs, aux::false_type) {
+    return process_event(event, deps, subs);
+  }
+  template <class TState, class TEvent, class TDeps, class TSubs>
+  bool process_event_in(const TEvent &event, TDeps &deps, TSubs &subs, aux::true_type) {
+    using mappings_t = get_event_mapping_t<get_generic_t<TEvent>, mappings>;
+    auto in_state = false;
+    auto handled = false;
+    {
+      const auto lock = thread_safety_.create_lock(aux::index_sequence<0>{}, current_state_, false);
+      (void)lock;
+      if (current_state_[0] == aux::get_id<state_t, TState>((states_ids_t *)0) && !is_async_pending()) {
+        in_state = true;
+        policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
+        const auto publisher = seqlock_.create_publisher(current_state_);
+        (void)publisher;
+        handled = get_state_mapping_t<TState, mappings_t, has_unexpected_events>::template execute<TEvent, sm_impl, TDeps, TSubs>(
+            event, *this, deps, subs, current_state_[0]);
+      }
+    }
+    if (!in_state) {
+      return process_event(event, deps, subs);
+    }
+    process_pending_events<TEvent>(handled, deps, subs);
+    return handled;
+  }
+  template <class TEvent, class TDeps, class TSubs>
+  void process_pending_events(const bool handled, TDeps &deps, TSubs &subs, const bool locked = false) {
     do {
-      while (process_internal_events(anonymous{}, deps, subs)) {
+      while (!is_async_pending() && process_internal_events(anonymous{}, deps, subs, locked)) {
       }
-      process_defer_events(deps, subs, handled, aux::type<defer_queue_t<TEvent>>{}, events_t{});
-    } while (process_queued_events(deps, subs, aux::type<process_queue_t<TEvent>>{}, events_t{}) ||
-             process_internal_events(anonymous{}, deps, subs));
+      process_defer_events(deps, subs, handled, locked, aux::type<defer_queue_t<TEvent>>{}, events_t{});
+    } while (!is_async_pending() &&
+             (process_queued_events(deps, subs, locked, aux::type<process_queue_t<TEvent>>{}, events_t{}) ||
+              process_internal_events(anonymous{}, deps, subs, locked)));
+  }
+  bool is_async_pending() const { return is_async_pending(async_pending_); }
+  static bool is_async_pending(const no_policy &) { return false; }
+  static bool is_async_pending(const unsigned pending) { return pending; }
+  template <class TEvent>
+  static bool defer_while_pending(const TEvent &, const no_policy &) {
+    return false;
+  }
+  template <class TEvent>
+  bool defer_while_pending(const TEvent &event, const unsigned pending) {
+    return pending && defer_async(event, aux::is_base_of<TEvent, events_ids_t>{});
+  }
+  template <class TEvent>
+  bool defer_async(const TEvent &event, aux::true_type) {
+    defer_.push_back(event);
+    return true;
+  }
+  template <class TEvent>
+  static bool defer_async(const TEvent &, aux::false_type) {
+    return false;
+  }
+  template <class TDeps, class TSubs>
+  void complete_async(TDeps &deps, TSubs &subs, const unsigned epoch) {
+    if (epoch == async_epoch_ && async_pending_ && !--async_pending_) {
+      process_pending_events<anonymous>(true, deps, subs);
+    }
+  }
+  static void next_async_epoch(no_policy &) {}
+  static void next_async_epoch(unsigned &epoch) { ++epoch; }
+  template <class TDeps, class TSubs>
+  void arm_timeouts(TDeps &deps, TSubs &subs) {
+    for (const auto &current_state : current_state_) {
+      arm_timeout(deps, subs, current_state);
+    }
+  }
+  template <class TDeps, class TSubs>
+  void arm_timeout(TDeps &deps, TSubs &subs, const state_t &current_state) {
+    arm_timeout(deps, subs, current_state, timers_);
+  }
+  template <class TDeps, class TSubs>
+  static void arm_timeout(TDeps &, TSubs &, const state_t &, no_policy &) {}
+  template <class TDeps, class TSubs, class TTimers>
+  void arm_timeout(TDeps &deps, TSubs &subs, const state_t &current_state, TTimers &timers) {
+    auto &service = static_cast<aux::pool_type<timer_service_t &> &>(deps).value;
+    auto &timer = timers.timers[&current_state - current_state_];
+    service.cancel(timer);
+    timer.deps = &deps;
+    timer.subs = &subs;
+    arm_timeout(service, timer, current_state, &sm_impl::expired<TDeps, TSubs, TTimers>, timeout_transitions_t{});
+  }
+  template <class TService, class TTimer, class TExpired, class... Ts>
+  void arm_timeout(TService &service, TTimer &timer, const state_t current_state, TExpired expired,
+                   const aux::type_list<Ts...> &) {
+    auto armed = false;
+    (void)aux::swallow{0, (armed = armed || (current_state == aux::get_id<state_t, typename Ts::src_state>((states_ids_t *)0) &&
+                                             (service.arm(timer, aux::get<Ts>(transitions()).g.duration, expired), true)),
+                           0)...};
+  }
+  template <class TDeps, class TSubs, class TTimers>
+  static void expired(typename TTimers::base &base) {
+    auto &timer = static_cast<typename TTimers::timer &>(base);
+    auto &subs = *static_cast<TSubs *>(timer.subs);
+    auto &sm = aux::get<sm_impl>(subs);
+    sm.process_timeout(static_cast<int>(&timer - sm.timers_.timers), *static_cast<TDeps *>(timer.deps), subs);
+  }
+  template <class TDeps, class TSubs>
+  void process_timeout(const int region, TDeps &deps, TSubs &subs) {
+    const timeout event{};
+    if (defer_while_pending(event, async_pending_)) {
+      return;
+    }
+    policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
+    bool handled;
+    {
+      const auto lock = thread_safety_.create_lock(aux::make_index_sequence<regions>{}, current_state_, false);
+      (void)lock;
+      const auto publisher = seqlock_.create_publisher(current_state_);
+      (void)publisher;
+#if BOOST_SML_DISABLE_EXCEPTIONS
+      handled = process_event_impl<get_event_mapping_t<timeout, mappings>>(event, deps, subs, states_t{},
+                                                                           current_state_[region]);
+#else
+      handled = process_event_noexcept<get_event_mapping_t<timeout, mappings>>(event, deps, subs, current_state_[region],
+                                                                               has_exceptions{});
+#endif
+    }
+    process_pending_events<timeout>(handled, deps, subs);
+  }
+  template <class TEvent, class TDeps, class TSubs>
+  bool process_event_owned(TEvent &event, TDeps &deps, TSubs &subs, const bool locked, const aux::type<no_policy> &) {
+    policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
+#if BOOST_SML_DISABLE_EXCEPTIONS
+    return process_event_impl<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, states_t{},
+                                                                                    aux::make_index_sequence<regions>{}, locked);
+#else
+    return process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                        has_exceptions{});
+#endif
+  }
+  template <class TEvent, class TDeps, class TSubs, class TDeferQueue>
+  bool process_event_owned(TEvent &event, TDeps &deps, TSubs &subs, const bool locked, const aux::type<TDeferQueue> &) {
+    const auto defer_event = defer_event_;
+    const auto defer_pending = defer_pending_;
+    defer_event_ = &event;
+    defer_pending_ = false;
+    const auto handled = process_event_owned(event, deps, subs, locked, aux::type<no_policy>{});
+    if (defer_pending_) {
+      defer_.push_back(static_cast<TEvent &&>(event));
+    }
+    defer_event_ = defer_event;
+    defer_pending_ = defer_pending;
     return handled;
   }
+  template <class T>
+  static transitions_t make_transitions(T &&sm, aux::false_type) {
+    return sm();
+  }
+  template <class T>
+  static no_policy make_transitions(T &&sm, aux::true_type) {
+    auto transitions = sm();
+    shared_transitions(&transitions);
+    return {};
+  }
+  static transitions_t &shared_transitions(transitions_t *transitions = nullptr) {
+    static transitions_t shared{static_cast<transitions_t &&>(*transitions)};
+    return shared;
+  }
+  transitions_t &transitions() { return transitions(has_shared_transitions{}); }
+  transitions_t &transitions(aux::false_type) { return transitions_; }
+  static transitions_t &transitions(aux::true_type) { return shared_transitions(); }
+  void publish_states() {
+    seqlock_.publish(current_state_);
+    store_states(typename thread_safety_t::optimistic{});
+  }
+  void store_states(aux::false_type) {}
+  void store_states(aux::true_type) { thread_safety_.store(current_state_); }
+  void load_states(state_t (&states)[regions]) const { load_states(states, typename thread_safety_t::optimistic{}); }
+  void load_states(state_t (&states)[regions], aux::false_type) const { seqlock_.load(current_state_, states); }
+  void load_states(state_t (&states)[regions], aux::true_type) const { thread_safety_.load(states); }
+  void load_instance(const aux::byte *states) {
+    auto current_state = reinterpret_cast<aux::byte *>(current_state_);
+    for (auto i = 0u; i < sizeof(current_state_); ++i) {
+      current_state[i] = states[i];
+    }
+    publish_states();
+  }
+  void store_instance(aux::byte *states) const {
+    state_t current_state[regions];
+    load_states(current_state);
+    const auto bytes = reinterpret_cast<const aux::byte *>(current_state);
+    for (auto i = 0u; i < sizeof(current_state); ++i) {
+      states[i] = bytes[i];
+    }
+  }
+  static void occupy_instance(const aux::byte *states, const long n) {
+    state_t current_state[regions];
+    const auto bytes = reinterpret_cast<aux::byte *>(current_state);
+    for (auto i = 0u; i < sizeof(current_state); ++i) {
+      bytes[i] = states[i];
+    }
+    occupancy_t::add(current_state, regions, n);
+  }
+  template <class TQueue>
+  void swap_deferred(TQueue &queue) {
+    swap(defer_, queue);
+  }
   void initialize(const aux::type_list<> &) {}
   template <class TState>
   void initialize(const aux::type_list<TState> &) {
@@ -1325,15 +2327,38 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     (void)aux::swallow{0, (current_state_[region++] = aux::get_id<state_t, TStates>((states_ids_t *)0), 0)...};
 #endif
   }
+  void reset() {
+    {
+      const auto counter = occupancy_.create_counter(current_state_);
+      (void)counter;
+      initialize(initial_states_t{});
+    }
+    publish_states();
+    clear_defer_queue(defer_);
+    clear_process_queue(process_);
+    async_pending_ = async_pending_t{};
+    next_async_epoch(async_epoch_);
+  }
+  static void clear_defer_queue(no_policy &) {}
+  template <class TQueue>
+  static void clear_defer_queue(TQueue &queue) {
+    while (queue.begin() != queue.end()) {
+      queue.erase(queue.begin());
+    }
+  }
+  static void clear_process_queue(no_policy &) {}
+  template <class TQueue>
+  static void clear_process_queue(TQueue &queue) {
+    while (!queue.empty()) {
+      (void)queue.front();
+      queue.pop();
+    }
+  }
   template <class TDeps, class TSubs>
   void start(TDeps &deps, TSubs &subs) {
+    arm_timeouts(deps, subs);
     process_internal_events(on_entry<_, initial>{}, deps, subs);
-    do {
-      while (process_internal_events(anonymous{}, deps, subs)) {
-      }
-      process_defer_events(deps, subs, true, aux::type<defer_queue_t<initial>>{}, events_t{});
-    } while (process_queued_events(deps, subs, aux::type<process_queue_t<initial>>{}, events_t{}) ||
-             process_internal_events(anonymous{}, deps, subs));
+    process_pending_events<initial>(true, deps, subs);
   }
   template <class TEvent, class TDeps, class TSubs, class... Ts,
             __BOOST_SML_REQUIRES(!aux::is_base_of<get_generic_t<TEvent>, events_ids_t>::value &&
@@ -1344,24 +2369,26 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   template <class TEvent, class TDeps, class TSubs,
             __BOOST_SML_REQUIRES(aux::is_base_of<get_generic_t<TEvent>, events_ids_t>::value &&
                                  !aux::is_base_of<get_mapped_t<TEvent>, events_ids_t>::value)>
-  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs) {
+  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked = false) {
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS
     return process_event_impl<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, states_t{},
-                                                                                    aux::make_index_sequence<regions>{});
+                                                                                    aux::make_index_sequence<regions>{}, locked);
 #else
-    return process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, has_exceptions{});
+    return process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                        has_exceptions{});
 #endif
   }
   template <class TEvent, class TDeps, class TSubs,
             __BOOST_SML_REQUIRES(aux::is_base_of<get_mapped_t<TEvent>, events_ids_t>::value)>
-  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs) {
+  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked = false) {
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS
     return process_event_impl<get_event_mapping_t<get_mapped_t<TEvent>, mappings>>(event, deps, subs, states_t{},
-                                                                                   aux::make_index_sequence<regions>{});
+                                                                                   aux::make_index_sequence<regions>{}, locked);
 #else
-    return process_event_noexcept<get_event_mapping_t<get_mapped_t<TEvent>, mappings>>(event, deps, subs, has_exceptions{});
+    return process_event_noexcept<get_event_mapping_t<get_mapped_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                       has_exceptions{});
 #endif
   }
   template <class TEvent, class TDeps, class TSubs, class... Ts,
@@ -1405,20 +2432,64 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
 #endif
            || process_internal_generic_event(event, deps, subs, current_state);
   }
-  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
   bool process_event_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
-                          aux::index_sequence<0>) {
-    const auto lock = thread_safety_.create_lock();
+                          aux::index_sequence<Ns...>, const bool locked) {
+    return process_event_optimistic<TMappings>(event, deps, subs, states, aux::index_sequence<Ns...>{}, locked,
+                                               is_optimistic_t<TMappings>{});
+  }
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool process_event_optimistic(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                                aux::index_sequence<Ns...>, const bool locked, aux::false_type) {
+    return process_event_regions<TMappings>(event, deps, subs, states, locked, dispatch_regions_t<sm_impl, TMappings>{});
+  }
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool process_event_optimistic(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                                aux::index_sequence<Ns...>, const bool locked, aux::true_type) {
+    if (locked) {
+      return process_event_regions<TMappings>(event, deps, subs, states, locked, dispatch_regions_t<sm_impl, TMappings>{});
+    }
+    state_t current_state[regions];
+    auto word = thread_safety_.load(current_state);
+    while (!thread_safety_t::is_locked(word)) {
+      state_t new_state[regions] = {current_state[Ns]...};
+      auto handled = false;
+      (void)aux::swallow{
+          0, (handled |= dispatch_t::template dispatch<0, TMappings>(*this, new_state[Ns], event, deps, subs, states), 0)...};
+      if (!handled || thread_safety_.commit(word, current_state, new_state)) {
+        return handled;
+      }
+    }
+    return process_event_regions<TMappings>(event, deps, subs, states, locked, dispatch_regions_t<sm_impl, TMappings>{});
+  }
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
+  bool process_event_regions(const TEvent &, TDeps &, TSubs &, const aux::type_list<TStates...> &, const bool,
+                             aux::index_sequence<>) {
+    return false;
+  }
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
+  bool process_event_regions(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             const bool locked, aux::index_sequence<0>) {
+    const auto lock = thread_safety_.create_lock(aux::index_sequence<0>{}, current_state_, locked);
     (void)lock;
+    const auto publisher = seqlock_.create_publisher(current_state_);
+    (void)publisher;
     return dispatch_t::template dispatch<0, TMappings>(*this, current_state_[0], event, deps, subs, states);
   }
   template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
-  bool process_event_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
-                          aux::index_sequence<Ns...>) {
-    const auto lock = thread_safety_.create_lock();
+  bool process_event_regions(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             const bool locked, aux::index_sequence<Ns...>) {
+    const auto lock = thread_safety_.create_lock(aux::index_sequence<Ns...>{}, current_state_, locked);
     (void)lock;
+    const auto publisher = seqlock_.create_publisher(current_state_);
+    (void)publisher;
+    return dispatch_regions_impl<TMappings>(event, deps, subs, states, aux::index_sequence<Ns...>{}, has_parallel_regions{});
+  }
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool dispatch_regions_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             aux::index_sequence<Ns...>, aux::false_type) {
 #if defined(__cpp_fold_expressions)
-    return ((dispatch_t::template dispatch<0, TMappings>(*this, current_state_[Ns], event, deps, subs, states)), ...);
+    return (dispatch_t::template dispatch<0, TMappings>(*this, current_state_[Ns], event, deps, subs, states) | ...);
 #else
     auto handled = false;
     (void)aux::swallow{
@@ -1427,17 +2498,36 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     return handled;
 #endif
   }
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool dispatch_regions_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             aux::index_sequence<Ns...>, aux::true_type) {
+    static_assert(policies::disjoint_deps<regions_masks_t>(typename sm_impl::deps{}),
+                  "Regions dispatched in parallel can't share dependencies unless they are marked with "
+                  "`static constexpr auto thread_safe = true`!");
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value &&
+                      aux::is_same<no_policy, typename TSM::process_queue_policy>::value,
+                  "Parallel regions policy can't be combined with defer/process queue policies!");
+    static constexpr int ids[] = {Ns...};
+    bool handled[sizeof...(Ns)]{};
+    auto dispatch = [&](const int i) {
+      handled[i] = dispatch_t::template dispatch<0, TMappings>(*this, current_state_[ids[i]], event, deps, subs, states);
+    };
+    parallel_regions_.execute(dispatch, sizeof...(Ns));
+    auto result = false;
+    for (const auto h : handled) {
+      result |= h;
+    }
+    return result;
+  }
   template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
   bool process_event_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
                           state_t &current_state) {
-    const auto lock = thread_safety_.create_lock();
-    (void)lock;
     return dispatch_t::template dispatch<0, TMappings>(*this, current_state, event, deps, subs, states);
   }
 #if !BOOST_SML_DISABLE_EXCEPTIONS
   template <class TMappings, class TEvent, class TDeps, class TSubs>
-  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, aux::false_type) noexcept {
-    return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{});
+  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked, aux::false_type) noexcept {
+    return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{}, locked);
   }
   template <class TMappings, class TEvent, class TDeps, class TSubs>
   bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, state_t &current_state, aux::false_type) noexcept {
@@ -1448,48 +2538,52 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     try {
       return process_event_impl<TMappings>(event, deps, subs, states_t{}, current_state);
     } catch (...) {
-      return process_exception(deps, subs, exceptions{});
+      return process_exception(deps, subs, false, exceptions{});
     }
   }
   template <class TMappings, class TEvent, class TDeps, class TSubs>
-  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, aux::true_type) {
+  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked, aux::true_type) {
     try {
-      return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{});
+      return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{}, locked);
     } catch (...) {
-      return process_exception(deps, subs, exceptions{});
+      return process_exception(deps, subs, locked, exceptions{});
     }
   }
   template <class TDeps, class TSubs>
-  bool process_exception(TDeps &deps, TSubs &subs, const aux::type_list<> &) {
-    return process_internal_events(exception<_>{}, deps, subs);
+  bool process_exception(TDeps &deps, TSubs &subs, const bool locked, const aux::type_list<> &) {
+    return process_internal_events(exception<_>{}, deps, subs, locked);
   }
   template <class TDeps, class TSubs, class E, class... Es>
-  bool process_exception(TDeps &deps, TSubs &subs, const aux::type_list<E, Es...> &) {
+  bool process_exception(TDeps &deps, TSubs &subs, const bool locked, const aux::type_list<E, Es...> &) {
     try {
       throw;
     } catch (const typename E::type &e) {
-      return process_internal_events(E{e}, deps, subs);
+      return process_internal_events(E{e}, deps, subs, locked);
     } catch (...) {
-      return process_exception(deps, subs, aux::type_list<Es...>{});
+      return process_exception(deps, subs, locked, aux::type_list<Es...>{});
     }
   }
 #endif
   template <class TDeps, class TSubs, class... TEvents>
-  bool process_defer_events(TDeps &, TSubs &, const bool, const aux::type<no_policy> &, const aux::type_list<TEvents...> &) {
+  bool process_defer_events(TDeps &, TSubs &, const bool, const bool, const aux::type<no_policy> &,
+                            const aux::type_list<TEvents...> &) {
     return false;
   }
   template <class TDeps, class TSubs, class TEvent>
-  bool process_event_no_defer(TDeps &deps, TSubs &subs, const void *data) {
+  bool process_event_no_defer(TDeps &deps, TSubs &subs, const bool locked, const void *data) {
     const auto &event = *static_cast<const TEvent *>(data);
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS
     const auto handled = process_event_impl<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, states_t{},
-                                                                                   aux::make_index_sequence<regions>{});
+                                                                                   aux::make_index_sequence<regions>{}, locked);
 #else
-    const auto handled = process_event_noexcept<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, has_exceptions{});
+    const auto handled =
+        process_event_noexcept<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, locked, has_exceptions{});
 #endif
     if (handled && defer_again_) {
-      ++defer_it_;
+      if (++defer_it_ == defer_end_ && refill(defer_, defer_it_)) {
+        defer_end_ = defer_.end();
+      }
     } else {
       defer_.erase(defer_it_);
       defer_it_ = defer_.begin();
@@ -1498,11 +2592,11 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     return handled;
   }
   template <class TDeps, class TSubs, class TDeferQueue, class... TEvents>
-  bool process_defer_events(TDeps &deps, TSubs &subs, const bool handled, const aux::type<TDeferQueue> &,
+  bool process_defer_events(TDeps &deps, TSubs &subs, const bool handled, const bool locked, const aux::type<TDeferQueue> &,
                             const aux::type_list<TEvents...> &) {
     bool processed_events = false;
     if (handled) {
-      using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const void *);
+      using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const bool, const void *);
       const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TEvents))] = {
           &sm_impl::process_event_no_defer<TDeps, TSubs, TEvents>...};
       defer_processing_ = true;
@@ -1510,8 +2604,13 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
       defer_it_ = defer_.begin();
       defer_end_ = defer_.end();
       processed_events = defer_it_ != defer_end_;
-      while (defer_it_ != defer_end_) {
-        (this->*dispatch_table[defer_it_->id])(deps, subs, defer_it_->data);
+      while (defer_it_ != defer_end_ && !is_async_pending()) {
+        if (is_superseded(defer_, defer_it_->id)) {
+          defer_it_ = defer_.erase(defer_it_);
+          defer_end_ = defer_.end();
+          continue;
+        }
+        (this->*dispatch_table[defer_it_->id])(deps, subs, locked, defer_it_->data);
         defer_again_ = false;
       }
       defer_processing_ = false;
@@ -1519,48 +2618,47 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     return processed_events;
   }
   template <class TDeps, class TSubs, class... TEvents>
-  bool process_queued_events(TDeps &, TSubs &, const aux::type<no_policy> &, const aux::type_list<TEvents...> &) {
+  bool process_queued_events(TDeps &, TSubs &, const bool, const aux::type<no_policy> &, const aux::type_list<TEvents...> &) {
     return false;
   }
   template <class TDeps, class TSubs, class TEvent>
-  bool process_event_no_queue(TDeps &deps, TSubs &subs, const void *data) {
-    const auto &event = *static_cast<const TEvent *>(data);
-    policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
-#if BOOST_SML_DISABLE_EXCEPTIONS
-    return process_event_impl<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, states_t{},
-                                                                     aux::make_index_sequence<regions>{});
-#else
-    return process_event_noexcept<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, has_exceptions{});
-#endif
+  bool process_event_no_queue(TDeps &deps, TSubs &subs, const bool locked, void *data) {
+    return process_event_owned(*static_cast<TEvent *>(data), deps, subs, locked, aux::type<defer_queue_t<TEvent>>{});
   }
   template <class TDeps, class TSubs, class TDeferQueue, class... TEvents>
-  bool process_queued_events(TDeps &deps, TSubs &subs, const aux::type<TDeferQueue> &, const aux::type_list<TEvents...> &) {
-    using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const void *);
+  bool process_queued_events(TDeps &deps, TSubs &subs, const bool locked, const aux::type<TDeferQueue> &,
+                             const aux::type_list<TEvents...> &) {
+    using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const bool, void *);
     const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TEvents))] = {
         &sm_impl::process_event_no_queue<TDeps, TSubs, TEvents>...};
     bool wasnt_empty = !process_.empty();
-    while (!process_.empty()) {
-      (this->*dispatch_table[process_.front().id])(deps, subs, process_.front().data);
+    while (!process_.empty() && !is_async_pending()) {
+      auto &event = process_.front();
+      if (!is_superseded(process_, event.id)) {
+        (this->*dispatch_table[event.id])(deps, subs, locked, event.data);
+      }
       process_.pop();
     }
     return wasnt_empty;
   }
   template <class TVisitor, class... TStates>
-  void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<0>) const {
+  static void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<0>,
+                                   const state_t (&current_state)[regions]) {
     using dispatch_table_t = void (*)(const TVisitor &);
     const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TStates))] = {
         &sm_impl::visit_state<TVisitor, TStates>...};
-    dispatch_table[current_state_[0]](visitor);
+    dispatch_table[current_state[0]](visitor);
   }
   template <class TVisitor, class... TStates, int... Ns>
-  void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<Ns...>) const {
+  static void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<Ns...>,
+                                   const state_t (&current_state)[regions]) {
     using dispatch_table_t = void (*)(const TVisitor &);
     const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TStates))] = {
         &sm_impl::visit_state<TVisitor, TStates>...};
 #if defined(__cpp_fold_expressions)
-    (dispatch_table[current_state_[Ns]](visitor), ...);
+    (dispatch_table[current_state[Ns]](visitor), ...);
 #else
-    (void)aux::swallow{0, (dispatch_table[current_state_[Ns]](visitor), 0)...};
+    (void)aux::swallow{0, (dispatch_table[current_state[Ns]](visitor), 0)...};
 #endif
   }
   template <class TVisitor, class TState>
@@ -1582,22 +2680,79 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     return result;
 #endif
   }
-  transitions_t transitions_;
+  transitions_storage_t transitions_;
   state_t current_state_[regions];
   thread_safety_t thread_safety_;
+  seqlock_t seqlock_;
+  occupancy_t occupancy_;
+  async_pending_t async_pending_{};
+  async_pending_t async_epoch_{};
+  timers_t timers_{};
+  parallel_regions_t parallel_regions_;
   defer_t defer_;
   process_t process_;
   defer_flag_t defer_processing_ = defer_flag_t{};
   defer_flag_t defer_again_ = defer_flag_t{};
+  defer_flag_t defer_pending_ = defer_flag_t{};
+  defer_event_t defer_event_ = defer_event_t{};
   typename defer_t::const_iterator defer_it_;
   typename defer_t::const_iterator defer_end_;
 };
+template <class T>
+class states_snapshot {
+  using state_t = typename T::state_t;
+  using states_ids_t = typename T::states_ids_t;
+
+ public:
+  explicit states_snapshot(const T &sm) { sm.load_states(current_state_); }
+  template <class TVisitor, __BOOST_SML_REQUIRES(concepts::callable<void, TVisitor>::value)>
+  void visit_current_states(const TVisitor &visitor) const {
+    T::visit_current_states(visitor, typename T::states_t{}, aux::make_index_sequence<T::regions>{}, current_state_);
+  }
+  template <class TState>
+  bool is(const TState &) const {
+    return aux::get_id<state_t, typename TState::type>((states_ids_t *)0) == current_state_[0];
+  }
+  template <class... TStates, __BOOST_SML_REQUIRES((sizeof...(TStates) > 1) && sizeof...(TStates) == T::regions)>
+  bool is(const TStates &...) const {
+    const state_t state_ids[] = {aux::get_id<state_t, typename TStates::type>((states_ids_t *)0)...};
+    for (auto i = 0u; i < sizeof...(TStates); ++i) {
+      if (state_ids[i] != current_state_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  state_t current_state_[T::regions];
+};
+template <class TSM>
+struct events_visitor {
+  template <class TEvent>
+  bool operator()(const TEvent &event) const {
+    return sm.process_events_impl(event, aux::false_type{});
+  }
+  TSM &sm;
+};
+template <class TSM, class T, class = void>
+struct is_events_variant : aux::false_type {};
+template <class TSM, class T>
+struct is_events_variant<
+    TSM, T, aux::void_t<decltype(visit(aux::declval<events_visitor<TSM>>(), aux::declval<const T &>()))>>
+    : aux::true_type {};
 template <class TSM>
 class sm {
   using sm_t = typename TSM::sm;
   using logger_t = typename TSM::logger_policy::type;
   using logger_dep_t =
       aux::conditional_t<aux::is_same<no_policy, logger_t>::value, aux::type_list<>, aux::type_list<logger_t &>>;
+  using async_executor_t = typename TSM::async_executor_policy::type;
+  using async_executor_dep_t = aux::conditional_t<aux::is_same<no_policy, async_executor_t>::value, aux::type_list<>,
+                                                  aux::type_list<async_executor_t &>>;
+  using timer_service_t = typename TSM::timer_service_policy::type;
+  using timer_service_dep_t = aux::conditional_t<aux::is_same<no_policy, timer_service_t>::value, aux::type_list<>,
+                                                 aux::type_list<timer_service_t &>>;
   using transitions_t = decltype(aux::declval<sm_t>().operator()());
   static_assert(concepts::composable<sm_t>::value, "Composable constraint is not satisfied!");
 
@@ -1609,16 +2764,66 @@ class sm {
 
  private:
   using sm_all_t = aux::apply_t<get_non_empty_t, aux::join_t<aux::type_list<sm_t>, aux::apply_t<get_sm_t, state_machines>>>;
-  using sub_sms_t =
-      aux::apply_t<aux::pool,
-                   typename convert_to_sm<TSM, aux::apply_t<aux::unique_t, aux::apply_t<get_sub_sms, states>>>::type>;
+  using sub_sms_list_t = typename convert_to_sm<TSM, aux::apply_t<aux::unique_t, aux::apply_t<get_sub_sms, states>>>::type;
+  using sub_sms_t = aux::apply_t<aux::pool, sub_sms_list_t>;
   using deps = aux::apply_t<merge_deps, transitions_t>;
-  using deps_t =
-      aux::apply_t<aux::pool,
-                   aux::apply_t<aux::unique_t, aux::join_t<deps, sm_all_t, logger_dep_t, aux::apply_t<merge_deps, sub_sms_t>>>>;
+  using policy_deps_t = aux::join_t<logger_dep_t, async_executor_dep_t, timer_service_dep_t>;
+  using deps_t = aux::apply_t<
+      aux::pool, aux::apply_t<aux::unique_t, aux::join_t<deps, sm_all_t, policy_deps_t, aux::apply_t<merge_deps, sub_sms_t>>>>;
   struct events_ids : aux::apply_t<aux::inherit, events> {};
+  template <class T, class... TSubSms>
+  static constexpr bool sub_sms_timeouts(const aux::type_list<T, TSubSms...> &) {
+    constexpr bool timeouts[] = {false, TSubSms::has_timeouts::value...};
+    auto result = false;
+    for (const auto t : timeouts) {
+      result |= t;
+    }
+    return result;
+  }
+  static_assert(!sub_sms_timeouts(sub_sms_list_t{}), "`after` transitions aren't supported by sub state machines!");
+  template <class... TSubSms>
+  static constexpr int instance_size_impl(const aux::type_list<TSubSms...> &) {
+    constexpr int sizes[] = {0, int(sizeof(TSubSms::current_state_))...};
+    auto size = 0;
+    for (const auto s : sizes) {
+      size += s;
+    }
+    return size;
+  }
+  template <class TEvent, class TState, __BOOST_SML_REQUIRES(aux::is_base_of<TEvent, events_ids>::value)>
+  static bool process_event_in(sm &self, const TEvent &event) {
+    return aux::get<sm_impl<TSM>>(self.sub_sms_).template process_event_in<TState>(event, self.deps_, self.sub_sms_);
+  }
+  template <class TEvent, class TState, __BOOST_SML_REQUIRES(!aux::is_base_of<TEvent, events_ids>::value)>
+  static bool process_event_in(sm &self, const TEvent &event) {
+    return self.process_event(event);
+  }
+  template <class TEvent, class... TStates>
+  static const auto *state_handlers_impl(const aux::type_list<TStates...> &) {
+    using state_handler_t = bool (*)(sm &, const TEvent &);
+    static const state_handler_t handlers[] = {&sm::process_event_in<TEvent, TStates>...};
+    return handlers;
+  }
+  template <class... TSubSms>
+  void load_instance_impl(const aux::byte *states, const aux::type_list<TSubSms...> &) {
+    (void)aux::swallow{0, (aux::get<TSubSms>(sub_sms_).load_instance(states), states += sizeof(TSubSms::current_state_), 0)...};
+  }
+  template <class... TSubSms>
+  void reset_impl(const aux::type_list<TSubSms...> &) {
+    (void)aux::swallow{0, (aux::get<TSubSms>(sub_sms_).reset(), 0)...};
+  }
+  template <class... TSubSms>
+  static void occupy_instance_impl(const aux::byte *states, const long n, const aux::type_list<TSubSms...> &) {
+    (void)aux::swallow{0, (TSubSms::occupy_instance(states, n), states += sizeof(TSubSms::current_state_), 0)...};
+  }
+  template <class... TSubSms>
+  void store_instance_impl(aux::byte *states, const aux::type_list<TSubSms...> &) const {
+    (void)aux::swallow{0, (aux::cget<TSubSms>(sub_sms_).store_instance(states), states += sizeof(TSubSms::current_state_), 0)...};
+  }
 
  public:
+  using deferred_t = typename sm_impl<TSM>::defer_t;
+  using has_timeouts = typename sm_impl<TSM>::has_timeouts;
   sm() : deps_{aux::init{}, aux::pool<>{}}, sub_sms_{aux::pool<>{}} { aux::get<sm_impl<TSM>>(sub_sms_).start(deps_, sub_sms_); }
   template <class TDeps, __BOOST_SML_REQUIRES(!aux::is_same<aux::remove_reference_t<TDeps>, sm>::value)>
   explicit sm(TDeps &&deps) : deps_{aux::init{}, aux::pool<TDeps>{deps}}, sub_sms_{aux::pool<TDeps>{deps}} {
@@ -1635,27 +2840,49 @@ class sm {
   sm &operator=(sm &&) = default;
   template <class TEvent, __BOOST_SML_REQUIRES(aux::is_base_of<TEvent, events_ids>::value)>
   bool process_event(const TEvent &event) {
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value ||
+                      aux::is_constructible<TEvent, const TEvent &>::value,
+                  "Non-copyable events have to be processed as rvalues when the defer queue policy is used!");
     return aux::get<sm_impl<TSM>>(sub_sms_).process_event(event, deps_, sub_sms_);
   }
+  template <class TEvent,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_const_t<aux::remove_reference_t<TEvent>>, TEvent>::value &&
+                                 aux::is_base_of<TEvent, events_ids>::value)>
+  bool process_event(TEvent &&event) {
+    return aux::get<sm_impl<TSM>>(sub_sms_).process_event(static_cast<TEvent &&>(event), deps_, sub_sms_);
+  }
   template <class TEvent, __BOOST_SML_REQUIRES(!aux::is_base_of<TEvent, events_ids>::value)>
   bool process_event(const TEvent &event) {
     return aux::get<sm_impl<TSM>>(sub_sms_).process_event(unexpected_event<_, TEvent>{event}, deps_, sub_sms_);
   }
+  template <class TIt>
+  int process_events(TIt first, const TIt last) {
+    auto &impl = aux::get<sm_impl<TSM>>(sub_sms_);
+    const auto lock = impl.thread_safety_.create_batch_lock(impl.current_state_);
+    (void)lock;
+    using value_t = aux::remove_const_t<aux::remove_reference_t<decltype(*first)>>;
+    auto handled = 0;
+    for (; first != last; ++first) {
+      handled += process_events_impl(*first, is_events_variant<sm, value_t>{});
+    }
+    return handled;
+  }
   template <class T = aux::identity<sm_t>, class TVisitor, __BOOST_SML_REQUIRES(concepts::callable<void, TVisitor>::value)>
   void visit_current_states(const TVisitor &visitor) const {
     using type = typename T::type;
     using sm_impl_t = sm_impl<typename TSM::template rebind<type>>;
-    using states_t = typename sm_impl_t::states_t;
-    constexpr auto regions = sm_impl_t::regions;
-    aux::cget<sm_impl_t>(sub_sms_).visit_current_states(visitor, states_t{}, aux::make_index_sequence<regions>{});
+    states_snapshot<sm_impl_t>{aux::cget<sm_impl_t>(sub_sms_)}.visit_current_states(visitor);
   }
-  template <class T = aux::identity<sm_t>, class TState>
-  bool is(const TState &) const {
+  template <class T = aux::identity<sm_t>>
+  auto snapshot_states() const {
     using type = typename T::type;
     using sm_impl_t = sm_impl<typename TSM::template rebind<type>>;
-    using state_t = typename sm_impl_t::state_t;
-    using states_ids_t = typename sm_impl_t::states_ids_t;
-    return aux::get_id<state_t, typename TState::type>((states_ids_t *)0) == aux::cget<sm_impl_t>(sub_sms_).current_state_[0];
+    return states_snapshot<sm_impl_t>{aux::cget<sm_impl_t>(sub_sms_)};
+  }
+  bool pending() const { return aux::cget<sm_impl<TSM>>(sub_sms_).is_async_pending(); }
+  template <class T = aux::identity<sm_t>, class TState>
+  bool is(const TState &state) const {
+    return snapshot_states<T>().is(state);
   }
   template <class T = aux::identity<sm_t>, template <class...> class TState>
   bool is(const TState<terminate_state> &) const {
@@ -1687,6 +2914,16 @@ class sm {
     });
     return result;
   }
+  template <class T = aux::identity<sm_t>, class TState>
+  static long occupancy(const TState &) {
+    using type = typename T::type;
+    using sm_impl_t = sm_impl<typename TSM::template rebind<type>>;
+    using states_ids_t = typename sm_impl_t::states_ids_t;
+    using state_t = typename sm_impl_t::state_t;
+    static_assert(!aux::is_same<no_policy, typename TSM::occupancy_policy>::value,
+                  "State Machine requires the occupancy policy to count instances in the states!");
+    return sm_impl_t::occupancy_t::count(aux::get_id<state_t, typename TState::type>((states_ids_t *)0));
+  }
   template <class T = aux::identity<sm_t>, class... TStates,
             __BOOST_SML_REQUIRES(!aux::is_same<no_policy, typename TSM::testing_policy>::value && aux::always<T>::value)>
   void set_current_states(const TStates &...) {
@@ -1695,6 +2932,8 @@ class sm {
     using states_ids_t = typename sm_impl_t::states_ids_t;
     using state_t = typename sm_impl_t::state_t;
     auto &sm = aux::get<sm_impl_t>(sub_sms_);
+    const auto counter = sm.occupancy_.create_counter(sm.current_state_);
+    (void)counter;
     auto region = 0;
 #if defined(__cpp_fold_expressions)
     ((sm.current_state_[region++] = aux::get_id<state_t, typename TStates::type>((states_ids_t *)0)), ...);
@@ -1702,6 +2941,36 @@ class sm {
     (void)aux::swallow{0,
                        (sm.current_state_[region++] = aux::get_id<state_t, typename TStates::type>((states_ids_t *)0), 0)...};
 #endif
+    sm.publish_states();
+  }
+  void reset() {
+    reset_impl(sub_sms_list_t{});
+    aux::get<sm_impl<TSM>>(sub_sms_).start(deps_, sub_sms_);
+  }
+  static constexpr int instance_size() { return instance_size_impl(sub_sms_list_t{}); }
+  void load_instance(const aux::byte *states) { load_instance_impl(states, sub_sms_list_t{}); }
+  void store_instance(aux::byte *states) const { store_instance_impl(states, sub_sms_list_t{}); }
+  static void occupy_instance(const aux::byte *states, const long n) { occupy_instance_impl(states, n, sub_sms_list_t{}); }
+  void swap_deferred(deferred_t &deferred) { aux::get<sm_impl<TSM>>(sub_sms_).swap_deferred(deferred); }
+  template <class TEvent>
+  static auto state_handlers() {
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value ||
+                      aux::is_constructible<TEvent, const TEvent &>::value,
+                  "Non-copyable events have to be processed as rvalues when the defer queue policy is used!");
+    return state_handlers_impl<TEvent>(typename sm_impl<TSM>::states_t{});
+  }
+  int current_state_id() const {
+    typename sm_impl<TSM>::state_t current_state[sm_impl<TSM>::regions];
+    aux::cget<sm_impl<TSM>>(sub_sms_).load_states(current_state);
+    return current_state[0];
+  }
+  static int current_state_id(const aux::byte *states) {
+    typename sm_impl<TSM>::state_t state{};
+    const auto bytes = reinterpret_cast<aux::byte *>(&state);
+    for (auto i = 0u; i < sizeof(state); ++i) {
+      bytes[i] = states[i];
+    }
+    return state;
   }
   template <class T>
   operator T &() {
@@ -1713,6 +2982,23 @@ class sm {
   }
 
  private:
+  template <class>
+  friend struct events_visitor;
+  template <class TEvent, __BOOST_SML_REQUIRES(aux::is_base_of<TEvent, events_ids>::value)>
+  bool process_events_impl(const TEvent &event, aux::false_type) {
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value ||
+                      aux::is_constructible<TEvent, const TEvent &>::value,
+                  "Non-copyable events have to be processed as rvalues when the defer queue policy is used!");
+    return aux::get<sm_impl<TSM>>(sub_sms_).process_event(event, deps_, sub_sms_, true);
+  }
+  template <class TEvent, __BOOST_SML_REQUIRES(!aux::is_base_of<TEvent, events_ids>::value)>
+  bool process_events_impl(const TEvent &event, aux::false_type) {
+    return aux::get<sm_impl<TSM>>(sub_sms_).process_event(unexpected_event<_, TEvent>{event}, deps_, sub_sms_, true);
+  }
+  template <class TVariant>
+  bool process_events_impl(const TVariant &variant, aux::true_type) {
+    return visit(events_visitor<sm>{*this}, variant);
+  }
   deps_t deps_;
   sub_sms_t sub_sms_;
 };
@@ -1763,11 +3049,11 @@ decltype(auto) get_arg(const aux::type<const TEvent &> &, const back::exception<
   return event.exception_;
 }
 template <class... TEvents, class TEvent, class TSM, class TDeps>
-decltype(auto) get_arg(const aux::type<back::defer<TEvents...>> &, const TEvent, TSM &sm, TDeps &) {
+decltype(auto) get_arg(const aux::type<back::defer<TEvents...>> &, const TEvent &, TSM &sm, TDeps &) {
   return back::defer<TEvents...>{sm.defer_};
 }
 template <class... TEvents, class TEvent, class TSM, class TDeps>
-decltype(auto) get_arg(const aux::type<back::process<TEvents...>> &, const TEvent, TSM &sm, TDeps &) {
+decltype(auto) get_arg(const aux::type<back::process<TEvents...>> &, const TEvent &, TSM &sm, TDeps &) {
   return back::process<TEvents...>{sm.process_};
 }
 template <class, class, class>
@@ -1974,24 +3260,53 @@ struct defer : action_base {
   void operator()(const TEvent &event, TSM &sm, TDeps &, TSubs &) {
     if (sm.defer_processing_) {
       sm.defer_again_ = true;
+    } else if (sm.defer_event_ == &event) {
+      sm.defer_pending_ = true;
     } else {
-      sm.defer_.push_back(event);
+      push_back<get_root_sm_t<TSubs>>(event, sm, aux::is_constructible<TEvent, const TEvent &>{});
     }
   }
+
+ private:
+  template <class TRootSM, class TEvent, class TSM>
+  static void push_back(const TEvent &event, TSM &sm, const aux::true_type &) {
+    sm.defer_.push_back(event);
+  }
+  template <class TRootSM, class TEvent, class TSM>
+  static void push_back(const TEvent &, TSM &, const aux::false_type &) {
+    static_assert(aux::is_same<TRootSM, TSM>::value, "Non-copyable events can only be deferred by the root state machine!");
+  }
 };
 }
 }
 using testing = back::policies::testing;
+using shared_transitions = back::policies::shared_transitions;
 template <class T>
 using logger = back::policies::logger<T>;
 template <class T>
+using async_executor = back::policies::async_executor<T>;
+template <class T>
+using timer_service = back::policies::timer_service<T>;
+template <class T>
 using thread_safe = back::policies::thread_safe<T>;
 template <class T>
+using thread_safe_regions = back::policies::thread_safe_regions<T>;
+template <class T, template <class...> class TAtomic>
+using optimistic_thread_safe = back::policies::optimistic_thread_safe<T, TAtomic>;
+template <class T>
 using dispatch = back::policies::dispatch<T>;
+template <class T>
+using parallel_regions = back::policies::parallel_regions<T>;
 template <template <class...> class T>
-using defer_queue = back::policies::defer_queue<T>;
-template <template <class...> class T>
-using process_queue = back::policies::process_queue<T>;
+using seqlock = back::policies::seqlock<T>;
+template <template <class...> class T, int Shards = 1>
+using occupancy = back::policies::occupancy<T, Shards>;
+template <template <class...> class T, class TAllocator = void>
+using defer_queue = back::policies::defer_queue<T, TAllocator>;
+template <template <class...> class T, class TAllocator = void>
+using process_queue = back::policies::process_queue<T, TAllocator>;
+template <template <class...> class T, class TAllocator = void>
+using priority_process_queue = back::policies::priority_process_queue<T, TAllocator>;
 #if defined(COMPILING_WITH_MSVC)
 template <class T, class... TPolicies, class T__ = aux::remove_reference_t<decltype(aux::declval<T>())>>
 using sm = back::sm<back::sm_policy<T__, TPolicies...>>;
@@ -2009,11 +3324,44 @@ struct transitional : decltype(transitional_impl(aux::declval<T>())) {};
 }
 namespace front {
 namespace actions {
+struct async_action {
+  template <class T>
+  class async_action_impl : operator_base {
+   public:
+    explicit async_action_impl(T action) : action(action) {}
+    template <class TEvent, class TSM, class TDeps, class TSubs>
+    void operator()(const TEvent &event, TSM &sm, TDeps &deps, TSubs &subs) {
+      using root_sm_t = get_root_sm_t<TSubs>;
+      using executor_t = typename root_sm_t::async_executor_t;
+      static_assert(!aux::is_same<back::no_policy, executor_t>::value,
+                    "Asynchronous actions require sml::async_executor policy!");
+      static_assert(!aux::is_same<back::no_policy, typename root_sm_t::defer_t>::value,
+                    "Asynchronous actions require sml::defer_queue policy!");
+      auto &root = aux::get<root_sm_t>(subs);
+      ++root.async_pending_;
+      const auto epoch = root.async_epoch_;
+      static_cast<aux::pool_type<executor_t &> &>(deps).value.async_wait(
+          call<TEvent, args_t<T, TEvent>, back::no_policy>::execute(action, event, sm, deps, subs),
+          [&root, &deps, &subs, epoch] { root.complete_async(deps, subs, epoch); });
+    }
+
+   private:
+    T action;
+  };
+  template <class T>
+  auto operator()(T action) const {
+    return async_action_impl<T>{action};
+  }
+};
+}
+}
+namespace front {
+namespace actions {
 struct process {
   template <class TEvent>
   class process_impl : public action_base {
    public:
-    explicit process_impl(const TEvent &event) : event(event) {}
+    explicit process_impl(TEvent event) : event(static_cast<TEvent &&>(event)) {}
     template <class T, class TSM, class TDeps, class TSubs>
     void operator()(const T &, TSM &, TDeps &, TSubs &subs) {
       aux::get<get_root_sm_t<TSubs>>(subs).process_.push(event);
@@ -2023,8 +3371,8 @@ struct process {
     TEvent event;
   };
   template <class TEvent>
-  auto operator()(const TEvent &event) {
-    return process_impl<TEvent>{event};
+  auto operator()(TEvent &&event) {
+    return process_impl<aux::remove_const_t<aux::remove_reference_t<TEvent>>>{static_cast<TEvent &&>(event)};
   }
 };
 }
@@ -2046,6 +3394,11 @@ struct event {
   }
   auto operator()() const { return TEvent{}; }
 };
+template <class TDuration>
+struct after_ {
+  bool operator()() const { return true; }
+  TDuration duration;
+};
 }
 namespace front {
 struct initial_state {};
@@ -2170,7 +3523,7 @@ struct always {
   bool operator()() const { return true; }
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
 };
-struct none {
+struct none : back::no_action {
   using type = none;
   void operator()() {}
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
@@ -2334,7 +3687,8 @@ template <class T, class TSubs, class... Ts, class... THs>
 void update_composite_states(TSubs &subs, aux::true_type, const aux::type_list<THs...> &) {
   using state_t = typename T::state_t;
   auto &sm = back::sub_sm<T>::get(&subs);
-  (void)sm;
+  const auto counter = sm.occupancy_.create_counter(sm.current_state_);
+  (void)counter;
 #if defined(__cpp_fold_expressions)
   ((sm.current_state_[aux::get_id<state_t, THs>((typename T::initial_states_ids_t *)0)] =
         aux::get_id<state_t, THs>((typename T::states_ids_t *)0)),
@@ -2344,25 +3698,34 @@ void update_composite_states(TSubs &subs, aux::true_type, const aux::type_list<T
                              aux::get_id<state_t, THs>((typename T::states_ids_t *)0),
                          0)...};
 #endif
+  sm.publish_states();
 }
 template <class T, class TSubs, class... Ts>
 void update_composite_states(TSubs &subs, aux::false_type, Ts &&...) {
-  back::sub_sm<T>::get(&subs).initialize(typename T::initial_states_t{});
+  auto &sm = back::sub_sm<T>::get(&subs);
+  const auto counter = sm.occupancy_.create_counter(sm.current_state_);
+  (void)counter;
+  sm.initialize(typename T::initial_states_t{});
+  sm.publish_states();
 }
 template <class SM, class TDeps, class TSubs, class TSrcState, class TDstState>
-void update_current_state(SM &, TDeps &deps, TSubs &, typename SM::state_t &current_state,
+void update_current_state(SM &sm, TDeps &deps, TSubs &subs, typename SM::state_t &current_state,
                           const typename SM::state_t &new_state, const TSrcState &, const TDstState &) {
   back::policies::log_state_change<typename SM::sm_t>(aux::type<typename SM::logger_t>{}, deps,
                                                       aux::string<typename TSrcState::type>{},
                                                       aux::string<typename TDstState::type>{});
+  sm.occupancy_.change(current_state, new_state);
   current_state = new_state;
+  sm.arm_timeout(deps, subs, current_state);
 }
 template <class SM, class TDeps, class TSubs, class TSrcState, class T>
-void update_current_state(SM &, TDeps &deps, TSubs &subs, typename SM::state_t &current_state,
+void update_current_state(SM &sm, TDeps &deps, TSubs &subs, typename SM::state_t &current_state,
                           const typename SM::state_t &new_state, const TSrcState &, const state<back::sm<T>> &) {
   back::policies::log_state_change<typename SM::sm_t>(aux::type<typename SM::logger_t>{}, deps,
                                                       aux::string<typename TSrcState::type>{}, aux::string<T>{});
+  sm.occupancy_.change(current_state, new_state);
   current_state = new_state;
+  sm.arm_timeout(deps, subs, current_state);
   update_composite_states<back::sm_impl<T>>(subs, typename back::sm_impl<T>::has_history_states{},
                                             typename back::sm_impl<T>::history_states_t{});
 }
@@ -2606,6 +3969,11 @@ template <class TEvent>
 front::event<back::unexpected_event<TEvent>> unexpected_event __BOOST_SML_VT_INIT;
 template <class T>
 front::event<back::exception<T>> exception __BOOST_SML_VT_INIT;
+template <class TDuration>
+auto after(const TDuration &duration) {
+  return front::transition_eg<front::event<back::timeout>, aux::zero_wrapper<front::after_<TDuration>>>{
+      {}, aux::zero_wrapper<front::after_<TDuration>>{front::after_<TDuration>{duration}}};
+}
 using anonymous = back::anonymous;
 using initial = back::initial;
 #if !defined(COMPILING_WITH_MSVC)
@@ -2631,6 +3999,7 @@ __BOOST_SML_UNUSED static front::state<back::terminate_state> X;
 __BOOST_SML_UNUSED static front::history_state H;
 __BOOST_SML_UNUSED static front::actions::defer defer;
 __BOOST_SML_UNUSED static front::actions::process process;
+__BOOST_SML_UNUSED static front::actions::async_action async_action;
 template <class... Ts, __BOOST_SML_REQUIRES(aux::is_same<aux::bool_list<aux::always<Ts>::value...>,
                                                          aux::bool_list<concepts::transitional<Ts>::value...>>::value)>
 auto make_transition_table(Ts... ts) {
@@ -15,6 +15,7 @@ struct _ {};
 struct initial {};
 struct unexpected {};
 struct entry_exit {};
+struct no_action {};
 
 struct terminate_state {
   static auto c_str() { return "terminate"; }
@@ -28,6 +29,10 @@ struct anonymous : internal_event {
   static auto c_str() { return "anonymous"; }
 };
 
+struct timeout {
+  static auto c_str() { return "timeout"; }
+};
+
 template <class T, class TEvent = T>
 struct on_entry : internal_event, entry_exit {
   static auto c_str() { return "on_entry"; }
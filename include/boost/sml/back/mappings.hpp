@@ -170,6 +170,32 @@ struct get_event_mapping_impl_helper<on_exit<T1, T2>, TMappings>
 template <class T, class TMappings>
 using get_event_mapping_t = get_event_mapping_impl_helper<T, TMappings>;
 
+template <class... Ts>
+constexpr bool has_actions(const aux::type_list<Ts...> &) {
+  constexpr bool actions[] = {false, !aux::is_base_of<no_action, typename Ts::action>::value...};
+  auto result = false;
+  for (const auto action : actions) {
+    result |= action;
+  }
+  return result;
+}
+
+/// any transition of the event mappings (generic `_` ones included) has an action
+template <class... TStates, class... TTransitions>
+constexpr bool has_actions(const aux::inherit<state_mappings<TStates, TTransitions>...> *) {
+  return has_actions(aux::join_t<TTransitions...>{});
+}
+
+constexpr bool has_actions(...) { return false; }
+
+aux::type_list<> get_mapped_states_impl(...);
+
+template <class... Ts, class... TTransitions>
+aux::type_list<Ts...> get_mapped_states_impl(aux::inherit<state_mappings<Ts, TTransitions>...> *);
+
+template <class TMappings>
+using get_mapped_states_t = decltype(get_mapped_states_impl((TMappings *)0));
+
 }  // namespace back
 
 #endif
@@ -8,17 +8,23 @@
 #define BOOST_SML_BACK_POLICIES_HPP
 
 #include "boost/sml/aux_/utility.hpp"
+#include "boost/sml/back/policies/async_executor.hpp"
 #include "boost/sml/back/policies/defer_queue.hpp"
 #include "boost/sml/back/policies/dispatch.hpp"
 #include "boost/sml/back/policies/logger.hpp"
+#include "boost/sml/back/policies/occupancy.hpp"
+#include "boost/sml/back/policies/parallel_regions.hpp"
 #include "boost/sml/back/policies/process_queue.hpp"
+#include "boost/sml/back/policies/seqlock.hpp"
+#include "boost/sml/back/policies/shared_transitions.hpp"
 #include "boost/sml/back/policies/testing.hpp"
 #include "boost/sml/back/policies/thread_safety.hpp"
+#include "boost/sml/back/policies/timer_service.hpp"
 #include "boost/sml/back/utility.hpp"  // rebind_impl
 
 namespace back {
 
-struct no_policy : policies::thread_safety_policy__ {
+struct no_policy : policies::thread_safety_policy__, policies::seqlock_policy__, policies::occupancy_policy__ {
   using type = no_policy;
   template <class>
   using rebind = no_policy;
@@ -26,6 +32,7 @@ struct no_policy : policies::thread_safety_policy__ {
   using defer = no_policy;
   using const_iterator = no_policy;
   using flag = no_policy;
+  using allocator = void;
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
 };
 
@@ -54,6 +61,16 @@ struct sm_policy {
   using process_queue_policy =
       decltype(get_policy<no_policy, policies::process_queue_policy__>((aux::inherit<TPolicies...> *)0));
   using logger_policy = decltype(get_policy<no_policy, policies::logger_policy__>((aux::inherit<TPolicies...> *)0));
+  using parallel_regions_policy =
+      decltype(get_policy<no_policy, policies::parallel_regions_policy__>((aux::inherit<TPolicies...> *)0));
+  using seqlock_policy = decltype(get_policy<no_policy, policies::seqlock_policy__>((aux::inherit<TPolicies...> *)0));
+  using occupancy_policy = decltype(get_policy<no_policy, policies::occupancy_policy__>((aux::inherit<TPolicies...> *)0));
+  using shared_transitions_policy =
+      decltype(get_policy<no_policy, policies::shared_transitions_policy__>((aux::inherit<TPolicies...> *)0));
+  using async_executor_policy =
+      decltype(get_policy<no_policy, policies::async_executor_policy__>((aux::inherit<TPolicies...> *)0));
+  using timer_service_policy =
+      decltype(get_policy<no_policy, policies::timer_service_policy__>((aux::inherit<TPolicies...> *)0));
   using testing_policy = decltype(get_policy<no_policy, policies::testing_policy__>((aux::inherit<TPolicies...> *)0));
   using dispatch_policy =
       decltype(get_policy<default_dispatch_policy, policies::dispatch_policy__>((aux::inherit<TPolicies...> *)0));
@@ -0,0 +1,29 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_BACK_POLICIES_ASYNC_EXECUTOR_HPP
+#define BOOST_SML_BACK_POLICIES_ASYNC_EXECUTOR_HPP
+
+#include "boost/sml/aux_/utility.hpp"
+
+namespace back {
+namespace policies {
+
+struct async_executor_policy__ {};
+
+/// Executor of `async_action`s, passed to the state machine as a dependency
+///   template <class T, class F> void async_wait(T &&awaitable, F &&completion);
+/// `completion` has to be called once the awaitable is resolved, after `async_wait` returned and by the thread
+/// processing events of the state machine
+template <class T>
+struct async_executor : aux::pair<async_executor_policy__, async_executor<T>> {
+  using type = T;
+};
+
+}  // namespace policies
+}  // namespace back
+
+#endif
@@ -14,11 +14,12 @@ namespace policies {
 
 struct defer_queue_policy__ {};
 
-template <template <class...> class T>
-struct defer_queue : aux::pair<back::policies::defer_queue_policy__, defer_queue<T>> {
+template <template <class...> class T, class TAllocator = void>
+struct defer_queue : aux::pair<back::policies::defer_queue_policy__, defer_queue<T, TAllocator>> {
   template <class U>
   using rebind = T<U>;
   using flag = bool;
+  using allocator = TAllocator;
 };
 
 }  // namespace policies
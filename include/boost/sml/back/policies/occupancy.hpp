@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_BACK_POLICIES_OCCUPANCY_HPP
+#define BOOST_SML_BACK_POLICIES_OCCUPANCY_HPP
+
+#include "boost/sml/aux_/utility.hpp"
+
+namespace back {
+namespace policies {
+
+struct occupancy_policy__ {
+  template <class T>
+  void occupy(const T &) {}
+
+  template <class T>
+  void change(const T &, const T &) {}
+
+  template <class T>
+  auto create_counter(const T &) {
+    return *this;
+  }
+
+  template <class T>
+  static void add(const T *, int, long) {}
+
+  __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
+};
+
+template <template <class...> class TAtomic, int Shards, class>
+class occupancy_impl;
+
+/// Counters of instances being in each of N states, shared by all instances of the state machine type (TTag),
+/// writers update the shard of the current thread, readers sum all shards
+template <template <class...> class TAtomic, int Shards, class TTag, class T, int N>
+class occupancy_impl<TAtomic, Shards, aux::pair<TTag, T[N]>> {
+  static_assert(Shards > 0, "At least one shard is required");
+
+  struct alignas(64) shard {
+    TAtomic<long> counters[N]{};
+  };
+
+  template <int R>
+  class counter {
+   public:
+    explicit counter(const T (&states)[R]) : current_(states) {
+      for (auto i = 0; i < R; ++i) {
+        states_[i] = states[i];
+      }
+    }
+
+    ~counter() {
+      for (auto i = 0; i < R; ++i) {
+        change(states_[i], current_[i]);
+      }
+    }
+
+   private:
+    T states_[R];
+    const T (&current_)[R];
+  };
+
+ public:
+  occupancy_impl() = default;
+  occupancy_impl(const occupancy_impl &) = delete;
+  occupancy_impl &operator=(const occupancy_impl &) = delete;
+  ~occupancy_impl() { add(states_, regions_, -1); }
+
+  /// counts the instance in its states until it's destroyed
+  template <int R>
+  void occupy(const T (&states)[R]) {
+    states_ = states;
+    regions_ = R;
+    add(states, R, 1);
+  }
+
+  static void change(const T from, const T to) {
+    if (from != to) {
+      auto &s = local();
+      --s.counters[from];
+      ++s.counters[to];
+    }
+  }
+
+  /// counts the changes of the states made until the counter goes out of scope
+  template <int R>
+  auto create_counter(const T (&states)[R]) {
+    return counter<R>{states};
+  }
+
+  static void add(const T *states, const int regions, const long n) {
+    auto &s = local();
+    for (auto i = 0; i < regions; ++i) {
+      s.counters[states[i]] += n;
+    }
+  }
+
+  static long count(const T state) {
+    auto count = 0l;
+    for (auto i = 0; i < Shards; ++i) {
+      count += shards()[i].counters[state].load();
+    }
+    return count;
+  }
+
+ private:
+  static shard *shards() {
+    static shard shards[Shards];
+    return shards;
+  }
+
+  static shard &local() { return local(aux::integral_constant<bool, Shards == 1>{}); }
+  static shard &local(aux::true_type) { return shards()[0]; }
+  static shard &local(aux::false_type) {
+    static TAtomic<unsigned> threads{0u};
+    static thread_local auto &s = shards()[threads++ % Shards];
+    return s;
+  }
+
+  const T *states_ = nullptr;
+  int regions_ = 0;
+};
+
+template <template <class...> class TAtomic, int Shards = 1>
+struct occupancy : aux::pair<occupancy_policy__, occupancy<TAtomic, Shards>> {
+  template <class T>
+  using rebind = occupancy_impl<TAtomic, Shards, T>;
+};
+
+}  // namespace policies
+}  // namespace back
+
+#endif
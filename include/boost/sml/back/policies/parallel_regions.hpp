@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_BACK_POLICIES_PARALLEL_REGIONS_HPP
+#define BOOST_SML_BACK_POLICIES_PARALLEL_REGIONS_HPP
+
+#include "boost/sml/aux_/utility.hpp"
+
+namespace back {
+namespace policies {
+
+struct parallel_regions_policy__ {};
+
+template <class T, class = void>
+struct is_thread_safe : aux::false_type {};
+
+template <class T>
+struct is_thread_safe<T, aux::void_t<aux::integral_constant<bool, T::thread_safe>>>
+    : aux::integral_constant<bool, T::thread_safe> {};
+
+template <class TRegionsMasks, class T, class TDep = aux::remove_const_t<aux::remove_reference_t<T>>>
+constexpr unsigned long long shared_deps_regions() {
+  return is_thread_safe<TDep>::value ? 0 : TRegionsMasks::template deps_regions<TDep>();
+}
+
+/// each dependency which isn't thread safe may be used only by the actions/guards of a single region
+template <class TRegionsMasks, class... TDeps>
+constexpr bool disjoint_deps(const aux::type_list<TDeps...> &) {
+  constexpr unsigned long long masks[] = {0, shared_deps_regions<TRegionsMasks, TDeps>()...};
+  auto disjoint = true;
+  for (const auto mask : masks) {
+    disjoint &= !(mask & (mask - 1));
+  }
+  return disjoint;
+}
+
+/// Executor requirements
+///   template <class F> void bulk_execute(F &&f, int n); // calls f(0)...f(n - 1) and returns once all of them are done
+template <class TExecutor>
+struct parallel_regions : aux::pair<parallel_regions_policy__, parallel_regions<TExecutor>> {
+  using executor = TExecutor;
+
+  template <class F>
+  void execute(F &f, const int n) {
+    executor_->bulk_execute(f, n);
+  }
+
+  TExecutor *executor_ = nullptr;
+};
+
+}  // namespace policies
+}  // namespace back
+
+#endif
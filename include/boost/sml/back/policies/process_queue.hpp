@@ -14,10 +14,80 @@ namespace policies {
 
 struct process_queue_policy__ {};
 
-template <template <class...> class T>
-struct process_queue : aux::pair<back::policies::process_queue_policy__, process_queue<T>> {
+template <template <class...> class T, class TAllocator = void>
+struct process_queue : aux::pair<back::policies::process_queue_policy__, process_queue<T, TAllocator>> {
   template <class U>
   using rebind = T<U>;
+  using allocator = TAllocator;
+};
+
+template <class T, class = void>
+struct event_priority : aux::integral_constant<int, 0> {};
+
+template <class T>
+struct event_priority<T, aux::void_t<aux::integral_constant<int, T::priority>>> : aux::integral_constant<int, T::priority> {
+  static_assert(T::priority >= 0, "Event priority has to be a non-negative number!");
+};
+
+template <template <class...> class T, class TQueueEvent>
+class priority_queue;
+
+// pop() removes the element returned by the last front()
+template <template <class...> class T, template <class...> class TQueueEvent, class... TEvents>
+class priority_queue<T, TQueueEvent<TEvents...>> {
+  using bucket_t = T<TQueueEvent<TEvents...>>;
+  static constexpr auto levels = aux::max<event_priority<TEvents>::value...>() + 1;
+
+  template <class TAllocator>
+  static const TAllocator &allocator(int, const TAllocator &allocator) {
+    return allocator;
+  }
+
+  template <class TAllocator, int... Ns>
+  priority_queue(const TAllocator &allocator, const aux::index_sequence<Ns...> &)
+      : buckets_{bucket_t(priority_queue::allocator(Ns, allocator))...} {}
+
+ public:
+  using value_type = TQueueEvent<TEvents...>;
+  using container_type = typename bucket_t::container_type;
+
+  priority_queue() = default;
+
+  template <class TAllocator>
+  explicit priority_queue(const TAllocator &allocator) : priority_queue(allocator, aux::make_index_sequence<levels>{}) {}
+
+  void push(value_type &&event) {
+    static constexpr int priorities[] = {event_priority<TEvents>::value...};
+    buckets_[priorities[event.id]].push(static_cast<value_type &&>(event));
+    ++size_;
+  }
+
+  value_type &front() {
+    top_ = levels - 1;
+    while (buckets_[top_].empty()) {
+      --top_;
+    }
+    return buckets_[top_].front();
+  }
+
+  void pop() {
+    buckets_[top_].pop();
+    --size_;
+  }
+
+  bool empty() const { return !size_; }
+
+ private:
+  bucket_t buckets_[levels];
+  int size_{};
+  int top_{};
+};
+
+template <template <class...> class T, class TAllocator = void>
+struct priority_process_queue : aux::pair<back::policies::process_queue_policy__, priority_process_queue<T, TAllocator>> {
+  template <class U>
+  using rebind = priority_queue<T, U>;
+  using allocator = TAllocator;
 };
 
 }  // namespace policies
@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_BACK_POLICIES_SEQLOCK_HPP
+#define BOOST_SML_BACK_POLICIES_SEQLOCK_HPP
+
+#include "boost/sml/aux_/utility.hpp"
+
+namespace back {
+namespace policies {
+
+struct seqlock_policy__ {
+  template <class T>
+  void publish(const T &) {}
+
+  template <class T>
+  auto create_publisher(const T &) {
+    return *this;
+  }
+
+  template <class T, int N>
+  void load(const T (&states)[N], T (&out)[N]) const {
+    for (auto i = 0; i < N; ++i) {
+      out[i] = states[i];
+    }
+  }
+
+  __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
+};
+
+template <template <class...> class TAtomic, class T, bool = (sizeof(T) <= sizeof(unsigned long long))>
+class seqlock_impl;
+
+template <class TSeqlock, class T, int N>
+struct seqlock_publisher {
+  ~seqlock_publisher() { seqlock.publish(states); }
+  TSeqlock &seqlock;
+  const T (&states)[N];
+};
+
+/// states of all regions fit into one word, so they are published with a single store and loaded with a single load
+template <template <class...> class TAtomic, class T, int N>
+class seqlock_impl<TAtomic, T[N], true> {
+  using word_t = unsigned long long;
+
+  static word_t pack(const T (&states)[N]) {
+    word_t word = 0;
+    for (auto i = 0; i < N; ++i) {
+      word |= word_t(states[i]) << (i * sizeof(T) * 8);
+    }
+    return word;
+  }
+
+ public:
+  void publish(const T (&states)[N]) {
+    const auto word = pack(states);
+    if (word != published_) {
+      published_ = word;
+      word_.store(word);
+    }
+  }
+
+  auto create_publisher(const T (&states)[N]) { return seqlock_publisher<seqlock_impl, T, N>{*this, states}; }
+
+  void load(const T (&)[N], T (&out)[N]) const {
+    const auto word = word_.load();
+    for (auto i = 0; i < N; ++i) {
+      out[i] = T(word >> (i * sizeof(T) * 8));
+    }
+  }
+
+ private:
+  TAtomic<word_t> word_{0ull};
+  word_t published_{};
+};
+
+/// the sequence is odd while states are being published, readers retry until they see the same even sequence twice
+template <template <class...> class TAtomic, class T, int N>
+class seqlock_impl<TAtomic, T[N], false> {
+ public:
+  void publish(const T (&states)[N]) {
+    auto changed = false;
+    for (auto i = 0; i < N; ++i) {
+      changed |= published_[i] != states[i];
+      published_[i] = states[i];
+    }
+    if (changed) {
+      const auto sequence = sequence_.load();
+      sequence_.store(sequence + 1u);
+      for (auto i = 0; i < N; ++i) {
+        states_[i].store(states[i]);
+      }
+      sequence_.store(sequence + 2u);
+    }
+  }
+
+  auto create_publisher(const T (&states)[N]) { return seqlock_publisher<seqlock_impl, T, N>{*this, states}; }
+
+  void load(const T (&)[N], T (&out)[N]) const {
+    for (;;) {
+      const auto sequence = sequence_.load();
+      if (sequence & 1u) {
+        continue;
+      }
+      for (auto i = 0; i < N; ++i) {
+        out[i] = states_[i].load();
+      }
+      if (sequence_.load() == sequence) {
+        return;
+      }
+    }
+  }
+
+ private:
+  TAtomic<unsigned> sequence_{0u};
+  TAtomic<T> states_[N]{};
+  T published_[N]{};
+};
+
+template <template <class...> class TAtomic>
+struct seqlock : aux::pair<seqlock_policy__, seqlock<TAtomic>> {
+  template <class T>
+  using rebind = seqlock_impl<TAtomic, T>;
+};
+
+}  // namespace policies
+}  // namespace back
+
+#endif
@@ -0,0 +1,24 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_BACK_POLICIES_SHARED_TRANSITIONS_HPP
+#define BOOST_SML_BACK_POLICIES_SHARED_TRANSITIONS_HPP
+
+#include "boost/sml/aux_/utility.hpp"
+
+namespace back {
+namespace policies {
+
+struct shared_transitions_policy__ {};
+
+/// Transitions (guards and actions with their captures) are stored once per state machine type, the table created by
+/// the first instance is used by all of them, so guards and actions mustn't capture anything specific to an instance
+struct shared_transitions : aux::pair<shared_transitions_policy__, shared_transitions> {};
+
+}  // namespace policies
+}  // namespace back
+
+#endif
@@ -13,15 +13,50 @@ namespace back {
 namespace policies {
 
 struct thread_safety_policy__ {
-  auto create_lock() { return *this; }
+  using per_region = aux::false_type;
+  using optimistic = aux::false_type;
+
+  template <class T, class TStates>
+  auto create_lock(const T &, TStates &, const bool) {
+    return *this;
+  }
+
+  template <class TStates>
+  auto create_batch_lock(TStates &) {
+    return *this;
+  }
+
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
 };
 
 template <class TLock>
 struct thread_safe : aux::pair<thread_safety_policy__, thread_safe<TLock>> {
-  using type = thread_safe;
+  using per_region = aux::false_type;
+  using optimistic = aux::false_type;
+  template <class>
+  using rebind = thread_safe;
+
+  /// `locked` - the lock is already held by the caller (a batch of `process_events`)
+  template <class T, class TStates>
+  auto create_lock(const T &, TStates &, const bool locked) {
+    struct lock_guard {
+      explicit lock_guard(TLock *lock) : lock_{lock} {
+        if (lock_) {
+          lock_->lock();
+        }
+      }
+      ~lock_guard() {
+        if (lock_) {
+          lock_->unlock();
+        }
+      }
+      TLock *lock_;
+    };
+    return lock_guard{locked ? nullptr : &lock};
+  }
 
-  auto create_lock() {
+  template <class TStates>
+  auto create_batch_lock(TStates &) {
     struct lock_guard {
       explicit lock_guard(TLock &lock) : lock_{lock} { lock_.lock(); }
       ~lock_guard() { lock_.unlock(); }
@@ -33,6 +68,159 @@ struct thread_safe : aux::pair<thread_safety_policy__, thread_safe<TLock>> {
   TLock lock;
 };
 
+template <class TLock, int N>
+struct thread_safe_regions_impl {
+  using per_region = aux::true_type;
+  using optimistic = aux::false_type;
+
+  template <int... Rs, class TStates>
+  auto create_lock(const aux::index_sequence<Rs...> &, TStates &, const bool locked) {
+    struct lock_guard {
+      explicit lock_guard(TLock (*locks)[N]) : locks_{locks} {
+        if (locks_) {
+#if defined(__cpp_fold_expressions)  // __pph__
+          ((*locks_)[Rs].lock(), ...);
+#else   // __pph__
+          (void)aux::swallow{0, ((*locks_)[Rs].lock(), 0)...};
+#endif  // __pph__
+        }
+      }
+      ~lock_guard() {
+        if (locks_) {
+#if defined(__cpp_fold_expressions)  // __pph__
+          ((*locks_)[Rs].unlock(), ...);
+#else   // __pph__
+          (void)aux::swallow{0, ((*locks_)[Rs].unlock(), 0)...};
+#endif  // __pph__
+        }
+      }
+      TLock (*locks_)[N];
+    };
+    return lock_guard{locked ? nullptr : &locks};
+  }
+
+  template <class TStates>
+  auto create_batch_lock(TStates &) {
+    struct lock_guard {
+      explicit lock_guard(TLock (&locks)[N]) : locks_{locks} {
+        for (auto &lock : locks_) {
+          lock.lock();
+        }
+      }
+      ~lock_guard() {
+        for (auto &lock : locks_) {
+          lock.unlock();
+        }
+      }
+      TLock (&locks_)[N];
+    };
+    return lock_guard{locks};
+  }
+
+  TLock locks[N];
+};
+
+/// one lock per orthogonal region, only regions which may handle the event are locked (in ascending order)
+template <class TLock>
+struct thread_safe_regions : aux::pair<thread_safety_policy__, thread_safe_regions<TLock>> {
+  template <class>
+  struct rebind_impl;
+
+  template <class T, int N>
+  struct rebind_impl<T[N]> {
+    static_assert(N <= 64, "thread_safe_regions supports up to 64 orthogonal regions");
+    using type = thread_safe_regions_impl<TLock, N>;
+  };
+
+  template <class T>
+  using rebind = typename rebind_impl<T>::type;
+};
+
+template <class TLock, template <class...> class TAtomic, class>
+class optimistic_thread_safe_impl;
+
+/// current states of all regions packed into an atomic word, the highest bit is set while the lock is held
+template <class TLock, template <class...> class TAtomic, class T, int N>
+class optimistic_thread_safe_impl<TLock, TAtomic, T[N]> {
+  using word_t = unsigned long long;
+  static_assert(sizeof(T) * N < sizeof(word_t), "optimistic_thread_safe supports up to 7 bytes of states (all regions)");
+  static constexpr word_t locked = 1ull << (sizeof(word_t) * 8 - 1);
+
+  static word_t pack(const T (&states)[N]) {
+    word_t word = 0;
+    for (auto i = 0; i < N; ++i) {
+      word |= word_t(states[i]) << (i * sizeof(T) * 8);
+    }
+    return word;
+  }
+
+  static void unpack(const word_t word, T (&states)[N]) {
+    for (auto i = 0; i < N; ++i) {
+      states[i] = T(word >> (i * sizeof(T) * 8));
+    }
+  }
+
+  struct lock_guard {
+    lock_guard(optimistic_thread_safe_impl *self, T (&states)[N]) : self_{self}, states_{states} {
+      if (self_) {
+        self_->lock_.lock();
+        unpack(self_->word_.fetch_or(locked), states_);
+      }
+    }
+    ~lock_guard() {
+      if (self_) {
+        self_->word_.store(pack(states_));
+        self_->lock_.unlock();
+      }
+    }
+    optimistic_thread_safe_impl *self_;
+    T (&states_)[N];
+  };
+
+ public:
+  using per_region = aux::false_type;
+  using optimistic = aux::true_type;
+
+  /// states are loaded from the word when the lock is taken and stored back (unlocked) when it's released
+  template <class TRegions>
+  auto create_lock(const TRegions &, T (&states)[N], const bool locked) {
+    return lock_guard{locked ? nullptr : this, states};
+  }
+
+  auto create_batch_lock(T (&states)[N]) { return lock_guard{this, states}; }
+
+  word_t load(T (&states)[N]) const {
+    const auto word = word_.load();
+    unpack(word, states);
+    return word;
+  }
+
+  void store(const T (&states)[N]) { word_.store(pack(states)); }
+
+  static bool is_locked(const word_t word) { return word & locked; }
+
+  /// commits `new_states` if the word hasn't changed since `states` were loaded, otherwise both are reloaded
+  bool commit(word_t &word, T (&states)[N], const T (&new_states)[N]) {
+    const auto new_word = pack(new_states);
+    if (new_word == word || word_.compare_exchange_weak(word, new_word)) {
+      return true;
+    }
+    unpack(word, states);
+    return false;
+  }
+
+ private:
+  TAtomic<word_t> word_{0ull};
+  TLock lock_;
+};
+
+/// action-free transitions are committed with a compare-and-swap of the states word (all regions), other ones take the lock
+template <class TLock, template <class...> class TAtomic>
+struct optimistic_thread_safe : aux::pair<thread_safety_policy__, optimistic_thread_safe<TLock, TAtomic>> {
+  template <class T>
+  using rebind = optimistic_thread_safe_impl<TLock, TAtomic, T>;
+};
+
 }  // namespace policies
 }  // namespace back
 
@@ -0,0 +1,43 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_BACK_POLICIES_TIMER_SERVICE_HPP
+#define BOOST_SML_BACK_POLICIES_TIMER_SERVICE_HPP
+
+#include "boost/sml/aux_/utility.hpp"
+
+namespace back {
+namespace policies {
+
+struct timer_service_policy__ {};
+
+/// Service of the `after(duration)` transitions, passed to the state machine as a dependency
+///   typename T::timer; // intrusive timer, not armed when default constructed/copied, cancelled when destroyed
+///   template <class TDuration> void arm(timer &, const TDuration &, void (*expired)(timer &));
+///   void cancel(timer &);
+/// `expired` has to be called by the thread processing events of the state machine, see utility::timing_wheel
+template <class T>
+struct timer_service : aux::pair<timer_service_policy__, timer_service<T>> {
+  using type = T;
+};
+
+/// one timer per orthogonal region, each of them keeps the way back to its state machine
+template <class T, int Regions>
+struct region_timers {
+  using base = typename T::timer;
+
+  struct timer : base {
+    void *deps = nullptr;
+    void *subs = nullptr;
+  };
+
+  timer timers[Regions];
+};
+
+}  // namespace policies
+}  // namespace back
+
+#endif
@@ -64,9 +64,116 @@ class queue_event {
   void (*move)(aux::byte (&)[size], queue_event &&);
 };
 
+template <class T, class = void>
+struct is_coalescing : aux::false_type {};
+
+template <class T>
+struct is_coalescing<T, aux::void_t<aux::integral_constant<bool, T::coalesce>>> : aux::integral_constant<bool, T::coalesce> {};
+
+template <class... Ts>
+using coalescing_events_t = aux::join_t<aux::conditional_t<is_coalescing<Ts>::value, aux::type_list<Ts>, aux::type_list<>>...>;
+
+template <class TQueue, class TEvents, class = aux::apply_t<coalescing_events_t, TEvents>>
+class coalescing_queue;
+
+// Counts pending instances of coalescing events, so that only the latest one is dispatched
+template <class TQueue, class... TEvents, class... TCoalescing>
+class coalescing_queue<TQueue, aux::type_list<TEvents...>, aux::type_list<TCoalescing...>> : public TQueue {
+  using ids_t = aux::type_id<TCoalescing...>;
+
+  template <class T>
+  static constexpr int slot(const aux::true_type &) {
+    return aux::get_id<int, T>((ids_t *)0);
+  }
+
+  template <class>
+  static constexpr int slot(const aux::false_type &) {
+    return -1;
+  }
+
+  static int slot(const int id) {
+    static constexpr int slots[] = {slot<TEvents>(is_coalescing<TEvents>{})...};
+    return slots[id];
+  }
+
+  void acquire(const int id) {
+    const auto index = slot(id);
+    if (index >= 0) {
+      ++pending_[index];
+    }
+  }
+
+  void release(const int id) {
+    const auto index = slot(id);
+    if (index >= 0) {
+      --pending_[index];
+    }
+  }
+
+ public:
+  using value_type = typename TQueue::value_type;
+  using TQueue::TQueue;
+
+  void push(value_type &&event) {
+    acquire(event.id);
+    TQueue::push(static_cast<value_type &&>(event));
+  }
+
+  void push_back(value_type &&event) {
+    acquire(event.id);
+    TQueue::push_back(static_cast<value_type &&>(event));
+  }
+
+  value_type &front() {
+    auto &event = TQueue::front();
+    front_ = event.id;
+    return event;
+  }
+
+  void pop() {
+    release(front_);
+    TQueue::pop();
+  }
+
+  template <class TIterator>
+  auto erase(const TIterator &it) {
+    release(it->id);
+    return TQueue::erase(it);
+  }
+
+  bool superseded(const int id) const {
+    const auto index = slot(id);
+    return index >= 0 && pending_[index] > 1;
+  }
+
+ private:
+  int pending_[sizeof...(TCoalescing)]{};
+  int front_{};
+};
+
+template <class TQueue>
+constexpr bool is_superseded(const TQueue &, const int) {
+  return false;
+}
+
+template <class TQueue, class TEvents, class TCoalescing>
+bool is_superseded(const coalescing_queue<TQueue, TEvents, TCoalescing> &queue, const int id) {
+  return queue.superseded(id);
+}
+
+template <class TQueue, class TIterator>
+constexpr bool refill(TQueue &, TIterator &) {
+  return false;
+}
+
+template <class TQueue, class TEvents, class TCoalescing, class TIterator>
+bool refill(coalescing_queue<TQueue, TEvents, TCoalescing> &queue, TIterator &it) {
+  return refill(static_cast<TQueue &>(queue), it);
+}
+
 template <class TEvent>
 class queue_event_call {
-  using call_t = void (*)(void *, const TEvent &);
+  using call_t = void (*)(void *, TEvent &&);
 
  public:
   queue_event_call() = default;
@@ -84,13 +191,19 @@ struct queue_handler : queue_event_call<TEvents>... {
 
   template <class TEvent>
   void operator()(const TEvent &event) {
-    static_cast<queue_event_call<TEvent> *>(this)->call(queue_, event);
+    static_cast<queue_event_call<TEvent> *>(this)->call(queue_, TEvent(event));
+  }
+
+  template <class TEvent,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_const_t<aux::remove_reference_t<TEvent>>, TEvent>::value)>
+  void operator()(TEvent &&event) {
+    static_cast<queue_event_call<TEvent> *>(this)->call(queue_, static_cast<TEvent &&>(event));
   }
 
  private:
   template <class TQueue, class TEvent>
-  static auto push_impl(void *queue, const TEvent &event) {
-    static_cast<TQueue *>(queue)->push(event);
+  static auto push_impl(void *queue, TEvent &&event) {
+    static_cast<TQueue *>(queue)->push(static_cast<TEvent &&>(event));
   }
 
   void *queue_{};
@@ -106,13 +219,19 @@ struct deque_handler : queue_event_call<TEvents>... {
 
   template <class TEvent>
   void operator()(const TEvent &event) {
-    static_cast<queue_event_call<TEvent> *>(this)->call(deque_, event);
+    static_cast<queue_event_call<TEvent> *>(this)->call(deque_, TEvent(event));
+  }
+
+  template <class TEvent,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_const_t<aux::remove_reference_t<TEvent>>, TEvent>::value)>
+  void operator()(TEvent &&event) {
+    static_cast<queue_event_call<TEvent> *>(this)->call(deque_, static_cast<TEvent &&>(event));
   }
 
  private:
   template <class TDeque, class TEvent>
-  static auto push_impl(void *deque, const TEvent &event) {
-    static_cast<TDeque *>(deque)->push_back(event);
+  static auto push_impl(void *deque, TEvent &&event) {
+    static_cast<TDeque *>(deque)->push_back(static_cast<TEvent &&>(event));
   }
 
   void *deque_{};
@@ -26,15 +26,68 @@
 
 namespace back {
 
+template <class T, class TPool>
+using has_ctor_parameter = aux::integral_constant<bool, aux::is_base_of<aux::pool_type<T>, TPool>::value ||
+                                                            aux::is_base_of<aux::pool_type<T &>, TPool>::value ||
+                                                            aux::is_base_of<aux::pool_type<const T &>, TPool>::value>;
+
+template <class TQueue, class TPool>
+TQueue make_queue(const aux::type<void> &, const TPool &) {
+  return TQueue{};
+}
+
+template <class TQueue, class TAllocator, class TPool>
+TQueue make_queue(const aux::type<TAllocator> &, const TPool &p) {
+  static_assert(has_ctor_parameter<TAllocator, TPool>::value,
+                "State Machine is missing the allocator constructor parameter required by the queue policy!");
+  return TQueue(aux::try_get<TAllocator>(&p));
+}
+
+template <class TPool>
+no_policy make_parallel_regions(const aux::type<no_policy> &, const TPool &) {
+  return {};
+}
+
+template <class TExecutor, class TPool>
+policies::parallel_regions<TExecutor> make_parallel_regions(const aux::type<policies::parallel_regions<TExecutor>> &,
+                                                            const TPool &p) {
+  static_assert(aux::is_base_of<aux::pool_type<TExecutor &>, TPool>::value,
+                "State Machine is missing the executor constructor parameter (passed by reference) required by the parallel "
+                "regions policy!");
+  policies::parallel_regions<TExecutor> parallel_regions{};
+  parallel_regions.executor_ = &aux::try_get<TExecutor>(&p);
+  return parallel_regions;
+}
+
+template <class TQueue, class TEvents>
+using coalescing_queue_t =
+    aux::conditional_t<aux::is_same<no_policy, TQueue>::value || !aux::size<aux::apply_t<coalescing_events_t, TEvents>>::value,
+                       TQueue, coalescing_queue<TQueue, TEvents>>;
+
+template <class TSM, class TMappings, class = typename TSM::thread_safety_t::per_region>
+struct dispatch_regions : aux::make_index_sequence<TSM::regions> {};
+
+template <class TSM, class TMappings>
+struct dispatch_regions<TSM, TMappings, aux::true_type> {
+  using masks_t = typename TSM::regions_masks_t;
+  static constexpr auto mask = TSM::has_unexpected_events::value ? ~0ull : masks_t::get(get_mapped_states_t<TMappings>{});
+  using type = typename masked_regions<mask, aux::make_index_sequence<TSM::regions>>::type;
+};
+
+template <class TSM, class TMappings>
+using dispatch_regions_t = typename dispatch_regions<TSM, TMappings>::type;
+
 template <class TSM>
 struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux::none_type, typename TSM::sm> {
   using sm_t = typename TSM::sm;
-  using thread_safety_t = typename TSM::thread_safety_policy::type;
   template <class T>
   using defer_queue_t = typename TSM::defer_queue_policy::template rebind<T>;
   using defer_flag_t = typename TSM::defer_queue_policy::flag;
+  using defer_event_t = aux::conditional_t<aux::is_same<no_policy, defer_flag_t>::value, no_policy, const void *>;
+  using defer_allocator_t = typename TSM::defer_queue_policy::allocator;
   template <class T>
   using process_queue_t = typename TSM::process_queue_policy::template rebind<T>;
+  using process_allocator_t = typename TSM::process_queue_policy::allocator;
   using logger_t = typename TSM::logger_policy::type;
   using dispatch_t = typename TSM::dispatch_policy;
   using transitions_t = decltype(aux::declval<sm_t>().operator()());
@@ -50,12 +103,44 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   using events_ids_t = aux::apply_t<aux::inherit, events_t>;
   using has_unexpected_events = typename aux::is_base_of<unexpected, aux::apply_t<aux::inherit, events_t>>::type;
   using has_entry_exits = typename aux::is_base_of<entry_exit, aux::apply_t<aux::inherit, events_t>>::type;
-  using defer_t = defer_queue_t<aux::apply_t<queue_event, events_t>>;
-  using process_t = process_queue_t<aux::apply_t<queue_event, events_t>>;
+  using defer_t = coalescing_queue_t<defer_queue_t<aux::apply_t<queue_event, events_t>>, events_t>;
+  using process_t = coalescing_queue_t<process_queue_t<aux::apply_t<queue_event, events_t>>, events_t>;
   using deps = aux::apply_t<merge_deps, transitions_t>;
   using state_t = aux::conditional_t<(aux::size<states_t>::value > 0xFF), unsigned short, aux::byte>;
   static constexpr auto regions = aux::size<initial_states_t>::value;
   static_assert(regions > 0, "At least one initial state is required");
+  using thread_safety_t = typename TSM::thread_safety_policy::template rebind<state_t[regions]>;
+  using parallel_regions_t = typename TSM::parallel_regions_policy;
+  using has_parallel_regions = aux::integral_constant<bool, !aux::is_same<no_policy, parallel_regions_t>::value>;
+  using regions_masks_t = regions_masks<states_t, initial_states_t, aux::apply_t<aux::type_list, transitions_t>>;
+  using seqlock_t = typename TSM::seqlock_policy::template rebind<state_t[regions]>;
+  using occupancy_t = typename TSM::occupancy_policy::template rebind<aux::pair<TSM, state_t[aux::size<states_t>::value]>>;
+  using has_shared_transitions =
+      aux::integral_constant<bool, !aux::is_same<no_policy, typename TSM::shared_transitions_policy>::value>;
+  using transitions_storage_t = aux::conditional_t<has_shared_transitions::value, no_policy, transitions_t>;
+  using async_executor_t = typename TSM::async_executor_policy::type;
+  using async_pending_t = aux::conditional_t<aux::is_same<no_policy, async_executor_t>::value, no_policy, unsigned>;
+  using timer_service_t = typename TSM::timer_service_policy::type;
+  using timeout_transitions_t = aux::apply_t<get_timeout_transitions, transitions_t>;
+  using has_timeouts = aux::integral_constant<bool, (aux::size<timeout_transitions_t>::value > 0)>;
+  using timers_t =
+      aux::conditional_t<has_timeouts::value, policies::region_timers<timer_service_t, regions>, no_policy>;
+  static_assert(!has_timeouts::value || !aux::is_same<no_policy, timer_service_t>::value,
+                "`after` transitions require sml::timer_service policy!");
+  static_assert(!thread_safety_t::optimistic::value || !aux::size<aux::apply_t<get_sub_sms, states_t>>::value,
+                "optimistic_thread_safe policy doesn't support sub state machines!");
+  static_assert(!thread_safety_t::per_region::value || (aux::is_same<no_policy, typename TSM::defer_queue_policy>::value &&
+                                                         aux::is_same<no_policy, typename TSM::process_queue_policy>::value &&
+                                                         aux::is_same<no_policy, typename TSM::seqlock_policy>::value),
+                "thread_safe_regions policy can't be combined with defer/process queue or seqlock policies!");
+  using has_optimistic_transitions =
+      aux::integral_constant<bool, thread_safety_t::optimistic::value && !has_entry_exits::value &&
+                                       !has_unexpected_events::value && !has_timeouts::value && !has_parallel_regions::value &&
+                                       aux::is_same<no_policy, logger_t>::value &&
+                                       aux::is_same<no_policy, typename TSM::occupancy_policy>::value &&
+                                       aux::is_same<no_policy, async_executor_t>::value>;
+  template <class TMappings>
+  using is_optimistic_t = aux::integral_constant<bool, has_optimistic_transitions::value && !has_actions((TMappings *)0)>;
 #if !BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
   using exceptions = aux::apply_t<aux::unique_t, aux::apply_t<get_exceptions, events_t>>;
   using has_exceptions = aux::integral_constant<bool, (aux::size<exceptions>::value > 0)>;
@@ -66,37 +151,311 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   sm_impl(aux::init, const TPool &p) : sm_impl{p, aux::is_empty<sm_t>{}} {}
 
   template <class TPool>
-  sm_impl(const TPool &p, aux::false_type) : sm_t{aux::try_get<sm_t>(&p)}, transitions_{(*this)()} {
+  sm_impl(const TPool &p, aux::false_type)
+      : sm_t{aux::try_get<sm_t>(&p)},
+        transitions_{make_transitions(static_cast<sm_t &>(*this), has_shared_transitions{})},
+        parallel_regions_(make_parallel_regions(aux::type<parallel_regions_t>{}, p)),
+        defer_(make_queue<defer_t>(aux::type<defer_allocator_t>{}, p)),
+        process_(make_queue<process_t>(aux::type<process_allocator_t>{}, p)) {
     initialize(typename sm_impl<TSM>::initial_states_t{});
+    publish_states();
+    occupancy_.occupy(current_state_);
   }
 
   template <class TPool>
-  sm_impl(const TPool &p, aux::true_type) : transitions_{aux::try_get<sm_t>(&p)()} {
+  sm_impl(const TPool &p, aux::true_type)
+      : transitions_{make_transitions(aux::try_get<sm_t>(&p), has_shared_transitions{})},
+        parallel_regions_(make_parallel_regions(aux::type<parallel_regions_t>{}, p)),
+        defer_(make_queue<defer_t>(aux::type<defer_allocator_t>{}, p)),
+        process_(make_queue<process_t>(aux::type<process_allocator_t>{}, p)) {
     initialize(typename sm_impl<TSM>::initial_states_t{});
+    publish_states();
+    occupancy_.occupy(current_state_);
   }
 
+  /// `locked` is set when the caller already holds the thread safety lock (`process_events`)
   template <class TEvent, class TDeps, class TSubs>
-  bool process_event(const TEvent &event, TDeps &deps, TSubs &subs) {
+  bool process_event(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked = false) {
+    if (defer_while_pending(event, async_pending_)) {
+      return true;
+    }
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 
 #if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
     const auto handled = process_event_impl<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(
-        event, deps, subs, states_t{}, aux::make_index_sequence<regions>{});
+        event, deps, subs, states_t{}, aux::make_index_sequence<regions>{}, locked);
 #else   // __pph__
-    const auto handled =
-        process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, has_exceptions{});
+    const auto handled = process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                                       has_exceptions{});
+#endif  // __pph__
+    process_pending_events<TEvent>(handled, deps, subs, locked);
+    return handled;
+  }
+
+  template <class TEvent, class TDeps, class TSubs,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_reference_t<TEvent>, TEvent>::value)>
+  bool process_event(TEvent &&event, TDeps &deps, TSubs &subs, const bool locked = false) {
+    if (defer_while_pending(event, async_pending_)) {
+      return true;
+    }
+    const auto handled = process_event_owned(event, deps, subs, locked, aux::type<defer_queue_t<TEvent>>{});
+    process_pending_events<TEvent>(handled, deps, subs, locked);
+    return handled;
+  }
+
+  template <class TState, class TEvent, class TDeps, class TSubs>
+  bool process_event_in(const TEvent &event, TDeps &deps, TSubs &subs) {
+#if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
+    return process_event_in<TState>(event, deps, subs,
+                                    aux::integral_constant<bool, regions == 1 && !thread_safety_t::optimistic::value>{});
+#else   // __pph__
+    return process_event_in<TState>(
+        event, deps, subs,
+        aux::integral_constant<bool, regions == 1 && !has_exceptions::value && !thread_safety_t::optimistic::value>{});
 #endif  // __pph__
+  }
+
+  template <class TState, class TEvent, class TDeps, class TSubs>
+  bool process_event_in(const TEvent &event, TDeps &deps, TSubs &subs, aux::false_type) {
+    return process_event(event, deps, subs);
+  }
+
+  // The state is already resolved by the caller, so the transitions are executed without the dispatch by the state id.
+  // The state is checked again under the lock, the event is dispatched as usual when another thread has changed it.
+  template <class TState, class TEvent, class TDeps, class TSubs>
+  bool process_event_in(const TEvent &event, TDeps &deps, TSubs &subs, aux::true_type) {
+    using mappings_t = get_event_mapping_t<get_generic_t<TEvent>, mappings>;
+    auto in_state = false;
+    auto handled = false;
+    {
+      const auto lock = thread_safety_.create_lock(aux::index_sequence<0>{}, current_state_, false);
+      (void)lock;
+      if (current_state_[0] == aux::get_id<state_t, TState>((states_ids_t *)0) && !is_async_pending()) {
+        in_state = true;
+        policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
+        const auto publisher = seqlock_.create_publisher(current_state_);
+        (void)publisher;
+        handled = get_state_mapping_t<TState, mappings_t, has_unexpected_events>::template execute<TEvent, sm_impl, TDeps, TSubs>(
+            event, *this, deps, subs, current_state_[0]);
+      }
+    }
+    if (!in_state) {
+      return process_event(event, deps, subs);
+    }
+    process_pending_events<TEvent>(handled, deps, subs);
+    return handled;
+  }
+
+  template <class TEvent, class TDeps, class TSubs>
+  void process_pending_events(const bool handled, TDeps &deps, TSubs &subs, const bool locked = false) {
     // Repeat internal transition until there is no more to process.
     do {
-      while (process_internal_events(anonymous{}, deps, subs)) {
+      while (!is_async_pending() && process_internal_events(anonymous{}, deps, subs, locked)) {
       }
-      process_defer_events(deps, subs, handled, aux::type<defer_queue_t<TEvent>>{}, events_t{});
-    } while (process_queued_events(deps, subs, aux::type<process_queue_t<TEvent>>{}, events_t{}) ||
-             process_internal_events(anonymous{}, deps, subs));
+      process_defer_events(deps, subs, handled, locked, aux::type<defer_queue_t<TEvent>>{}, events_t{});
+    } while (!is_async_pending() &&
+             (process_queued_events(deps, subs, locked, aux::type<process_queue_t<TEvent>>{}, events_t{}) ||
+              process_internal_events(anonymous{}, deps, subs, locked)));
+  }
+
+  bool is_async_pending() const { return is_async_pending(async_pending_); }
+  static bool is_async_pending(const no_policy &) { return false; }
+  static bool is_async_pending(const unsigned pending) { return pending; }
+
+  // Events arriving while an asynchronous action is pending are deferred until it completes.
+  template <class TEvent>
+  static bool defer_while_pending(const TEvent &, const no_policy &) {
+    return false;
+  }
+
+  template <class TEvent>
+  bool defer_while_pending(const TEvent &event, const unsigned pending) {
+    return pending && defer_async(event, aux::is_base_of<TEvent, events_ids_t>{});
+  }
+
+  template <class TEvent>
+  bool defer_async(const TEvent &event, aux::true_type) {
+    defer_.push_back(event);
+    return true;
+  }
+
+  template <class TEvent>
+  static bool defer_async(const TEvent &, aux::false_type) {
+    return false;
+  }
+
+  // Completions of asynchronous actions started before `reset` belong to a previous epoch and are ignored.
+  template <class TDeps, class TSubs>
+  void complete_async(TDeps &deps, TSubs &subs, const unsigned epoch) {
+    if (epoch == async_epoch_ && async_pending_ && !--async_pending_) {
+      process_pending_events<anonymous>(true, deps, subs);
+    }
+  }
+
+  static void next_async_epoch(no_policy &) {}
+  static void next_async_epoch(unsigned &epoch) { ++epoch; }
+
+  template <class TDeps, class TSubs>
+  void arm_timeouts(TDeps &deps, TSubs &subs) {
+    for (const auto &current_state : current_state_) {
+      arm_timeout(deps, subs, current_state);
+    }
+  }
+
+  template <class TDeps, class TSubs>
+  void arm_timeout(TDeps &deps, TSubs &subs, const state_t &current_state) {
+    arm_timeout(deps, subs, current_state, timers_);
+  }
+
+  template <class TDeps, class TSubs>
+  static void arm_timeout(TDeps &, TSubs &, const state_t &, no_policy &) {}
+
+  // The timer of the region is re-armed on every state change with the first `after` transition of the new state.
+  template <class TDeps, class TSubs, class TTimers>
+  void arm_timeout(TDeps &deps, TSubs &subs, const state_t &current_state, TTimers &timers) {
+    auto &service = static_cast<aux::pool_type<timer_service_t &> &>(deps).value;
+    auto &timer = timers.timers[&current_state - current_state_];
+    service.cancel(timer);
+    timer.deps = &deps;
+    timer.subs = &subs;
+    arm_timeout(service, timer, current_state, &sm_impl::expired<TDeps, TSubs, TTimers>, timeout_transitions_t{});
+  }
+
+  template <class TService, class TTimer, class TExpired, class... Ts>
+  void arm_timeout(TService &service, TTimer &timer, const state_t current_state, TExpired expired,
+                   const aux::type_list<Ts...> &) {
+    auto armed = false;
+    (void)aux::swallow{0, (armed = armed || (current_state == aux::get_id<state_t, typename Ts::src_state>((states_ids_t *)0) &&
+                                             (service.arm(timer, aux::get<Ts>(transitions()).g.duration, expired), true)),
+                           0)...};
+  }
+
+  template <class TDeps, class TSubs, class TTimers>
+  static void expired(typename TTimers::base &base) {
+    auto &timer = static_cast<typename TTimers::timer &>(base);
+    auto &subs = *static_cast<TSubs *>(timer.subs);
+    auto &sm = aux::get<sm_impl>(subs);
+    sm.process_timeout(static_cast<int>(&timer - sm.timers_.timers), *static_cast<TDeps *>(timer.deps), subs);
+  }
+
+  // Timeouts are handled by the region which armed them only.
+  template <class TDeps, class TSubs>
+  void process_timeout(const int region, TDeps &deps, TSubs &subs) {
+    const timeout event{};
+    if (defer_while_pending(event, async_pending_)) {
+      return;
+    }
+    policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
+    bool handled;
+    {
+      const auto lock = thread_safety_.create_lock(aux::make_index_sequence<regions>{}, current_state_, false);
+      (void)lock;
+      const auto publisher = seqlock_.create_publisher(current_state_);
+      (void)publisher;
+#if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
+      handled = process_event_impl<get_event_mapping_t<timeout, mappings>>(event, deps, subs, states_t{},
+                                                                           current_state_[region]);
+#else   // __pph__
+      handled = process_event_noexcept<get_event_mapping_t<timeout, mappings>>(event, deps, subs, current_state_[region],
+                                                                               has_exceptions{});
+#endif  // __pph__
+    }
+    process_pending_events<timeout>(handled, deps, subs);
+  }
+
+  template <class TEvent, class TDeps, class TSubs>
+  bool process_event_owned(TEvent &event, TDeps &deps, TSubs &subs, const bool locked, const aux::type<no_policy> &) {
+    policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
+#if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
+    return process_event_impl<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, states_t{},
+                                                                                    aux::make_index_sequence<regions>{}, locked);
+#else   // __pph__
+    return process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                        has_exceptions{});
+#endif  // __pph__
+  }
 
+  // The event is owned by the caller, so it can be moved into the defer queue once every region has seen it.
+  template <class TEvent, class TDeps, class TSubs, class TDeferQueue>
+  bool process_event_owned(TEvent &event, TDeps &deps, TSubs &subs, const bool locked, const aux::type<TDeferQueue> &) {
+    const auto defer_event = defer_event_;
+    const auto defer_pending = defer_pending_;
+    defer_event_ = &event;
+    defer_pending_ = false;
+    const auto handled = process_event_owned(event, deps, subs, locked, aux::type<no_policy>{});
+    if (defer_pending_) {
+      defer_.push_back(static_cast<TEvent &&>(event));
+    }
+    defer_event_ = defer_event;
+    defer_pending_ = defer_pending;
     return handled;
   }
 
+  template <class T>
+  static transitions_t make_transitions(T &&sm, aux::false_type) {
+    return sm();
+  }
+
+  template <class T>
+  static no_policy make_transitions(T &&sm, aux::true_type) {
+    auto transitions = sm();
+    shared_transitions(&transitions);
+    return {};
+  }
+
+  /// the table of the first instance is kept, tables of the next ones are dropped
+  static transitions_t &shared_transitions(transitions_t *transitions = nullptr) {
+    static transitions_t shared{static_cast<transitions_t &&>(*transitions)};
+    return shared;
+  }
+
+  transitions_t &transitions() { return transitions(has_shared_transitions{}); }
+  transitions_t &transitions(aux::false_type) { return transitions_; }
+  static transitions_t &transitions(aux::true_type) { return shared_transitions(); }
+
+  void publish_states() {
+    seqlock_.publish(current_state_);
+    store_states(typename thread_safety_t::optimistic{});
+  }
+
+  void store_states(aux::false_type) {}
+  void store_states(aux::true_type) { thread_safety_.store(current_state_); }
+
+  void load_states(state_t (&states)[regions]) const { load_states(states, typename thread_safety_t::optimistic{}); }
+  void load_states(state_t (&states)[regions], aux::false_type) const { seqlock_.load(current_state_, states); }
+  void load_states(state_t (&states)[regions], aux::true_type) const { thread_safety_.load(states); }
+
+  void load_instance(const aux::byte *states) {
+    auto current_state = reinterpret_cast<aux::byte *>(current_state_);
+    for (auto i = 0u; i < sizeof(current_state_); ++i) {
+      current_state[i] = states[i];
+    }
+    publish_states();
+  }
+
+  void store_instance(aux::byte *states) const {
+    state_t current_state[regions];
+    load_states(current_state);
+    const auto bytes = reinterpret_cast<const aux::byte *>(current_state);
+    for (auto i = 0u; i < sizeof(current_state); ++i) {
+      states[i] = bytes[i];
+    }
+  }
+
+  static void occupy_instance(const aux::byte *states, const long n) {
+    state_t current_state[regions];
+    const auto bytes = reinterpret_cast<aux::byte *>(current_state);
+    for (auto i = 0u; i < sizeof(current_state); ++i) {
+      bytes[i] = states[i];
+    }
+    occupancy_t::add(current_state, regions, n);
+  }
+
+  template <class TQueue>
+  void swap_deferred(TQueue &queue) {
+    swap(defer_, queue);
+  }
+
   void initialize(const aux::type_list<> &) {}
 
   template <class TState>
@@ -114,15 +473,43 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
 #endif  // __pph__
   }
 
+  void reset() {
+    {
+      const auto counter = occupancy_.create_counter(current_state_);
+      (void)counter;
+      initialize(initial_states_t{});
+    }
+    publish_states();
+    clear_defer_queue(defer_);
+    clear_process_queue(process_);
+    async_pending_ = async_pending_t{};
+    next_async_epoch(async_epoch_);
+  }
+
+  static void clear_defer_queue(no_policy &) {}
+
+  template <class TQueue>
+  static void clear_defer_queue(TQueue &queue) {
+    while (queue.begin() != queue.end()) {
+      queue.erase(queue.begin());
+    }
+  }
+
+  static void clear_process_queue(no_policy &) {}
+
+  template <class TQueue>
+  static void clear_process_queue(TQueue &queue) {
+    while (!queue.empty()) {
+      (void)queue.front();
+      queue.pop();
+    }
+  }
+
   template <class TDeps, class TSubs>
   void start(TDeps &deps, TSubs &subs) {
+    arm_timeouts(deps, subs);
     process_internal_events(on_entry<_, initial>{}, deps, subs);
-    do {
-      while (process_internal_events(anonymous{}, deps, subs)) {
-      }
-      process_defer_events(deps, subs, true, aux::type<defer_queue_t<initial>>{}, events_t{});
-    } while (process_queued_events(deps, subs, aux::type<process_queue_t<initial>>{}, events_t{}) ||
-             process_internal_events(anonymous{}, deps, subs));
+    process_pending_events<initial>(true, deps, subs);
   }
 
   template <class TEvent, class TDeps, class TSubs, class... Ts,
@@ -135,25 +522,27 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   template <class TEvent, class TDeps, class TSubs,
             __BOOST_SML_REQUIRES(aux::is_base_of<get_generic_t<TEvent>, events_ids_t>::value &&
                                  !aux::is_base_of<get_mapped_t<TEvent>, events_ids_t>::value)>
-  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs) {
+  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked = false) {
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
     return process_event_impl<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, states_t{},
-                                                                                    aux::make_index_sequence<regions>{});
+                                                                                    aux::make_index_sequence<regions>{}, locked);
 #else   // __pph__
-    return process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, has_exceptions{});
+    return process_event_noexcept<get_event_mapping_t<get_generic_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                        has_exceptions{});
 #endif  // __pph__
   }
 
   template <class TEvent, class TDeps, class TSubs,
             __BOOST_SML_REQUIRES(aux::is_base_of<get_mapped_t<TEvent>, events_ids_t>::value)>
-  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs) {
+  bool process_internal_events(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked = false) {
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
     return process_event_impl<get_event_mapping_t<get_mapped_t<TEvent>, mappings>>(event, deps, subs, states_t{},
-                                                                                   aux::make_index_sequence<regions>{});
+                                                                                   aux::make_index_sequence<regions>{}, locked);
 #else   // __pph__
-    return process_event_noexcept<get_event_mapping_t<get_mapped_t<TEvent>, mappings>>(event, deps, subs, has_exceptions{});
+    return process_event_noexcept<get_event_mapping_t<get_mapped_t<TEvent>, mappings>>(event, deps, subs, locked,
+                                                                                       has_exceptions{});
 #endif  // __pph__
   }
 
@@ -203,22 +592,72 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
            || process_internal_generic_event(event, deps, subs, current_state);
   }
 
-  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
   bool process_event_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
-                          aux::index_sequence<0>) {
-    const auto lock = thread_safety_.create_lock();
+                          aux::index_sequence<Ns...>, const bool locked) {
+    return process_event_optimistic<TMappings>(event, deps, subs, states, aux::index_sequence<Ns...>{}, locked,
+                                               is_optimistic_t<TMappings>{});
+  }
+
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool process_event_optimistic(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                                aux::index_sequence<Ns...>, const bool locked, aux::false_type) {
+    return process_event_regions<TMappings>(event, deps, subs, states, locked, dispatch_regions_t<sm_impl, TMappings>{});
+  }
+
+  // Action-free transitions are executed on a copy of the states which is committed with a compare-and-swap, they are
+  // executed again (guards included) when another thread has committed first. The lock is taken while it's held.
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool process_event_optimistic(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                                aux::index_sequence<Ns...>, const bool locked, aux::true_type) {
+    if (locked) {
+      return process_event_regions<TMappings>(event, deps, subs, states, locked, dispatch_regions_t<sm_impl, TMappings>{});
+    }
+    state_t current_state[regions];
+    auto word = thread_safety_.load(current_state);
+    while (!thread_safety_t::is_locked(word)) {
+      state_t new_state[regions] = {current_state[Ns]...};
+      auto handled = false;
+      (void)aux::swallow{
+          0, (handled |= dispatch_t::template dispatch<0, TMappings>(*this, new_state[Ns], event, deps, subs, states), 0)...};
+      if (!handled || thread_safety_.commit(word, current_state, new_state)) {
+        return handled;
+      }
+    }
+    return process_event_regions<TMappings>(event, deps, subs, states, locked, dispatch_regions_t<sm_impl, TMappings>{});
+  }
+
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
+  bool process_event_regions(const TEvent &, TDeps &, TSubs &, const aux::type_list<TStates...> &, const bool,
+                             aux::index_sequence<>) {
+    return false;
+  }
+
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
+  bool process_event_regions(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             const bool locked, aux::index_sequence<0>) {
+    const auto lock = thread_safety_.create_lock(aux::index_sequence<0>{}, current_state_, locked);
     (void)lock;
+    const auto publisher = seqlock_.create_publisher(current_state_);
+    (void)publisher;
     return dispatch_t::template dispatch<0, TMappings>(*this, current_state_[0], event, deps, subs, states);
   }
 
   template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
-  bool process_event_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
-                          aux::index_sequence<Ns...>) {
-    const auto lock = thread_safety_.create_lock();
+  bool process_event_regions(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             const bool locked, aux::index_sequence<Ns...>) {
+    const auto lock = thread_safety_.create_lock(aux::index_sequence<Ns...>{}, current_state_, locked);
     (void)lock;
+    const auto publisher = seqlock_.create_publisher(current_state_);
+    (void)publisher;
+    return dispatch_regions_impl<TMappings>(event, deps, subs, states, aux::index_sequence<Ns...>{}, has_parallel_regions{});
+  }
 
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool dispatch_regions_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             aux::index_sequence<Ns...>, aux::false_type) {
 #if defined(__cpp_fold_expressions)  // __pph__
-    return ((dispatch_t::template dispatch<0, TMappings>(*this, current_state_[Ns], event, deps, subs, states)), ...);
+    return (dispatch_t::template dispatch<0, TMappings>(*this, current_state_[Ns], event, deps, subs, states) | ...);
 #else   // __pph__
     auto handled = false;
     (void)aux::swallow{
@@ -228,18 +667,38 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
 #endif  // __pph__
   }
 
+  template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates, int... Ns>
+  bool dispatch_regions_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
+                             aux::index_sequence<Ns...>, aux::true_type) {
+    static_assert(policies::disjoint_deps<regions_masks_t>(typename sm_impl::deps{}),
+                  "Regions dispatched in parallel can't share dependencies unless they are marked with "
+                  "`static constexpr auto thread_safe = true`!");
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value &&
+                      aux::is_same<no_policy, typename TSM::process_queue_policy>::value,
+                  "Parallel regions policy can't be combined with defer/process queue policies!");
+    static constexpr int ids[] = {Ns...};
+    bool handled[sizeof...(Ns)]{};
+    auto dispatch = [&](const int i) {
+      handled[i] = dispatch_t::template dispatch<0, TMappings>(*this, current_state_[ids[i]], event, deps, subs, states);
+    };
+    parallel_regions_.execute(dispatch, sizeof...(Ns));
+    auto result = false;
+    for (const auto h : handled) {
+      result |= h;
+    }
+    return result;
+  }
+
   template <class TMappings, class TEvent, class TDeps, class TSubs, class... TStates>
   bool process_event_impl(const TEvent &event, TDeps &deps, TSubs &subs, const aux::type_list<TStates...> &states,
                           state_t &current_state) {
-    const auto lock = thread_safety_.create_lock();
-    (void)lock;
     return dispatch_t::template dispatch<0, TMappings>(*this, current_state, event, deps, subs, states);
   }
 
 #if !BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
   template <class TMappings, class TEvent, class TDeps, class TSubs>
-  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, aux::false_type) noexcept {
-    return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{});
+  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked, aux::false_type) noexcept {
+    return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{}, locked);
   }
 
   template <class TMappings, class TEvent, class TDeps, class TSubs>
@@ -252,53 +711,57 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
     try {
       return process_event_impl<TMappings>(event, deps, subs, states_t{}, current_state);
     } catch (...) {
-      return process_exception(deps, subs, exceptions{});
+      return process_exception(deps, subs, false, exceptions{});
     }
   }
 
   template <class TMappings, class TEvent, class TDeps, class TSubs>
-  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, aux::true_type) {
+  bool process_event_noexcept(const TEvent &event, TDeps &deps, TSubs &subs, const bool locked, aux::true_type) {
     try {
-      return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{});
+      return process_event_impl<TMappings>(event, deps, subs, states_t{}, aux::make_index_sequence<regions>{}, locked);
     } catch (...) {
-      return process_exception(deps, subs, exceptions{});
+      return process_exception(deps, subs, locked, exceptions{});
     }
   }
 
   template <class TDeps, class TSubs>
-  bool process_exception(TDeps &deps, TSubs &subs, const aux::type_list<> &) {
-    return process_internal_events(exception<_>{}, deps, subs);
+  bool process_exception(TDeps &deps, TSubs &subs, const bool locked, const aux::type_list<> &) {
+    return process_internal_events(exception<_>{}, deps, subs, locked);
   }
 
   template <class TDeps, class TSubs, class E, class... Es>
-  bool process_exception(TDeps &deps, TSubs &subs, const aux::type_list<E, Es...> &) {
+  bool process_exception(TDeps &deps, TSubs &subs, const bool locked, const aux::type_list<E, Es...> &) {
     try {
       throw;
     } catch (const typename E::type &e) {
-      return process_internal_events(E{e}, deps, subs);
+      return process_internal_events(E{e}, deps, subs, locked);
     } catch (...) {
-      return process_exception(deps, subs, aux::type_list<Es...>{});
+      return process_exception(deps, subs, locked, aux::type_list<Es...>{});
     }
   }
 #endif  // __pph__
 
   template <class TDeps, class TSubs, class... TEvents>
-  bool process_defer_events(TDeps &, TSubs &, const bool, const aux::type<no_policy> &, const aux::type_list<TEvents...> &) {
+  bool process_defer_events(TDeps &, TSubs &, const bool, const bool, const aux::type<no_policy> &,
+                            const aux::type_list<TEvents...> &) {
     return false;
   }
 
   template <class TDeps, class TSubs, class TEvent>
-  bool process_event_no_defer(TDeps &deps, TSubs &subs, const void *data) {
+  bool process_event_no_defer(TDeps &deps, TSubs &subs, const bool locked, const void *data) {
     const auto &event = *static_cast<const TEvent *>(data);
     policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
 #if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
     const auto handled = process_event_impl<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, states_t{},
-                                                                                   aux::make_index_sequence<regions>{});
+                                                                                   aux::make_index_sequence<regions>{}, locked);
 #else   // __pph__
-    const auto handled = process_event_noexcept<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, has_exceptions{});
+    const auto handled =
+        process_event_noexcept<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, locked, has_exceptions{});
 #endif  // __pph__
     if (handled && defer_again_) {
-      ++defer_it_;
+      if (++defer_it_ == defer_end_ && refill(defer_, defer_it_)) {
+        defer_end_ = defer_.end();
+      }
     } else {
       defer_.erase(defer_it_);
       defer_it_ = defer_.begin();
@@ -308,11 +771,11 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   }
 
   template <class TDeps, class TSubs, class TDeferQueue, class... TEvents>
-  bool process_defer_events(TDeps &deps, TSubs &subs, const bool handled, const aux::type<TDeferQueue> &,
+  bool process_defer_events(TDeps &deps, TSubs &subs, const bool handled, const bool locked, const aux::type<TDeferQueue> &,
                             const aux::type_list<TEvents...> &) {
     bool processed_events = false;
     if (handled) {
-      using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const void *);
+      using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const bool, const void *);
       const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TEvents))] = {
           &sm_impl::process_event_no_defer<TDeps, TSubs, TEvents>...};
       defer_processing_ = true;
@@ -320,8 +783,13 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
       defer_it_ = defer_.begin();
       defer_end_ = defer_.end();
       processed_events = defer_it_ != defer_end_;
-      while (defer_it_ != defer_end_) {
-        (this->*dispatch_table[defer_it_->id])(deps, subs, defer_it_->data);
+      while (defer_it_ != defer_end_ && !is_async_pending()) {
+        if (is_superseded(defer_, defer_it_->id)) {
+          defer_it_ = defer_.erase(defer_it_);
+          defer_end_ = defer_.end();
+          continue;
+        }
+        (this->*dispatch_table[defer_it_->id])(deps, subs, locked, defer_it_->data);
         defer_again_ = false;
       }
       defer_processing_ = false;
@@ -330,52 +798,51 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
   }
 
   template <class TDeps, class TSubs, class... TEvents>
-  bool process_queued_events(TDeps &, TSubs &, const aux::type<no_policy> &, const aux::type_list<TEvents...> &) {
+  bool process_queued_events(TDeps &, TSubs &, const bool, const aux::type<no_policy> &, const aux::type_list<TEvents...> &) {
     return false;
   }
 
   template <class TDeps, class TSubs, class TEvent>
-  bool process_event_no_queue(TDeps &deps, TSubs &subs, const void *data) {
-    const auto &event = *static_cast<const TEvent *>(data);
-    policies::log_process_event<sm_t>(aux::type<logger_t>{}, deps, event);
-#if BOOST_SML_DISABLE_EXCEPTIONS  // __pph__
-    return process_event_impl<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, states_t{},
-                                                                     aux::make_index_sequence<regions>{});
-#else  // __pph__
-    return process_event_noexcept<get_event_mapping_t<TEvent, mappings>>(event, deps, subs, has_exceptions{});
-#endif  // __pph__
+  bool process_event_no_queue(TDeps &deps, TSubs &subs, const bool locked, void *data) {
+    return process_event_owned(*static_cast<TEvent *>(data), deps, subs, locked, aux::type<defer_queue_t<TEvent>>{});
   }
 
   template <class TDeps, class TSubs, class TDeferQueue, class... TEvents>
-  bool process_queued_events(TDeps &deps, TSubs &subs, const aux::type<TDeferQueue> &, const aux::type_list<TEvents...> &) {
-    using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const void *);
+  bool process_queued_events(TDeps &deps, TSubs &subs, const bool locked, const aux::type<TDeferQueue> &,
+                             const aux::type_list<TEvents...> &) {
+    using dispatch_table_t = bool (sm_impl::*)(TDeps &, TSubs &, const bool, void *);
     const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TEvents))] = {
         &sm_impl::process_event_no_queue<TDeps, TSubs, TEvents>...};
     bool wasnt_empty = !process_.empty();
-    while (!process_.empty()) {
-      (this->*dispatch_table[process_.front().id])(deps, subs, process_.front().data);
+    while (!process_.empty() && !is_async_pending()) {
+      auto &event = process_.front();
+      if (!is_superseded(process_, event.id)) {
+        (this->*dispatch_table[event.id])(deps, subs, locked, event.data);
+      }
       process_.pop();
     }
     return wasnt_empty;
   }
 
   template <class TVisitor, class... TStates>
-  void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<0>) const {
+  static void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<0>,
+                                   const state_t (&current_state)[regions]) {
     using dispatch_table_t = void (*)(const TVisitor &);
     const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TStates))] = {
         &sm_impl::visit_state<TVisitor, TStates>...};
-    dispatch_table[current_state_[0]](visitor);
+    dispatch_table[current_state[0]](visitor);
   }
 
   template <class TVisitor, class... TStates, int... Ns>
-  void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<Ns...>) const {
+  static void visit_current_states(const TVisitor &visitor, const aux::type_list<TStates...> &, aux::index_sequence<Ns...>,
+                                   const state_t (&current_state)[regions]) {
     using dispatch_table_t = void (*)(const TVisitor &);
     const static dispatch_table_t dispatch_table[__BOOST_SML_ZERO_SIZE_ARRAY_CREATE(sizeof...(TStates))] = {
         &sm_impl::visit_state<TVisitor, TStates>...};
 #if defined(__cpp_fold_expressions)  // __pph__
-    (dispatch_table[current_state_[Ns]](visitor), ...);
+    (dispatch_table[current_state[Ns]](visitor), ...);
 #else   // __pph__
-    (void)aux::swallow{0, (dispatch_table[current_state_[Ns]](visitor), 0)...};
+    (void)aux::swallow{0, (dispatch_table[current_state[Ns]](visitor), 0)...};
 #endif  // __pph__
   }
 
@@ -400,23 +867,88 @@ struct sm_impl : aux::conditional_t<aux::is_empty<typename TSM::sm>::value, aux:
 #endif  // __pph__
   }
 
-  transitions_t transitions_;
+  transitions_storage_t transitions_;
   state_t current_state_[regions];
   thread_safety_t thread_safety_;
+  seqlock_t seqlock_;
+  occupancy_t occupancy_;
+  async_pending_t async_pending_{};
+  async_pending_t async_epoch_{};
+  timers_t timers_{};
+  parallel_regions_t parallel_regions_;
   defer_t defer_;
   process_t process_;
   defer_flag_t defer_processing_ = defer_flag_t{};
   defer_flag_t defer_again_ = defer_flag_t{};
+  defer_flag_t defer_pending_ = defer_flag_t{};
+  defer_event_t defer_event_ = defer_event_t{};
   typename defer_t::const_iterator defer_it_;
   typename defer_t::const_iterator defer_end_;
 };
 
+template <class T>
+class states_snapshot {
+  using state_t = typename T::state_t;
+  using states_ids_t = typename T::states_ids_t;
+
+ public:
+  explicit states_snapshot(const T &sm) { sm.load_states(current_state_); }
+
+  template <class TVisitor, __BOOST_SML_REQUIRES(concepts::callable<void, TVisitor>::value)>
+  void visit_current_states(const TVisitor &visitor) const {
+    T::visit_current_states(visitor, typename T::states_t{}, aux::make_index_sequence<T::regions>{}, current_state_);
+  }
+
+  template <class TState>
+  bool is(const TState &) const {
+    return aux::get_id<state_t, typename TState::type>((states_ids_t *)0) == current_state_[0];
+  }
+
+  template <class... TStates, __BOOST_SML_REQUIRES((sizeof...(TStates) > 1) && sizeof...(TStates) == T::regions)>
+  bool is(const TStates &...) const {
+    const state_t state_ids[] = {aux::get_id<state_t, typename TStates::type>((states_ids_t *)0)...};
+    for (auto i = 0u; i < sizeof...(TStates); ++i) {
+      if (state_ids[i] != current_state_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  state_t current_state_[T::regions];
+};
+
+template <class TSM>
+struct events_visitor {
+  template <class TEvent>
+  bool operator()(const TEvent &event) const {
+    return sm.process_events_impl(event, aux::false_type{});
+  }
+  TSM &sm;
+};
+
+// Variants of events are dispatched with `visit` found by ADL (std::visit for std::variant).
+template <class TSM, class T, class = void>
+struct is_events_variant : aux::false_type {};
+
+template <class TSM, class T>
+struct is_events_variant<
+    TSM, T, aux::void_t<decltype(visit(aux::declval<events_visitor<TSM>>(), aux::declval<const T &>()))>>
+    : aux::true_type {};
+
 template <class TSM>
 class sm {
   using sm_t = typename TSM::sm;
   using logger_t = typename TSM::logger_policy::type;
   using logger_dep_t =
       aux::conditional_t<aux::is_same<no_policy, logger_t>::value, aux::type_list<>, aux::type_list<logger_t &>>;
+  using async_executor_t = typename TSM::async_executor_policy::type;
+  using async_executor_dep_t = aux::conditional_t<aux::is_same<no_policy, async_executor_t>::value, aux::type_list<>,
+                                                  aux::type_list<async_executor_t &>>;
+  using timer_service_t = typename TSM::timer_service_policy::type;
+  using timer_service_dep_t = aux::conditional_t<aux::is_same<no_policy, timer_service_t>::value, aux::type_list<>,
+                                                 aux::type_list<timer_service_t &>>;
   using transitions_t = decltype(aux::declval<sm_t>().operator()());
 
   static_assert(concepts::composable<sm_t>::value, "Composable constraint is not satisfied!");
@@ -429,16 +961,77 @@ class sm {
 
  private:
   using sm_all_t = aux::apply_t<get_non_empty_t, aux::join_t<aux::type_list<sm_t>, aux::apply_t<get_sm_t, state_machines>>>;
-  using sub_sms_t =
-      aux::apply_t<aux::pool,
-                   typename convert_to_sm<TSM, aux::apply_t<aux::unique_t, aux::apply_t<get_sub_sms, states>>>::type>;
+  using sub_sms_list_t = typename convert_to_sm<TSM, aux::apply_t<aux::unique_t, aux::apply_t<get_sub_sms, states>>>::type;
+  using sub_sms_t = aux::apply_t<aux::pool, sub_sms_list_t>;
   using deps = aux::apply_t<merge_deps, transitions_t>;
-  using deps_t =
-      aux::apply_t<aux::pool,
-                   aux::apply_t<aux::unique_t, aux::join_t<deps, sm_all_t, logger_dep_t, aux::apply_t<merge_deps, sub_sms_t>>>>;
+  using policy_deps_t = aux::join_t<logger_dep_t, async_executor_dep_t, timer_service_dep_t>;
+  using deps_t = aux::apply_t<
+      aux::pool, aux::apply_t<aux::unique_t, aux::join_t<deps, sm_all_t, policy_deps_t, aux::apply_t<merge_deps, sub_sms_t>>>>;
   struct events_ids : aux::apply_t<aux::inherit, events> {};
 
+  template <class T, class... TSubSms>
+  static constexpr bool sub_sms_timeouts(const aux::type_list<T, TSubSms...> &) {
+    constexpr bool timeouts[] = {false, TSubSms::has_timeouts::value...};
+    auto result = false;
+    for (const auto t : timeouts) {
+      result |= t;
+    }
+    return result;
+  }
+
+  static_assert(!sub_sms_timeouts(sub_sms_list_t{}), "`after` transitions aren't supported by sub state machines!");
+
+  template <class... TSubSms>
+  static constexpr int instance_size_impl(const aux::type_list<TSubSms...> &) {
+    constexpr int sizes[] = {0, int(sizeof(TSubSms::current_state_))...};
+    auto size = 0;
+    for (const auto s : sizes) {
+      size += s;
+    }
+    return size;
+  }
+
+  template <class TEvent, class TState, __BOOST_SML_REQUIRES(aux::is_base_of<TEvent, events_ids>::value)>
+  static bool process_event_in(sm &self, const TEvent &event) {
+    return aux::get<sm_impl<TSM>>(self.sub_sms_).template process_event_in<TState>(event, self.deps_, self.sub_sms_);
+  }
+
+  template <class TEvent, class TState, __BOOST_SML_REQUIRES(!aux::is_base_of<TEvent, events_ids>::value)>
+  static bool process_event_in(sm &self, const TEvent &event) {
+    return self.process_event(event);
+  }
+
+  template <class TEvent, class... TStates>
+  static const auto *state_handlers_impl(const aux::type_list<TStates...> &) {
+    using state_handler_t = bool (*)(sm &, const TEvent &);
+    static const state_handler_t handlers[] = {&sm::process_event_in<TEvent, TStates>...};
+    return handlers;
+  }
+
+  template <class... TSubSms>
+  void load_instance_impl(const aux::byte *states, const aux::type_list<TSubSms...> &) {
+    (void)aux::swallow{0, (aux::get<TSubSms>(sub_sms_).load_instance(states), states += sizeof(TSubSms::current_state_), 0)...};
+  }
+
+  template <class... TSubSms>
+  void reset_impl(const aux::type_list<TSubSms...> &) {
+    (void)aux::swallow{0, (aux::get<TSubSms>(sub_sms_).reset(), 0)...};
+  }
+
+  template <class... TSubSms>
+  static void occupy_instance_impl(const aux::byte *states, const long n, const aux::type_list<TSubSms...> &) {
+    (void)aux::swallow{0, (TSubSms::occupy_instance(states, n), states += sizeof(TSubSms::current_state_), 0)...};
+  }
+
+  template <class... TSubSms>
+  void store_instance_impl(aux::byte *states, const aux::type_list<TSubSms...> &) const {
+    (void)aux::swallow{0, (aux::cget<TSubSms>(sub_sms_).store_instance(states), states += sizeof(TSubSms::current_state_), 0)...};
+  }
+
  public:
+  using deferred_t = typename sm_impl<TSM>::defer_t;
+  using has_timeouts = typename sm_impl<TSM>::has_timeouts;
+
   sm() : deps_{aux::init{}, aux::pool<>{}}, sub_sms_{aux::pool<>{}} { aux::get<sm_impl<TSM>>(sub_sms_).start(deps_, sub_sms_); }
 
   template <class TDeps, __BOOST_SML_REQUIRES(!aux::is_same<aux::remove_reference_t<TDeps>, sm>::value)>
@@ -463,30 +1056,60 @@ class sm {
 
   template <class TEvent, __BOOST_SML_REQUIRES(aux::is_base_of<TEvent, events_ids>::value)>
   bool process_event(const TEvent &event) {
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value ||
+                      aux::is_constructible<TEvent, const TEvent &>::value,
+                  "Non-copyable events have to be processed as rvalues when the defer queue policy is used!");
     return aux::get<sm_impl<TSM>>(sub_sms_).process_event(event, deps_, sub_sms_);
   }
 
+  template <class TEvent,
+            __BOOST_SML_REQUIRES(aux::is_same<aux::remove_const_t<aux::remove_reference_t<TEvent>>, TEvent>::value &&
+                                 aux::is_base_of<TEvent, events_ids>::value)>
+  bool process_event(TEvent &&event) {
+    return aux::get<sm_impl<TSM>>(sub_sms_).process_event(static_cast<TEvent &&>(event), deps_, sub_sms_);
+  }
+
   template <class TEvent, __BOOST_SML_REQUIRES(!aux::is_base_of<TEvent, events_ids>::value)>
   bool process_event(const TEvent &event) {
     return aux::get<sm_impl<TSM>>(sub_sms_).process_event(unexpected_event<_, TEvent>{event}, deps_, sub_sms_);
   }
 
+  /// Processes events of the range one by one, each of them runs to completion as with `process_event`, but the
+  /// thread safety lock is taken once for the whole range. Elements are either events or variants of events.
+  /// Returns the number of handled events.
+  template <class TIt>
+  int process_events(TIt first, const TIt last) {
+    auto &impl = aux::get<sm_impl<TSM>>(sub_sms_);
+    const auto lock = impl.thread_safety_.create_batch_lock(impl.current_state_);
+    (void)lock;
+    using value_t = aux::remove_const_t<aux::remove_reference_t<decltype(*first)>>;
+    auto handled = 0;
+    for (; first != last; ++first) {
+      handled += process_events_impl(*first, is_events_variant<sm, value_t>{});
+    }
+    return handled;
+  }
+
   template <class T = aux::identity<sm_t>, class TVisitor, __BOOST_SML_REQUIRES(concepts::callable<void, TVisitor>::value)>
   void visit_current_states(const TVisitor &visitor) const {
     using type = typename T::type;
     using sm_impl_t = sm_impl<typename TSM::template rebind<type>>;
-    using states_t = typename sm_impl_t::states_t;
-    constexpr auto regions = sm_impl_t::regions;
-    aux::cget<sm_impl_t>(sub_sms_).visit_current_states(visitor, states_t{}, aux::make_index_sequence<regions>{});
+    states_snapshot<sm_impl_t>{aux::cget<sm_impl_t>(sub_sms_)}.visit_current_states(visitor);
   }
 
-  template <class T = aux::identity<sm_t>, class TState>
-  bool is(const TState &) const {
+  template <class T = aux::identity<sm_t>>
+  auto snapshot_states() const {
     using type = typename T::type;
     using sm_impl_t = sm_impl<typename TSM::template rebind<type>>;
-    using state_t = typename sm_impl_t::state_t;
-    using states_ids_t = typename sm_impl_t::states_ids_t;
-    return aux::get_id<state_t, typename TState::type>((states_ids_t *)0) == aux::cget<sm_impl_t>(sub_sms_).current_state_[0];
+    return states_snapshot<sm_impl_t>{aux::cget<sm_impl_t>(sub_sms_)};
+  }
+
+  /// true while an asynchronous action is in progress, incoming events are deferred until it completes
+  bool pending() const { return aux::cget<sm_impl<TSM>>(sub_sms_).is_async_pending(); }
+
+  template <class T = aux::identity<sm_t>, class TState>
+  bool is(const TState &state) const {
+    return snapshot_states<T>().is(state);
   }
 
   template <class T = aux::identity<sm_t>, template <class...> class TState>
@@ -521,6 +1144,18 @@ class sm {
     return result;
   }
 
+  /// Number of all instances of the state machine type being in the state (in any region), requires occupancy policy
+  template <class T = aux::identity<sm_t>, class TState>
+  static long occupancy(const TState &) {
+    using type = typename T::type;
+    using sm_impl_t = sm_impl<typename TSM::template rebind<type>>;
+    using states_ids_t = typename sm_impl_t::states_ids_t;
+    using state_t = typename sm_impl_t::state_t;
+    static_assert(!aux::is_same<no_policy, typename TSM::occupancy_policy>::value,
+                  "State Machine requires the occupancy policy to count instances in the states!");
+    return sm_impl_t::occupancy_t::count(aux::get_id<state_t, typename TState::type>((states_ids_t *)0));
+  }
+
   template <class T = aux::identity<sm_t>, class... TStates,
             __BOOST_SML_REQUIRES(!aux::is_same<no_policy, typename TSM::testing_policy>::value && aux::always<T>::value)>
   void set_current_states(const TStates &...) {
@@ -529,6 +1164,8 @@ class sm {
     using states_ids_t = typename sm_impl_t::states_ids_t;
     using state_t = typename sm_impl_t::state_t;
     auto &sm = aux::get<sm_impl_t>(sub_sms_);
+    const auto counter = sm.occupancy_.create_counter(sm.current_state_);
+    (void)counter;
     auto region = 0;
 
 #if defined(__cpp_fold_expressions)  // __pph__
@@ -537,6 +1174,55 @@ class sm {
     (void)aux::swallow{0,
                        (sm.current_state_[region++] = aux::get_id<state_t, typename TStates::type>((states_ids_t *)0), 0)...};
 #endif  // __pph__
+    sm.publish_states();
+  }
+
+  /// Restores the initial states of the state machine and all its sub state machines (history is forgotten) and drops
+  /// deferred and queued events, then executes entry actions of the initial states as the constructor does.
+  /// Transitions, dependencies and data members of the state machine class are kept, nothing is allocated.
+  void reset() {
+    reset_impl(sub_sms_list_t{});
+    aux::get<sm_impl<TSM>>(sub_sms_).start(deps_, sub_sms_);
+  }
+
+  /// Instance of the state machine is the current states of the state machine and all its sub state machines
+  /// (`instance_size` bytes) plus the deferred events, it can be stored outside and loaded back to process events
+  /// on its behalf, see utility::fleet
+  static constexpr int instance_size() { return instance_size_impl(sub_sms_list_t{}); }
+
+  void load_instance(const aux::byte *states) { load_instance_impl(states, sub_sms_list_t{}); }
+
+  void store_instance(aux::byte *states) const { store_instance_impl(states, sub_sms_list_t{}); }
+
+  /// Adds `n` (removes when negative) instances stored outside to the occupancy counters, loading and storing
+  /// instances doesn't change the counters, see utility::fleet
+  static void occupy_instance(const aux::byte *states, const long n) { occupy_instance_impl(states, n, sub_sms_list_t{}); }
+
+  void swap_deferred(deferred_t &deferred) { aux::get<sm_impl<TSM>>(sub_sms_).swap_deferred(deferred); }
+
+  /// Handlers processing the event by the state machine being in the state with given id (of the first region),
+  /// dispatching many events with the same handler keeps the branch predictable, see utility::process_batch
+  template <class TEvent>
+  static auto state_handlers() {
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value ||
+                      aux::is_constructible<TEvent, const TEvent &>::value,
+                  "Non-copyable events have to be processed as rvalues when the defer queue policy is used!");
+    return state_handlers_impl<TEvent>(typename sm_impl<TSM>::states_t{});
+  }
+
+  int current_state_id() const {
+    typename sm_impl<TSM>::state_t current_state[sm_impl<TSM>::regions];
+    aux::cget<sm_impl<TSM>>(sub_sms_).load_states(current_state);
+    return current_state[0];
+  }
+
+  static int current_state_id(const aux::byte *states) {
+    typename sm_impl<TSM>::state_t state{};
+    const auto bytes = reinterpret_cast<aux::byte *>(&state);
+    for (auto i = 0u; i < sizeof(state); ++i) {
+      bytes[i] = states[i];
+    }
+    return state;
   }
 
   template <class T>
@@ -550,6 +1236,28 @@ class sm {
   }
 
  private:
+  template <class>
+  friend struct events_visitor;
+
+  // Events of the batch are processed with the lock already taken by `process_events`.
+  template <class TEvent, __BOOST_SML_REQUIRES(aux::is_base_of<TEvent, events_ids>::value)>
+  bool process_events_impl(const TEvent &event, aux::false_type) {
+    static_assert(aux::is_same<no_policy, typename TSM::defer_queue_policy>::value ||
+                      aux::is_constructible<TEvent, const TEvent &>::value,
+                  "Non-copyable events have to be processed as rvalues when the defer queue policy is used!");
+    return aux::get<sm_impl<TSM>>(sub_sms_).process_event(event, deps_, sub_sms_, true);
+  }
+
+  template <class TEvent, __BOOST_SML_REQUIRES(!aux::is_base_of<TEvent, events_ids>::value)>
+  bool process_events_impl(const TEvent &event, aux::false_type) {
+    return aux::get<sm_impl<TSM>>(sub_sms_).process_event(unexpected_event<_, TEvent>{event}, deps_, sub_sms_, true);
+  }
+
+  template <class TVariant>
+  bool process_events_impl(const TVariant &variant, aux::true_type) {
+    return visit(events_visitor<sm>{*this}, variant);
+  }
+
   deps_t deps_;
   sub_sms_t sub_sms_;
 };
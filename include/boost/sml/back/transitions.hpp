@@ -28,7 +28,7 @@ template <class T, class... Ts>
 struct transitions<T, Ts...> {
   template <class TEvent, class SM, class TDeps, class TSubs>
   static bool execute(const TEvent& event, SM& sm, TDeps& deps, TSubs& subs, typename SM::state_t& current_state) {
-    if (aux::get<T>(sm.transitions_).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{})) {
+    if (aux::get<T>(sm.transitions()).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{})) {
       return true;
     }
     return transitions<Ts...>::execute(event, sm, deps, subs, current_state);
@@ -44,13 +44,13 @@ struct transitions<T> {
 
   template <class TEvent, class SM, class TDeps, class TSubs>
   static bool execute_impl(const TEvent& event, SM& sm, TDeps& deps, TSubs& subs, typename SM::state_t& current_state) {
-    return aux::get<T>(sm.transitions_).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
+    return aux::get<T>(sm.transitions()).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
   }
 
   template <class _, class TEvent, class SM, class TDeps, class TSubs>
   static bool execute_impl(const on_exit<_, TEvent>& event, SM& sm, TDeps& deps, TSubs& subs,
                            typename SM::state_t& current_state) {
-    aux::get<T>(sm.transitions_).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
+    aux::get<T>(sm.transitions()).execute(event, sm, deps, subs, current_state, typename SM::has_entry_exits{});
     return false;  // from bottom to top
   }
 };
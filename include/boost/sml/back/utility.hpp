@@ -73,6 +73,10 @@ using get_sub_internal_events =
 template <class... Ts>
 using get_events = aux::type_list<typename Ts::event...>;
 
+template <class... Ts>
+using get_timeout_transitions = aux::join_t<
+    typename aux::conditional<aux::is_same<timeout, typename Ts::event>::value, aux::type_list<Ts>, aux::type_list<>>::type...>;
+
 template <class T>
 struct get_exception : aux::type_list<> {};
 
@@ -93,6 +97,97 @@ template <class... Ts>
 using get_history_states = aux::join_t<
     typename aux::conditional<!Ts::history && Ts::initial, aux::type_list<typename Ts::src_state>, aux::type_list<>>::type...>;
 
+template <class>
+struct is_sub_sm : aux::false_type {};
+
+template <class T>
+struct is_sub_sm<sm<T>> : aux::true_type {};
+
+/// bit mask of the orthogonal regions (identified by their initial states) from which each state is reachable
+template <class TStates, class TInitialStates, class TTransitions>
+struct regions_masks;
+
+template <class... TStates, class... TInitialStates, class... TTransitions>
+struct regions_masks<aux::type_list<TStates...>, aux::type_list<TInitialStates...>, aux::type_list<TTransitions...>> {
+  using ids_t = aux::type_id<TStates...>;
+  using mask_t = unsigned long long;
+
+  struct masks {
+    mask_t value[sizeof...(TStates)];
+  };
+
+  static constexpr masks make() {
+    constexpr int initial[] = {aux::get_id<int, TInitialStates>((ids_t *)0)...};
+    constexpr int src[] = {-1, aux::get_id<int, typename TTransitions::src_state>((ids_t *)0)...};
+    constexpr int dst[] = {-1, aux::get_id<int, typename TTransitions::dst_state>((ids_t *)0)...};
+    masks m{};
+    for (auto r = 0; r < int(sizeof...(TInitialStates)); ++r) {
+      m.value[initial[r]] |= mask_t(1) << r;
+    }
+    for (auto changed = true; changed;) {
+      changed = false;
+      for (auto i = 1; i <= int(sizeof...(TTransitions)); ++i) {
+        const auto mask = m.value[dst[i]] | m.value[src[i]];
+        changed |= mask != m.value[dst[i]];
+        m.value[dst[i]] = mask;
+      }
+    }
+    return m;
+  }
+
+  static constexpr mask_t sub_sms() {
+    constexpr masks m = make();
+    constexpr bool sub_sm[] = {is_sub_sm<TStates>::value...};
+    mask_t mask = 0;
+    for (auto i = 0; i < int(sizeof...(TStates)); ++i) {
+      mask |= sub_sm[i] ? m.value[i] : 0;
+    }
+    return mask;
+  }
+
+  template <class... Ts>
+  static constexpr mask_t get(const aux::type_list<Ts...> &) {
+    constexpr masks m = make();
+    mask_t mask = sub_sms();
+    (void)aux::swallow{0, (mask |= m.value[aux::get_id<int, Ts>((ids_t *)0)], 0)...};
+    return mask;
+  }
+
+  template <class TDep, class... TDeps>
+  static constexpr bool has_dep(const aux::type_list<TDeps...> &) {
+    constexpr bool deps[] = {false, aux::is_same<TDep, aux::remove_const_t<aux::remove_reference_t<TDeps>>>::value...};
+    auto found = false;
+    for (const auto dep : deps) {
+      found |= dep;
+    }
+    return found;
+  }
+
+  /// regions with an action/guard which takes `TDep` as a dependency
+  template <class TDep>
+  static constexpr mask_t deps_regions() {
+    constexpr masks m = make();
+    mask_t mask = 0;
+    (void)aux::swallow{0, (mask |= has_dep<TDep>(typename TTransitions::deps{})
+                                       ? m.value[aux::get_id<int, typename TTransitions::src_state>((ids_t *)0)]
+                                       : 0,
+                           0)...};
+    return mask;
+  }
+};
+
+template <unsigned long long, class, class = aux::index_sequence<>>
+struct masked_regions;
+
+template <unsigned long long Mask, int... Rs>
+struct masked_regions<Mask, aux::index_sequence<>, aux::index_sequence<Rs...>> : aux::index_sequence<Rs...> {};
+
+template <unsigned long long Mask, int N, int... Ns, int... Rs>
+struct masked_regions<Mask, aux::index_sequence<N, Ns...>, aux::index_sequence<Rs...>>
+    : masked_regions<Mask, aux::index_sequence<Ns...>,
+                     aux::conditional_t<((Mask >> N) & 1u) != 0, aux::index_sequence<Rs..., N>, aux::index_sequence<Rs...>>> {
+};
+
 template <class>
 struct get_sub_sm : aux::type_list<> {};
 
@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_FRONT_ACTIONS_ASYNC_ACTION_HPP
+#define BOOST_SML_FRONT_ACTIONS_ASYNC_ACTION_HPP
+
+#include "boost/sml/front/operators.hpp"
+
+namespace front {
+namespace actions {
+
+struct async_action {
+  template <class T>
+  class async_action_impl : operator_base {
+   public:
+    explicit async_action_impl(T action) : action(action) {}
+
+    template <class TEvent, class TSM, class TDeps, class TSubs>
+    void operator()(const TEvent &event, TSM &sm, TDeps &deps, TSubs &subs) {
+      using root_sm_t = get_root_sm_t<TSubs>;
+      using executor_t = typename root_sm_t::async_executor_t;
+      static_assert(!aux::is_same<back::no_policy, executor_t>::value,
+                    "Asynchronous actions require sml::async_executor policy!");
+      static_assert(!aux::is_same<back::no_policy, typename root_sm_t::defer_t>::value,
+                    "Asynchronous actions require sml::defer_queue policy!");
+      auto &root = aux::get<root_sm_t>(subs);
+      ++root.async_pending_;
+      const auto epoch = root.async_epoch_;
+      static_cast<aux::pool_type<executor_t &> &>(deps).value.async_wait(
+          call<TEvent, args_t<T, TEvent>, back::no_policy>::execute(action, event, sm, deps, subs),
+          [&root, &deps, &subs, epoch] { root.complete_async(deps, subs, epoch); });
+    }
+
+   private:
+    T action;
+  };
+
+  template <class T>
+  auto operator()(T action) const {
+    return async_action_impl<T>{action};
+  }
+};
+
+}  // namespace actions
+}  // namespace front
+
+#endif
@@ -17,10 +17,25 @@ struct defer : action_base {
   void operator()(const TEvent &event, TSM &sm, TDeps &, TSubs &) {
     if (sm.defer_processing_) {
       sm.defer_again_ = true;
+    } else if (sm.defer_event_ == &event) {
+      sm.defer_pending_ = true;
     } else {
-      sm.defer_.push_back(event);
+      push_back<get_root_sm_t<TSubs>>(event, sm, aux::is_constructible<TEvent, const TEvent &>{});
     }
   }
+
+ private:
+  template <class TRootSM, class TEvent, class TSM>
+  static void push_back(const TEvent &event, TSM &sm, const aux::true_type &) {
+    sm.defer_.push_back(event);
+  }
+
+  // Every entry point taking a non-copyable event by const reference is rejected at compile time when the defer queue
+  // policy is used, so a root state machine only reaches the defer action with the event owned by process_event.
+  template <class TRootSM, class TEvent, class TSM>
+  static void push_back(const TEvent &, TSM &, const aux::false_type &) {
+    static_assert(aux::is_same<TRootSM, TSM>::value, "Non-copyable events can only be deferred by the root state machine!");
+  }
 };
 
 }  // namespace actions
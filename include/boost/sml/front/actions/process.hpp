@@ -16,10 +16,10 @@ struct process {
   template <class TEvent>
   class process_impl : public action_base {
    public:
-    explicit process_impl(const TEvent& event) : event(event) {}
+    explicit process_impl(TEvent event) : event(static_cast<TEvent&&>(event)) {}
 
     template <class T, class TSM, class TDeps, class TSubs>
-    void operator()(const T&, TSM&, TDeps&, TSubs&) {
+    void operator()(const T&, TSM&, TDeps&, TSubs& subs) {
       aux::get<get_root_sm_t<TSubs>>(subs).process_.push(event);
     }
 
@@ -28,8 +28,8 @@ struct process {
   };
 
   template <class TEvent>
-  auto operator()(const TEvent& event) {
-    return process_impl<TEvent>{event};
+  auto operator()(TEvent&& event) {
+    return process_impl<aux::remove_const_t<aux::remove_reference_t<TEvent>>>{static_cast<TEvent&&>(event)};
   }
 };
 
@@ -33,6 +33,13 @@ struct event {
   auto operator()() const { return TEvent{}; }
 };
 
+/// guard of the `after(duration)` transitions, the duration is armed when the source state is entered
+template <class TDuration>
+struct after_ {
+  bool operator()() const { return true; }
+  TDuration duration;
+};
+
 }  // namespace front
 
 #endif
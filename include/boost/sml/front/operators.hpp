@@ -62,11 +62,11 @@ decltype(auto) get_arg(const aux::type<const TEvent &> &, const back::exception<
   return event.exception_;
 }
 template <class... TEvents, class TEvent, class TSM, class TDeps>
-decltype(auto) get_arg(const aux::type<back::defer<TEvents...>> &, const TEvent, TSM &sm, TDeps &) {
+decltype(auto) get_arg(const aux::type<back::defer<TEvents...>> &, const TEvent &, TSM &sm, TDeps &) {
   return back::defer<TEvents...>{sm.defer_};
 }
 template <class... TEvents, class TEvent, class TSM, class TDeps>
-decltype(auto) get_arg(const aux::type<back::process<TEvents...>> &, const TEvent, TSM &sm, TDeps &) {
+decltype(auto) get_arg(const aux::type<back::process<TEvents...>> &, const TEvent &, TSM &sm, TDeps &) {
   return back::process<TEvents...>{sm.process_};
 }
 
@@ -51,7 +51,7 @@ struct always {
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
 };
 
-struct none {
+struct none : back::no_action {
   using type = none;
   void operator()() {}
   __BOOST_SML_ZERO_SIZE_ARRAY(aux::byte);
@@ -236,7 +236,8 @@ template <class T, class TSubs, class... Ts, class... THs>
 void update_composite_states(TSubs &subs, aux::true_type, const aux::type_list<THs...> &) {
   using state_t = typename T::state_t;
   auto &sm = back::sub_sm<T>::get(&subs);
-  (void)sm;
+  const auto counter = sm.occupancy_.create_counter(sm.current_state_);
+  (void)counter;
 #if defined(__cpp_fold_expressions)  // __pph__
   ((sm.current_state_[aux::get_id<state_t, THs>((typename T::initial_states_ids_t *)0)] =
         aux::get_id<state_t, THs>((typename T::states_ids_t *)0)),
@@ -246,28 +247,37 @@ void update_composite_states(TSubs &subs, aux::true_type, const aux::type_list<T
                              aux::get_id<state_t, THs>((typename T::states_ids_t *)0),
                          0)...};
 #endif  // __pph__
+  sm.publish_states();
 }
 
 template <class T, class TSubs, class... Ts>
 void update_composite_states(TSubs &subs, aux::false_type, Ts &&...) {
-  back::sub_sm<T>::get(&subs).initialize(typename T::initial_states_t{});
+  auto &sm = back::sub_sm<T>::get(&subs);
+  const auto counter = sm.occupancy_.create_counter(sm.current_state_);
+  (void)counter;
+  sm.initialize(typename T::initial_states_t{});
+  sm.publish_states();
 }
 
 template <class SM, class TDeps, class TSubs, class TSrcState, class TDstState>
-void update_current_state(SM &, TDeps &deps, TSubs &, typename SM::state_t &current_state,
+void update_current_state(SM &sm, TDeps &deps, TSubs &subs, typename SM::state_t &current_state,
                           const typename SM::state_t &new_state, const TSrcState &, const TDstState &) {
   back::policies::log_state_change<typename SM::sm_t>(aux::type<typename SM::logger_t>{}, deps,
                                                       aux::string<typename TSrcState::type>{},
                                                       aux::string<typename TDstState::type>{});
+  sm.occupancy_.change(current_state, new_state);
   current_state = new_state;
+  sm.arm_timeout(deps, subs, current_state);
 }
 
 template <class SM, class TDeps, class TSubs, class TSrcState, class T>
-void update_current_state(SM &, TDeps &deps, TSubs &subs, typename SM::state_t &current_state,
+void update_current_state(SM &sm, TDeps &deps, TSubs &subs, typename SM::state_t &current_state,
                           const typename SM::state_t &new_state, const TSrcState &, const state<back::sm<T>> &) {
   back::policies::log_state_change<typename SM::sm_t>(aux::type<typename SM::logger_t>{}, deps,
                                                       aux::string<typename TSrcState::type>{}, aux::string<T>{});
+  sm.occupancy_.change(current_state, new_state);
   current_state = new_state;
+  sm.arm_timeout(deps, subs, current_state);
   update_composite_states<back::sm_impl<T>>(subs, typename back::sm_impl<T>::has_history_states{},
                                             typename back::sm_impl<T>::history_states_t{});
 }
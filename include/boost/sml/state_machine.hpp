@@ -14,16 +14,33 @@
 /// policies
 
 using testing = back::policies::testing;
+using shared_transitions = back::policies::shared_transitions;
 template <class T>
 using logger = back::policies::logger<T>;
 template <class T>
+using async_executor = back::policies::async_executor<T>;
+template <class T>
+using timer_service = back::policies::timer_service<T>;
+template <class T>
 using thread_safe = back::policies::thread_safe<T>;
 template <class T>
+using thread_safe_regions = back::policies::thread_safe_regions<T>;
+template <class T, template <class...> class TAtomic>
+using optimistic_thread_safe = back::policies::optimistic_thread_safe<T, TAtomic>;
+template <class T>
 using dispatch = back::policies::dispatch<T>;
+template <class T>
+using parallel_regions = back::policies::parallel_regions<T>;
 template <template <class...> class T>
-using defer_queue = back::policies::defer_queue<T>;
-template <template <class...> class T>
-using process_queue = back::policies::process_queue<T>;
+using seqlock = back::policies::seqlock<T>;
+template <template <class...> class T, int Shards = 1>
+using occupancy = back::policies::occupancy<T, Shards>;
+template <template <class...> class T, class TAllocator = void>
+using defer_queue = back::policies::defer_queue<T, TAllocator>;
+template <template <class...> class T, class TAllocator = void>
+using process_queue = back::policies::process_queue<T, TAllocator>;
+template <template <class...> class T, class TAllocator = void>
+using priority_process_queue = back::policies::priority_process_queue<T, TAllocator>;
 
 /// state machine
 
@@ -10,6 +10,7 @@
 #include "boost/sml/aux_/type_traits.hpp"
 #include "boost/sml/back/internals.hpp"
 #include "boost/sml/concepts/transitional.hpp"
+#include "boost/sml/front/actions/async_action.hpp"
 #include "boost/sml/front/actions/defer.hpp"
 #include "boost/sml/front/actions/process.hpp"
 #include "boost/sml/front/event.hpp"
@@ -41,6 +42,14 @@ front::event<back::unexpected_event<TEvent>> unexpected_event __BOOST_SML_VT_INI
 template <class T>
 front::event<back::exception<T>> exception __BOOST_SML_VT_INIT;
 
+/// `state + after(duration) = next` transitions are taken when the state has been active for `duration`, requires
+/// timer_service policy
+template <class TDuration>
+auto after(const TDuration &duration) {
+  return front::transition_eg<front::event<back::timeout>, aux::zero_wrapper<front::after_<TDuration>>>{
+      {}, aux::zero_wrapper<front::after_<TDuration>>{front::after_<TDuration>{duration}}};
+}
+
 using anonymous = back::anonymous;
 using initial = back::initial;
 
@@ -75,6 +84,7 @@ __BOOST_SML_UNUSED static front::history_state H;
 
 __BOOST_SML_UNUSED static front::actions::defer defer;
 __BOOST_SML_UNUSED static front::actions::process process;
+__BOOST_SML_UNUSED static front::actions::async_action async_action;
 
 /// transition table
 
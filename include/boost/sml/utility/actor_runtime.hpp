@@ -0,0 +1,604 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_ACTOR_RUNTIME_HPP
+#define BOOST_SML_UTILITY_ACTOR_RUNTIME_HPP
+
+#include <atomic>
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+class actor_runtime;
+
+template <class>
+class actor;
+
+namespace detail {
+
+/// intrusive multi-producer/single-consumer queue (Vyukov), `T` has to provide `std::atomic<T *> next`
+template <class T>
+class mpsc_queue {
+ public:
+  mpsc_queue() = default;
+  mpsc_queue(const mpsc_queue &) = delete;
+  mpsc_queue &operator=(const mpsc_queue &) = delete;
+
+  void push(T *node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    const auto prev = head_.exchange(node);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /// returns nullptr when empty or when a producer is in the middle of `push`
+  T *pop() {
+    auto tail = tail_;
+    auto next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (!next) {
+        return nullptr;
+      }
+      tail_ = tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+      tail_ = next;
+      return tail;
+    }
+    if (tail != head_.load()) {
+      return nullptr;
+    }
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+  /// may be called by any thread, false negatives are not possible once `push` returned
+  bool maybe_empty() const { return head_.load() == &stub_; }
+
+ private:
+  T stub_{};
+  std::atomic<T *> head_{&stub_};
+  T *tail_ = &stub_;
+};
+
+/// Chase-Lev work stealing deque, the owner pushes/pops at the bottom, thieves steal from the top
+template <class T>
+class work_stealing_deque {
+  struct ring {
+    explicit ring(const std::int64_t capacity) : capacity(capacity), items(new std::atomic<T *>[capacity]) {}
+
+    T *get(const std::int64_t i) const { return items[i & (capacity - 1)].load(std::memory_order_relaxed); }
+    void put(const std::int64_t i, T *item) { items[i & (capacity - 1)].store(item, std::memory_order_relaxed); }
+
+    const std::int64_t capacity;
+    std::unique_ptr<std::atomic<T *>[]> items;
+  };
+
+ public:
+  explicit work_stealing_deque(const std::int64_t capacity = 1024) : ring_(new ring(capacity)) {}
+  work_stealing_deque(const work_stealing_deque &) = delete;
+  work_stealing_deque &operator=(const work_stealing_deque &) = delete;
+  ~work_stealing_deque() { delete ring_.load(); }
+
+  void push(T *item) {
+    const auto b = bottom_.load(std::memory_order_relaxed);
+    const auto t = top_.load(std::memory_order_acquire);
+    auto r = ring_.load(std::memory_order_relaxed);
+    if (b - t > r->capacity - 1) {
+      auto grown = new ring(r->capacity * 2);
+      for (auto i = t; i < b; ++i) {
+        grown->put(i, r->get(i));
+      }
+      retired_.emplace_back(r);
+      ring_.store(r = grown, std::memory_order_release);
+    }
+    r->put(b, item);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  T *pop() {
+    const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+    const auto r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    auto item = r->get(b);
+    if (t == b) {
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  T *steal() {
+    auto t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    const auto item = ring_.load(std::memory_order_acquire)->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  bool empty() const { return top_.load() >= bottom_.load(); }
+
+ private:
+  std::atomic<std::int64_t> top_{0};
+  char padding_[64 - sizeof(std::atomic<std::int64_t>)];  /// top/bottom on separate cache lines
+  std::atomic<std::int64_t> bottom_{0};
+  std::atomic<ring *> ring_;
+  std::vector<std::unique_ptr<ring>> retired_{};
+};
+
+struct message {
+  std::atomic<message *> next{nullptr};
+  void (*process)(void *, message *) = nullptr;
+  void (*destroy)(message *) = nullptr;
+};
+
+template <class TEvent>
+struct event_message : message {
+  template <class T>
+  explicit event_message(T &&event) : event(static_cast<T &&>(event)) {}
+  TEvent event;
+};
+
+#if defined(__cpp_impl_coroutine)
+/// thread local free lists of coroutine frames bucketed by size, a frame is recycled by the thread which frees it
+class frame_pool {
+  static constexpr std::size_t granularity = 64;
+  static constexpr std::size_t buckets = 16;  /// frames up to 960 bytes are recycled
+  static constexpr std::size_t max_free = 256;
+
+  struct node {
+    node *next;
+  };
+
+  struct free_list {
+    node *head = nullptr;
+    std::size_t size = 0;
+  };
+
+  struct free_lists {
+    ~free_lists() {
+      for (auto &list : lists) {
+        while (const auto n = list.head) {
+          list.head = n->next;
+          ::operator delete(n);
+        }
+      }
+    }
+
+    free_list lists[buckets];
+  };
+
+  static free_lists &local() {
+    static thread_local free_lists lists{};
+    return lists;
+  }
+
+ public:
+  static void *allocate(const std::size_t size) {
+    const auto i = (size + granularity - 1) / granularity;
+    if (i >= buckets) {
+      return ::operator new(size);
+    }
+    auto &list = local().lists[i];
+    if (const auto n = list.head) {
+      list.head = n->next;
+      --list.size;
+      return n;
+    }
+    return ::operator new(i * granularity);
+  }
+
+  static void deallocate(void *ptr, const std::size_t size) {
+    const auto i = (size + granularity - 1) / granularity;
+    if (i >= buckets) {
+      ::operator delete(ptr);
+      return;
+    }
+    auto &list = local().lists[i];
+    if (list.size == max_free) {
+      ::operator delete(ptr);
+      return;
+    }
+    list.head = new (ptr) node{list.head};
+    ++list.size;
+  }
+};
+#endif
+
+struct worker;
+
+struct actor_base {
+  std::atomic<actor_base *> next{nullptr};
+  std::atomic<bool> scheduled{false};
+  mpsc_queue<message> mailbox{};
+  actor_runtime *runtime = nullptr;
+  void *state_machine = nullptr;
+  const void *owner = nullptr;             /// set when the actor is owned by the runtime
+  bool despawned = false;                  /// only accessed by the worker running the actor
+  std::atomic<bool> despawn_posted{false};  /// `despawn` doesn't access the actor anymore
+};
+
+/// queued after the events already sent to the actor, the worker releases the actor once it has been processed
+struct despawn_message : message {
+  explicit despawn_message(actor_base &actor) : actor(actor) {
+    this->process = &despawn_message::process_impl;
+    this->destroy = &despawn_message::destroy_impl;
+  }
+
+  static void process_impl(void *, message *message) {
+    const auto self = static_cast<despawn_message *>(message);
+    self->actor.despawned = true;
+    delete self;
+  }
+
+  static void destroy_impl(message *message) { delete static_cast<despawn_message *>(message); }
+
+  actor_base &actor;
+};
+
+struct worker {
+  work_stealing_deque<actor_base> deque{};
+  mpsc_queue<actor_base> inbox{};
+  actor_runtime *runtime = nullptr;
+  std::thread thread{};
+};
+
+}  // namespace detail
+
+/// Runs state machines as actors: events sent to an actor are queued in its lock-free mailbox and processed by
+/// one of the worker threads, an actor is run by at most one worker at a time so no per state machine lock is required
+class actor_runtime {
+  template <class>
+  friend class actor;
+
+ public:
+  explicit actor_runtime(const std::size_t workers = std::thread::hardware_concurrency(), const std::size_t batch = 64)
+      : workers_(workers ? workers : 1), batch_(batch ? batch : 1) {
+    for (auto &w : workers_) {
+      w.runtime = this;
+      w.thread = std::thread{[this, &w] { run(w); }};
+    }
+  }
+
+  actor_runtime(const actor_runtime &) = delete;
+  actor_runtime &operator=(const actor_runtime &) = delete;
+
+  ~actor_runtime() {
+    {
+      std::lock_guard<std::mutex> lock{sleep_mutex_};
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto &w : workers_) {
+      w.thread.join();
+    }
+  }
+
+  /// creates a `SM` actor owned by the runtime
+  template <class SM, class... TDeps>
+  auto &spawn(TDeps &&... deps);
+
+  /// destroys the actor once the events already sent to it have been processed,
+  /// all `send` calls to the actor have to return before and none may follow
+  template <class SM>
+  void despawn(actor<SM> &a);
+
+  /// blocks until all mailboxes have been drained
+  void wait_idle() {
+    std::unique_lock<std::mutex> lock{idle_mutex_};
+    idle_cv_.wait(lock, [this] { return !active_.load(); });
+  }
+
+  std::size_t workers() const { return workers_.size(); }
+
+  /// number of actors owned by the runtime
+  std::size_t actors() {
+    std::lock_guard<std::mutex> lock{actors_mutex_};
+    return actors_.size();
+  }
+
+ private:
+  void schedule(detail::actor_base *actor) {
+    ++active_;
+    const auto w = current() && current()->runtime == this ? current() : nullptr;
+    if (w) {
+      w->deque.push(actor);
+    } else {
+      workers_[next_worker_++ % workers_.size()].inbox.push(actor);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      { std::lock_guard<std::mutex> lock{sleep_mutex_}; }
+      // inboxes are drained by their owner only, whereas deques may be stolen from by any worker
+      if (w) {
+        sleep_cv_.notify_one();
+      } else {
+        sleep_cv_.notify_all();
+      }
+    }
+  }
+
+  detail::worker *&current() {
+    static thread_local detail::worker *worker = nullptr;
+    return worker;
+  }
+
+  detail::actor_base *next_actor(detail::worker &w, std::size_t &victim) {
+    if (auto actor = w.deque.pop()) {
+      return actor;
+    }
+    if (auto actor = w.inbox.pop()) {
+      return actor;
+    }
+    for (auto i = 0u; i < workers_.size(); ++i, ++victim) {
+      auto &other = workers_[victim % workers_.size()];
+      if (&other != &w) {
+        if (auto actor = other.deque.steal()) {
+          return actor;
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  bool has_work(const detail::worker &w) const {
+    if (!w.inbox.maybe_empty()) {
+      return true;
+    }
+    for (const auto &other : workers_) {
+      if (!other.deque.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(detail::worker &w) {
+    current() = &w;
+    auto victim = static_cast<std::size_t>(&w - &workers_[0]) + 1;
+    auto spins = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+      if (auto actor = next_actor(w, victim)) {
+        run(w, *actor);
+        spins = 0;
+      } else if (++spins < 64) {
+        std::this_thread::yield();
+      } else {
+        std::unique_lock<std::mutex> lock{sleep_mutex_};
+        ++sleeping_;
+        sleep_cv_.wait(lock, [&] { return stop_.load() || has_work(w); });
+        --sleeping_;
+        spins = 0;
+      }
+    }
+    current() = nullptr;
+  }
+
+  void run(detail::worker &w, detail::actor_base &actor) {
+    for (auto i = 0u; i < batch_; ++i) {
+      const auto message = actor.mailbox.pop();
+      if (!message) {
+        actor.scheduled.store(false);
+        if (actor.mailbox.maybe_empty() || actor.scheduled.exchange(true)) {
+          if (!--active_) {
+            { std::lock_guard<std::mutex> lock{idle_mutex_}; }
+            idle_cv_.notify_all();
+          }
+          return;
+        }
+        break;
+      }
+      message->process(actor.state_machine, message);
+      if (actor.despawned) {
+        while (!actor.despawn_posted.load()) {
+          std::this_thread::yield();
+        }
+        release(actor);
+        return;
+      }
+    }
+    w.inbox.push(&actor);
+  }
+
+  void release(detail::actor_base &actor) {
+    std::shared_ptr<void> owned{};
+    {
+      std::lock_guard<std::mutex> lock{actors_mutex_};
+      for (auto &a : actors_) {
+        if (a.get() == actor.owner) {
+          owned.swap(a);
+          a.swap(actors_.back());
+          actors_.pop_back();
+          break;
+        }
+      }
+    }
+    owned.reset();
+    if (!--active_) {
+      { std::lock_guard<std::mutex> lock{idle_mutex_}; }
+      idle_cv_.notify_all();
+    }
+  }
+
+  std::vector<detail::worker> workers_;
+  const std::size_t batch_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int> sleeping_{0};
+  std::mutex sleep_mutex_{};
+  std::condition_variable sleep_cv_{};
+  std::atomic<std::size_t> active_{0};
+  std::mutex idle_mutex_{};
+  std::condition_variable idle_cv_{};
+  std::atomic<std::size_t> next_worker_{0};
+  std::mutex actors_mutex_{};
+  std::vector<std::shared_ptr<void>> actors_{};
+};
+
+template <class SM>
+class actor : detail::actor_base {
+  friend class actor_runtime;
+
+  template <class TEvent>
+  static void process(void *sm, detail::message *message) {
+    const auto event = static_cast<detail::event_message<TEvent> *>(message);
+    static_cast<SM *>(sm)->process_event(static_cast<TEvent &&>(event->event));
+    delete event;
+  }
+
+  template <class TEvent>
+  static void destroy(detail::message *message) {
+    delete static_cast<detail::event_message<TEvent> *>(message);
+  }
+
+  void post(detail::message *message) {
+    mailbox.push(message);
+    if (!scheduled.exchange(true)) {
+      runtime->schedule(this);
+    }
+  }
+
+#if defined(__cpp_impl_coroutine)
+  /// the awaiter itself is queued in the mailbox, so that suspension doesn't allocate
+  template <class TEvent>
+  class process_event_awaiter : detail::message {
+    static void process_impl(void *sm, detail::message *message) {
+      const auto self = static_cast<process_event_awaiter *>(message);
+      self->handled_ = static_cast<SM *>(sm)->process_event(static_cast<TEvent &&>(self->event_));
+      self->caller_.resume();
+    }
+
+    static void destroy_impl(detail::message *) {}
+
+   public:
+    template <class T>
+    process_event_awaiter(actor &a, T &&event) : actor_(a), event_(static_cast<T &&>(event)) {
+      this->process = &process_event_awaiter::process_impl;
+      this->destroy = &process_event_awaiter::destroy_impl;
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(const std::coroutine_handle<> caller) {
+      caller_ = caller;
+      actor_.post(this);
+    }
+
+    bool await_resume() const noexcept { return handled_; }
+
+   private:
+    actor &actor_;
+    TEvent event_;
+    std::coroutine_handle<> caller_{};
+    bool handled_ = false;
+  };
+#endif
+
+ public:
+  template <class... TDeps>
+  explicit actor(actor_runtime &runtime, TDeps &&... deps) : sm_(new SM(static_cast<TDeps &&>(deps)...)) {
+    this->runtime = &runtime;
+    this->state_machine = sm_.get();
+  }
+
+  actor(const actor &) = delete;
+  actor &operator=(const actor &) = delete;
+
+  ~actor() {
+    while (const auto message = mailbox.pop()) {
+      message->destroy(message);
+    }
+  }
+
+  /// queues the event, it's processed asynchronously by one of the runtime workers
+  template <class TEvent>
+  void send(TEvent &&event) {
+    using event_t = aux::remove_const_t<aux::remove_reference_t<TEvent>>;
+    auto message = new detail::event_message<event_t>(static_cast<TEvent &&>(event));
+    message->process = &actor::process<event_t>;
+    message->destroy = &actor::destroy<event_t>;
+    post(message);
+  }
+
+#if defined(__cpp_impl_coroutine)
+  /// `co_await` queues the event and resumes the caller, on the worker which processed it, once the run-to-completion
+  /// step (including the defer and process queues) has finished, returns whether the event was handled
+  /// callers suspended on an actor which is destroyed are never resumed
+  template <class TEvent>
+  auto async_process_event(TEvent &&event) {
+    using event_t = aux::remove_const_t<aux::remove_reference_t<TEvent>>;
+    return process_event_awaiter<event_t>{*this, static_cast<TEvent &&>(event)};
+  }
+#endif
+
+  /// only safe to use while the actor's mailbox is drained, for example after `actor_runtime::wait_idle`
+  const SM &sm() const { return *sm_; }
+
+ private:
+  std::unique_ptr<SM> sm_;
+};
+
+#if defined(__cpp_impl_coroutine)
+/// base of coroutine promise types which allocates their frames from the thread local `detail::frame_pool`
+struct pooled_frame {
+  static void *operator new(const std::size_t size) { return detail::frame_pool::allocate(size); }
+  static void operator delete(void *ptr, const std::size_t size) { detail::frame_pool::deallocate(ptr, size); }
+};
+#endif
+
+template <class SM, class... TDeps>
+auto &actor_runtime::spawn(TDeps &&... deps) {
+  auto a = std::make_shared<actor<SM>>(*this, static_cast<TDeps &&>(deps)...);
+  auto &result = *a;
+  result.owner = a.get();
+  std::lock_guard<std::mutex> lock{actors_mutex_};
+  actors_.emplace_back(static_cast<std::shared_ptr<actor<SM>> &&>(a));
+  return result;
+}
+
+template <class SM>
+void actor_runtime::despawn(actor<SM> &a) {
+  a.post(new detail::despawn_message{a});
+  a.despawn_posted.store(true);
+}
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
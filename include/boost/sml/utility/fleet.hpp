@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_FLEET_HPP
+#define BOOST_SML_UTILITY_FLEET_HPP
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+#include "boost/sml.hpp"
+#include "boost/sml/utility/process_batch.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+namespace detail {
+template <class TDeferred>
+struct deferred_column {
+  void resize(const std::size_t size) { deferred.resize(size); }
+  template <class SM>
+  void swap(SM &sm, const std::size_t i) {
+    sm.swap_deferred(deferred[i]);
+  }
+  std::deque<TDeferred> deferred{};  /// doesn't relocate the queues on resize
+};
+
+template <>
+struct deferred_column<back::no_policy> {
+  void resize(std::size_t) {}
+  template <class SM>
+  void swap(SM &, std::size_t) {}
+};
+
+template <class>
+struct sm_impl_of;
+
+template <class TSM>
+struct sm_impl_of<back::sm<TSM>> {
+  using type = back::sm_impl<TSM>;
+};
+
+/// the event has to be dispatched to compute the next state (guard, action, unexpected event, ...)
+constexpr aux::byte dispatch_state = 0xff;
+
+template <class TImpl, class TState>
+constexpr aux::byte next_state(const back::transitions<aux::false_type> *) {
+  return aux::get_id<aux::byte, TState>((typename TImpl::states_ids_t *)0);
+}
+
+template <class TImpl, class TState>
+constexpr aux::byte next_state(const back::transitions<aux::true_type> *) {
+  return dispatch_state;
+}
+
+template <class TImpl, class TState, class T, class... Ts>
+constexpr aux::byte next_state(const back::transitions<T, Ts...> *) {
+  using dst_state = aux::conditional_t<aux::is_same<front::internal, typename T::dst_state>::value, TState, typename T::dst_state>;
+  return aux::is_same<front::always, typename T::guard>::value && aux::is_same<front::none, typename T::action>::value
+             ? aux::get_id<aux::byte, dst_state>((typename TImpl::states_ids_t *)0)
+             : dispatch_state;
+}
+
+template <class TImpl, class TState, class T>
+constexpr aux::byte next_state(const T *) {
+  return dispatch_state;
+}
+
+/// next state ids of the whole fleet can be computed from a table when the event can't trigger anything else
+/// than the state change (entry/exit actions, anonymous transitions, sub state machines, queues, logging, occupancy)
+template <class SM, class TEvent, class TImpl = typename sm_impl_of<SM>::type>
+using broadcastable = aux::integral_constant<
+    bool, aux::is_same<aux::byte, typename TImpl::state_t>::value && !aux::size<typename SM::state_machines>::value &&
+              !TImpl::has_entry_exits::value && !aux::is_base_of<back::anonymous, typename TImpl::events_ids_t>::value &&
+              aux::is_same<back::no_policy, typename TImpl::logger_t>::value &&
+              aux::is_same<back::no_policy, typename TImpl::defer_t>::value &&
+              aux::is_same<back::no_policy, typename TImpl::process_t>::value &&
+              aux::is_same<back::no_policy, typename TImpl::occupancy_t>::value>;
+
+template <class TImpl, class TEvent, class = typename TImpl::states_t>
+struct broadcast_table;
+
+template <class TImpl, class TEvent, class... TStates>
+struct broadcast_table<TImpl, TEvent, aux::type_list<TStates...>> {
+  using mappings = back::get_event_mapping_t<back::get_generic_t<TEvent>, typename TImpl::mappings>;
+  static constexpr auto size = sizeof...(TStates);
+
+  static const aux::byte *get() {
+    static const aux::byte next[] = {next_state<TImpl, TStates>(
+        (back::get_state_mapping_t<TStates, mappings, typename TImpl::has_unexpected_events> *)0)...};
+    return next;
+  }
+};
+}  // namespace detail
+
+/// Structure of arrays container of `size` logical instances of the state machine
+///   - current states of all instances (including sub state machines) are stored contiguously,
+///     `SM::instance_size()` bytes per instance
+///   - deferred events (defer_queue policy) are stored in a separate column
+///   - transitions, dependencies, the process queue and data members of the state machine class are shared by all instances
+///
+/// `process_event(i, event)` loads the states of the instance `i`, processes the event and stores them back,
+/// so that only the state bytes of the instance are touched besides the shared state machine.
+/// Entry actions of the initial states are executed once, when the fleet is created.
+/// With the occupancy policy the counters count the instances of the fleet (but not the shared state machine).
+///
+///   sml::utility::fleet<sml::sm<particle>> particles{10'000'000, deps...};
+///   particles.process_event(i, collision{});
+template <class SM>
+class fleet {
+  static_assert(!SM::has_timeouts::value, "`after` transitions aren't supported, instances would share one set of timers");
+
+ public:
+  template <class... TDeps>
+  explicit fleet(const std::size_t size, TDeps &&... deps) : sm_(new SM(static_cast<TDeps &&>(deps)...)) {
+    sm_->store_instance(initial_);
+    SM::occupy_instance(initial_, -1);  /// the shared state machine isn't an instance of the fleet
+    resize(size);
+  }
+
+  fleet(fleet &&) = default;
+
+  ~fleet() {
+    if (sm_) {
+      resize(0);
+      sm_->load_instance(initial_);
+      SM::occupy_instance(initial_, 1);
+    }
+  }
+
+  std::size_t size() const { return size_; }
+
+  /// new instances start from the initial states of the state machine
+  void resize(const std::size_t size) {
+    for (auto i = size; i < size_; ++i) {
+      SM::occupy_instance(&states_[i * SM::instance_size()], -1);
+    }
+    if (size > size_) {
+      SM::occupy_instance(initial_, static_cast<long>(size - size_));
+    }
+    states_.resize(size * SM::instance_size());
+    for (auto i = size_; i < size; ++i) {
+      for (auto s = 0; s < SM::instance_size(); ++s) {
+        states_[i * SM::instance_size() + s] = initial_[s];
+      }
+    }
+    deferred_.resize(size);
+    size_ = size;
+  }
+
+  template <class TEvent>
+  bool process_event(const std::size_t i, TEvent &&event) {
+    auto &sm = load(i);
+    deferred_.swap(sm, i);
+    const auto handled = sm.process_event(static_cast<TEvent &&>(event));
+    deferred_.swap(sm, i);
+    sm.store_instance(&states_[i * SM::instance_size()]);
+    return handled;
+  }
+
+  /// processes the event by all instances, next states of instances for which the transition has neither a guard
+  /// nor an action are looked up from a table (16/32 instances at a time with SSSE3/AVX2 for up to 16 states),
+  /// the event is dispatched only to the remaining ones
+  template <class TEvent>
+  void broadcast(const TEvent &event) {
+    broadcast_impl(event, detail::broadcastable<SM, TEvent>{});
+  }
+
+  /// processes (instance, event) pairs grouped by the current states of the instances, see utility::process_batch
+  template <class TIt, class TOut>
+  void process_batch(const TIt first, const TIt last, TOut handled) {
+    detail::process_batch<SM>(
+        first, last, handled, [this](const std::size_t i) { return &states_[i * SM::instance_size()]; },
+        [this](const std::size_t i) { return SM::current_state_id(&states_[i * SM::instance_size()]); },
+        [this](const std::size_t i, const auto handler, const auto &event) {
+          auto &sm = load(i);
+          deferred_.swap(sm, i);
+          const auto handled = handler(sm, event);
+          deferred_.swap(sm, i);
+          sm.store_instance(&states_[i * SM::instance_size()]);
+          return handled;
+        });
+  }
+
+  template <class... TStates>
+  bool is(const std::size_t i, const TStates &... states) const {
+    return load(i).is(states...);
+  }
+
+  template <class TVisitor>
+  void visit_current_states(const std::size_t i, const TVisitor &visitor) const {
+    load(i).visit_current_states(visitor);
+  }
+
+ private:
+  template <class TEvent>
+  void broadcast_impl(const TEvent &event, aux::false_type) {
+    for (auto i = std::size_t{}; i < size_; ++i) {
+      process_event(i, event);
+    }
+  }
+
+  template <class TEvent>
+  void broadcast_impl(const TEvent &event, aux::true_type) {
+    using table_t = detail::broadcast_table<typename detail::sm_impl_of<SM>::type, TEvent>;
+    constexpr auto regions = SM::instance_size();
+    const auto next = table_t::get();
+    auto i = std::size_t{};
+#if defined(__SSSE3__)
+    if (regions == 1 && table_t::size <= 16) {
+      i = broadcast_simd(event, next, table_t::size);
+    }
+#endif
+    for (; i < size_; ++i) {
+      const auto states = &states_[i * regions];
+      auto dispatch = false;
+      for (auto r = 0; r < regions; ++r) {
+        dispatch |= next[states[r]] == detail::dispatch_state;
+      }
+      if (dispatch) {
+        process_event(i, event);
+      } else {
+        for (auto r = 0; r < regions; ++r) {
+          states[r] = next[states[r]];
+        }
+      }
+    }
+  }
+
+#if defined(__SSSE3__)
+  /// looks up 16 (32) next states at a time with pshufb, the table is indexed by the current state ids
+  template <class TEvent>
+  std::size_t broadcast_simd(const TEvent &event, const aux::byte *next, const std::size_t size) {
+    alignas(16) aux::byte lut[16]{};
+    for (auto s = std::size_t{}; s < size; ++s) {
+      lut[s] = next[s];
+    }
+    const auto table = _mm_load_si128(reinterpret_cast<const __m128i *>(lut));
+    auto i = std::size_t{};
+#if defined(__AVX2__)
+    const auto table256 = _mm256_broadcastsi128_si256(table);
+    const auto dispatch256 = _mm256_set1_epi8(-1);
+    for (; i + 32 <= size_; i += 32) {
+      const auto states = reinterpret_cast<__m256i *>(&states_[i]);
+      const auto current = _mm256_loadu_si256(states);
+      const auto next_states = _mm256_shuffle_epi8(table256, current);
+      const auto dispatch = _mm256_cmpeq_epi8(next_states, dispatch256);
+      _mm256_storeu_si256(states, _mm256_blendv_epi8(next_states, current, dispatch));
+      for (auto mask = static_cast<unsigned>(_mm256_movemask_epi8(dispatch)); mask; mask &= mask - 1) {
+        process_event(i + __builtin_ctz(mask), event);
+      }
+    }
+#endif
+    const auto dispatch128 = _mm_set1_epi8(-1);
+    for (; i + 16 <= size_; i += 16) {
+      const auto states = reinterpret_cast<__m128i *>(&states_[i]);
+      const auto current = _mm_loadu_si128(states);
+      const auto next_states = _mm_shuffle_epi8(table, current);
+      const auto dispatch = _mm_cmpeq_epi8(next_states, dispatch128);
+      _mm_storeu_si128(states, _mm_or_si128(_mm_andnot_si128(dispatch, next_states), _mm_and_si128(dispatch, current)));
+      for (auto mask = static_cast<unsigned>(_mm_movemask_epi8(dispatch)); mask; mask &= mask - 1) {
+        process_event(i + __builtin_ctz(mask), event);
+      }
+    }
+    return i;
+  }
+#endif
+
+  SM &load(const std::size_t i) const {
+    sm_->load_instance(&states_[i * SM::instance_size()]);
+    return *sm_;
+  }
+
+  std::unique_ptr<SM> sm_;
+  aux::byte initial_[SM::instance_size()]{};
+  std::vector<aux::byte> states_{};
+  detail::deferred_column<typename SM::deferred_t> deferred_{};
+  std::size_t size_ = 0;
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
@@ -0,0 +1,217 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_IPC_CHANNEL_HPP
+#define BOOST_SML_UTILITY_IPC_CHANNEL_HPP
+
+#include <linux/futex.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "boost/sml.hpp"
+#include "boost/sml/utility/shared_fleet.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+namespace detail {
+template <class... Ts>
+using trivially_copyable_t =
+    aux::join_t<aux::conditional_t<std::is_trivially_copyable<Ts>::value, aux::type_list<Ts>, aux::type_list<>>...>;
+
+template <class SM, std::size_t Capacity, class = aux::apply_t<trivially_copyable_t, typename SM::events>>
+class ipc_ring;
+
+template <class SM, std::size_t Capacity, class... TEvents>
+class ipc_ring<SM, Capacity, aux::type_list<TEvents...>> {
+  static_assert(Capacity && !(Capacity & (Capacity - 1)), "capacity has to be a power of 2");
+
+  using ids_t = aux::type_id<TEvents...>;
+  static constexpr std::uint64_t magic = 0x736d6c2d69706331ull;
+  static constexpr std::uint32_t ready = 2;
+
+  /// event encoded like back::queue_event (id of the event type in the list and the event bytes)
+  struct slot {
+    int id;
+    alignas(aux::max<alignof(TEvents)...>()) aux::byte data[aux::max<sizeof(TEvents)...>()];
+  };
+
+  struct control {
+    std::uint64_t magic;
+    std::uint64_t layout;
+    std::uint32_t status;
+    alignas(64) std::uint64_t tail;  /// written by the producer
+    std::uint32_t producer_waiting;  /// the ring was full
+    alignas(64) std::uint64_t head;  /// written by the consumer
+    std::uint32_t consumer_waiting;  /// the ring was empty
+    alignas(64) slot slots[Capacity];
+  };
+
+  static std::uint64_t layout() {
+    std::uint64_t layout = Capacity ^ sizeof(slot) << 32;
+    (void)aux::swallow{0, (layout = layout * 1099511628211ull ^ sizeof(TEvents), 0)...};
+    return layout;
+  }
+
+  template <class TEvent>
+  static bool dispatch_impl(SM &sm, const aux::byte *data) {
+    return sm.process_event(*reinterpret_cast<const TEvent *>(data));
+  }
+
+  static void wake(std::uint32_t *waiting) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiting, __ATOMIC_RELAXED) && __atomic_exchange_n(waiting, 0u, __ATOMIC_RELAXED)) {
+      detail::futex(waiting, FUTEX_WAKE, 1);
+    }
+  }
+
+  /// the other side publishes its index before checking the flag (wake), so either the index or the flag is seen
+  template <class TPred>
+  static void sleep(std::uint32_t *waiting, const TPred &ready, const int timeout_ms) {
+    __atomic_store_n(waiting, 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!ready()) {
+      futex_wait(waiting, 1u, timeout_ms);
+    }
+    __atomic_store_n(waiting, 0u, __ATOMIC_RELAXED);
+  }
+
+ public:
+  using events = aux::type_list<TEvents...>;
+
+  static constexpr std::size_t segment_size() { return sizeof(control); }
+
+  ipc_ring(void *segment, const std::size_t bytes) {
+    if (!segment || bytes < sizeof(control)) {
+      return;
+    }
+    auto &c = *static_cast<control *>(segment);
+    if (detail::acquire_segment(&c.status)) {
+      c.magic = magic;
+      c.layout = layout();
+      c.head = c.tail = 0;
+      c.producer_waiting = c.consumer_waiting = 0;
+      detail::release_segment(&c.status, ready);
+    }
+    if (c.magic == magic && c.layout == layout()) {
+      control_ = &c;
+      head_ = __atomic_load_n(&c.head, __ATOMIC_ACQUIRE);
+      tail_ = __atomic_load_n(&c.tail, __ATOMIC_ACQUIRE);
+    }
+  }
+
+  ipc_ring(const ipc_ring &) = delete;
+  ipc_ring &operator=(const ipc_ring &) = delete;
+
+  bool valid() const { return control_ != nullptr; }
+
+  static constexpr std::size_t capacity() { return Capacity; }
+
+  std::size_t size() const {
+    return static_cast<std::size_t>(__atomic_load_n(&control_->tail, __ATOMIC_ACQUIRE) -
+                                    __atomic_load_n(&control_->head, __ATOMIC_ACQUIRE));
+  }
+
+  /// producer, returns false when the ring is full
+  template <class TEvent>
+  bool try_send(const TEvent &event) {
+    static_assert(aux::is_base_of<TEvent, aux::inherit<TEvents...>>::value,
+                  "event has to be a trivially copyable event of the state machine");
+    if (tail_ - head_ == Capacity) {
+      head_ = __atomic_load_n(&control_->head, __ATOMIC_ACQUIRE);
+      if (tail_ - head_ == Capacity) {
+        return false;
+      }
+    }
+    auto &s = control_->slots[tail_ & (Capacity - 1)];
+    s.id = aux::get_id<int, TEvent>((ids_t *)0);
+    std::memcpy(s.data, &event, sizeof(TEvent));
+    __atomic_store_n(&control_->tail, ++tail_, __ATOMIC_RELEASE);
+    wake(&control_->consumer_waiting);
+    return true;
+  }
+
+  /// producer, sleeps while the ring is full
+  template <class TEvent>
+  void send(const TEvent &event) {
+    while (!try_send(event)) {
+      sleep(&control_->producer_waiting, [this] { return __atomic_load_n(&control_->head, __ATOMIC_ACQUIRE) != head_; }, -1);
+    }
+  }
+
+  /// consumer, processes up to `max` events by `sm`, the slots are released at once after the batch
+  /// slots with an unknown event id (written by a faulty producer) are released without being processed
+  std::size_t poll(SM &sm, const std::size_t max = Capacity) {
+    using dispatch_t = bool (*)(SM &, const aux::byte *);
+    const static dispatch_t dispatch[] = {&ipc_ring::dispatch_impl<TEvents>...};
+
+    if (tail_ - head_ < max) {
+      tail_ = __atomic_load_n(&control_->tail, __ATOMIC_ACQUIRE);
+    }
+    auto head = head_;
+    for (; head != tail_ && head - head_ < max; ++head) {
+      const auto &s = control_->slots[head & (Capacity - 1)];
+      const auto id = static_cast<unsigned>(s.id);
+      if (id < sizeof...(TEvents)) {
+        dispatch[id](sm, s.data);
+      } else {
+        ++dropped_;
+      }
+    }
+    const auto processed = static_cast<std::size_t>(head - head_);
+    if (processed) {
+      __atomic_store_n(&control_->head, head_ = head, __ATOMIC_RELEASE);
+      wake(&control_->producer_waiting);
+    }
+    return processed;
+  }
+
+  /// consumer, number of released slots which had an unknown event id
+  std::size_t dropped() const { return dropped_; }
+
+  /// consumer, sleeps up to `timeout_ms` (-1 - infinitely) while the ring is empty and processes a batch of events
+  std::size_t run_once(SM &sm, const int timeout_ms = -1) {
+    if (const auto processed = poll(sm)) {
+      return processed;
+    }
+    sleep(&control_->consumer_waiting, [this] { return __atomic_load_n(&control_->tail, __ATOMIC_ACQUIRE) != head_; },
+          timeout_ms);
+    return poll(sm);
+  }
+
+ private:
+  control *control_ = nullptr;
+  std::uint64_t head_ = 0;  /// consumer: next slot to process, producer: cached head of the consumer
+  std::uint64_t tail_ = 0;  /// producer: next slot to write, consumer: cached tail of the producer
+  std::size_t dropped_ = 0;
+};
+}  // namespace detail
+
+/// Single producer single consumer channel of events of the state machine between processes
+///   - lock-free ring of `Capacity` events in a shared segment (see utility::shared_segment), events are encoded like
+///     in the queues of the state machine (id of the event type and the event), only trivially copyable events of
+///     `SM::events` can be sent
+///   - the consumer processes events in batches (`poll`, `run_once`) and releases their slots at once, a side which
+///     has to wait (empty/full ring) sleeps on a futex and it's woken up by the other one
+///   - the first side to attach initializes the segment, each side has to be used by a single thread
+///
+///   using channel_t = sml::utility::ipc_channel<sml::sm<protocol>>;
+///   sml::utility::shared_segment segment{fd, channel_t::segment_size()};
+///   channel_t channel{segment.data(), segment.size()};
+///   channel.send(packet{...});      // capture process
+///   channel.run_once(protocol_sm);  // protocol process
+template <class SM, std::size_t Capacity = 4096>
+using ipc_channel = detail::ipc_ring<SM, Capacity>;
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
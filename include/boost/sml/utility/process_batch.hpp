@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_PROCESS_BATCH_HPP
+#define BOOST_SML_UTILITY_PROCESS_BATCH_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+namespace detail {
+constexpr std::size_t prefetch_distance = 16;
+
+inline void prefetch(const void *ptr) {
+#if defined(__GNUC__)
+  __builtin_prefetch(ptr);
+#else
+  (void)ptr;
+#endif
+}
+
+/// groups the batch by the current states of the instances (stable counting sort, so that events of the same instance
+/// keep their order) and processes each group with the handler resolved for its state, instances are prefetched
+/// `prefetch_distance` events ahead in both passes
+template <class SM, class TIt, class TOut, class TAddressOf, class TStateOf, class TProcess>
+void process_batch(const TIt first, const TIt last, TOut handled, const TAddressOf &address_of, const TStateOf &state_of,
+                   const TProcess &process) {
+  using event_t = aux::remove_const_t<aux::remove_reference_t<decltype(first->second)>>;
+  const auto handlers = SM::template state_handlers<event_t>();
+  const auto size = static_cast<std::size_t>(last - first);
+  /// buffers are reused between batches, so that large batches don't page fault on fresh allocations,
+  /// they are moved out for the duration of the batch in case an action processes another one
+  static thread_local std::vector<int> states_buffer{};
+  static thread_local std::vector<std::size_t> order_buffer{};
+  auto states = static_cast<std::vector<int> &&>(states_buffer);
+  auto order = static_cast<std::vector<std::size_t> &&>(order_buffer);
+  states.resize(size);
+  order.resize(size);
+  std::size_t offsets[aux::size<typename SM::states>::value + 1]{};
+  for (auto i = std::size_t{}; i < size; ++i) {
+    if (i + prefetch_distance < size) {
+      prefetch(address_of(first[i + prefetch_distance].first));
+    }
+    states[i] = state_of(first[i].first);
+    ++offsets[states[i] + 1];
+  }
+  for (auto s = std::size_t{1}; s <= aux::size<typename SM::states>::value; ++s) {
+    offsets[s] += offsets[s - 1];
+  }
+  for (auto i = std::size_t{}; i < size; ++i) {
+    order[offsets[states[i]]++] = i;
+  }
+  for (auto s = std::size_t{}, i = std::size_t{}; s < aux::size<typename SM::states>::value; ++s) {
+    const auto handler = handlers[s];
+    for (; i < offsets[s]; ++i) {
+      if (i + prefetch_distance < size) {
+        prefetch(address_of(first[order[i + prefetch_distance]].first));
+      }
+      const auto &pair = first[order[i]];
+      handled[order[i]] = process(pair.first, handler, pair.second);
+    }
+  }
+  states_buffer = static_cast<std::vector<int> &&>(states);
+  order_buffer = static_cast<std::vector<std::size_t> &&>(order);
+}
+}  // namespace detail
+
+/// Processes (instance, event) pairs by `sms[instance]`, grouped by the current state of the instances,
+/// so that each group is processed by a single handler in a tight loop with a predictable branch
+/// `handled[i]` is set to the result of processing the i-th pair
+///
+///   std::vector<std::pair<std::size_t, tick>> batch{{0, tick{}}, {42, tick{}}};
+///   bool handled[2];
+///   sml::utility::process_batch(sms.data(), batch.begin(), batch.end(), handled);
+template <class SM, class TIt, class TOut>
+void process_batch(SM *sms, const TIt first, const TIt last, TOut handled) {
+  detail::process_batch<SM>(
+      first, last, handled, [sms](const std::size_t i) { return &sms[i]; },
+      [sms](const std::size_t i) { return sms[i].current_state_id(); },
+      [sms](const std::size_t i, const auto handler, const auto &event) { return handler(sms[i], event); });
+}
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
@@ -0,0 +1,427 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_REACTOR_HPP
+#define BOOST_SML_UTILITY_REACTOR_HPP
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// clang-format off
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#if defined(IORING_FEAT_EXT_ARG)
+#define BOOST_SML_REACTOR_IO_URING 1
+#endif
+#endif
+// clang-format on
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+enum class reactor_backend { automatic, io_uring, epoll, none };
+
+struct reactor_options {
+  reactor_backend backend = reactor_backend::automatic;  /// io_uring when supported by the kernel, epoll otherwise
+  std::size_t batch = 64;                                /// completions dispatched per wait
+};
+
+namespace detail {
+
+struct reactor_completion {
+  std::uint64_t user_data;
+  unsigned events;
+};
+
+class epoll_backend {
+ public:
+  bool open() {
+    fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    return fd_ >= 0;
+  }
+
+  ~epoll_backend() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  bool add(const int fd, const unsigned events, const std::uint64_t user_data) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = user_data;
+    return !::epoll_ctl(fd_, EPOLL_CTL_ADD, fd, &event);
+  }
+
+  void rearm(const int, const unsigned, const std::uint64_t) {}
+
+  void remove(const int fd, const std::uint64_t) { ::epoll_ctl(fd_, EPOLL_CTL_DEL, fd, nullptr); }
+
+  std::size_t wait(std::vector<reactor_completion> &completions, const int timeout_ms) {
+    events_.resize(completions.size());
+    const auto n = ::epoll_wait(fd_, events_.data(), static_cast<int>(events_.size()), timeout_ms);
+    for (auto i = 0; i < n; ++i) {
+      completions[i] = reactor_completion{events_[i].data.u64, events_[i].events};
+    }
+    return n > 0 ? static_cast<std::size_t>(n) : 0u;
+  }
+
+ private:
+  int fd_ = -1;
+  std::vector<epoll_event> events_{};
+};
+
+#if defined(BOOST_SML_REACTOR_IO_URING)
+/// one-shot poll requests, re-armed after their completion is dispatched (level-triggered as epoll), requests are
+/// submitted together with the next wait, so that a batch of completions costs a single `io_uring_enter`
+class io_uring_backend {
+  static constexpr std::uint64_t cancel_user_data = ~std::uint64_t{0};
+
+ public:
+  bool open(const std::size_t entries) {
+    io_uring_params params{};
+    fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(entries), &params));
+    if (fd_ < 0) {
+      return false;
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+      return false;
+    }
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = sq_size_ > cq_size_ ? sq_size_ : cq_size_;
+    }
+    sq_ = map(sq_size_, IORING_OFF_SQ_RING);
+    cq_ = single_mmap ? sq_ : map(cq_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(map(sqes_size_, IORING_OFF_SQES));
+    if (!sq_ || !cq_ || !sqes_) {
+      return false;
+    }
+    sq_head_ = ring<unsigned>(sq_, params.sq_off.head);
+    sq_tail_ = ring<unsigned>(sq_, params.sq_off.tail);
+    sq_mask_ = *ring<unsigned>(sq_, params.sq_off.ring_mask);
+    sq_array_ = ring<unsigned>(sq_, params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+    cq_head_ = ring<unsigned>(cq_, params.cq_off.head);
+    cq_tail_ = ring<unsigned>(cq_, params.cq_off.tail);
+    cq_mask_ = *ring<unsigned>(cq_, params.cq_off.ring_mask);
+    cqes_ = ring<io_uring_cqe>(cq_, params.cq_off.cqes);
+    return true;
+  }
+
+  ~io_uring_backend() {
+    if (sqes_) {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ && cq_ != sq_) {
+      ::munmap(cq_, cq_size_);
+    }
+    if (sq_) {
+      ::munmap(sq_, sq_size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  bool add(const int fd, const unsigned events, const std::uint64_t user_data) {
+    rearm(fd, events, user_data);
+    return true;
+  }
+
+  void rearm(const int fd, const unsigned events, const std::uint64_t user_data) {
+    auto &sqe = next_sqe();
+    sqe.opcode = IORING_OP_POLL_ADD;
+    sqe.fd = fd;
+    sqe.poll32_events = events;
+    sqe.user_data = user_data;
+    push_sqe();
+  }
+
+  void remove(const int, const std::uint64_t user_data) {
+    auto &sqe = next_sqe();
+    sqe.opcode = IORING_OP_POLL_REMOVE;
+    sqe.fd = -1;
+    sqe.addr = user_data;
+    sqe.user_data = cancel_user_data;
+    push_sqe();
+  }
+
+  std::size_t wait(std::vector<reactor_completion> &completions, const int timeout_ms) {
+    if (!ready()) {
+      io_uring_getevents_arg arg{};
+      __kernel_timespec ts{};
+      if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000ll;
+        arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+      }
+      enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    } else if (pending()) {
+      enter(0, 0, nullptr, 0);
+    }
+    std::size_t n = 0;
+    auto head = *cq_head_;
+    const auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail && n < completions.size(); ++head) {
+      const auto &cqe = cqes_[head & cq_mask_];
+      if (cqe.user_data != cancel_user_data) {
+        completions[n++] = reactor_completion{cqe.user_data, cqe.res < 0 ? unsigned(POLLERR) : unsigned(cqe.res)};
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return n;
+  }
+
+ private:
+  template <class T>
+  static T *ring(void *base, const unsigned offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+  }
+
+  void *map(const std::size_t size, const long long offset) const {
+    const auto ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  bool ready() const { return *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE); }
+
+  unsigned pending() const { return tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE); }
+
+  void enter(const unsigned min_complete, const unsigned flags, void *arg, const std::size_t size) {
+    while (::syscall(__NR_io_uring_enter, fd_, pending(), min_complete, flags, arg, size) < 0 && errno == EINTR) {
+    }
+  }
+
+  io_uring_sqe &next_sqe() {
+    if (pending() == sq_entries_) {
+      enter(0, 0, nullptr, 0);
+    }
+    auto &sqe = sqes_[tail_ & sq_mask_];
+    std::memset(&sqe, 0, sizeof(sqe));
+    return sqe;
+  }
+
+  void push_sqe() {
+    sq_array_[tail_ & sq_mask_] = tail_ & sq_mask_;
+    __atomic_store_n(sq_tail_, ++tail_, __ATOMIC_RELEASE);
+  }
+
+  int fd_ = -1;
+  void *sq_ = nullptr;
+  void *cq_ = nullptr;
+  io_uring_sqe *sqes_ = nullptr;
+  std::size_t sq_size_ = 0;
+  std::size_t cq_size_ = 0;
+  std::size_t sqes_size_ = 0;
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned tail_ = 0;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe *cqes_ = nullptr;
+};
+#endif
+
+}  // namespace detail
+
+/// Turns readiness of file descriptors into events of the state machines they are registered with
+///   - `add<Readable, Writable, Hangup>(fd, sm)` maps the readiness to event types at compile time, an event is
+///     constructed with `Event{fd}` and processed by `sm` (`void` - not watched)
+///   - readiness is level-triggered, handlers have to consume the data/space or `remove` the descriptor
+///   - io_uring (one-shot polls re-armed after dispatch and submitted together with the next wait) when available,
+///     epoll otherwise, `run_once` dispatches up to `batch` completions per system call
+///   - descriptors have to be removed before they are closed, state machines have to outlive their registration
+///   - not thread safe, `add/remove` can be called by the handlers
+///
+///   sml::utility::reactor reactor{};
+///   reactor.add<data_ready, sml::utility::reactor::none, peer_closed>(fd, session);
+///   for (;;) {
+///     reactor.run_once();
+///   }
+class reactor {
+  using handler_t = void (*)(void *, int);
+
+  struct registration {
+    void *sm = nullptr;
+    handler_t readable = nullptr;
+    handler_t writable = nullptr;
+    handler_t hangup = nullptr;
+    unsigned events = 0;
+    std::uint32_t generation = 0;
+  };
+
+  template <class SM, class TEvent>
+  static void process(void *sm, const int fd) {
+    static_cast<SM *>(sm)->process_event(TEvent{fd});
+  }
+
+  template <class SM, class TEvent>
+  static constexpr handler_t handler(const aux::type<TEvent> &) {
+    return &reactor::process<SM, TEvent>;
+  }
+
+  template <class SM>
+  static constexpr handler_t handler(const aux::type<void> &) {
+    return nullptr;
+  }
+
+  static std::uint64_t user_data(const int fd, const std::uint32_t generation) {
+    return std::uint64_t(generation) << 32 | static_cast<std::uint32_t>(fd);
+  }
+
+  template <class F>
+  auto call(const F &f) {
+#if defined(BOOST_SML_REACTOR_IO_URING)
+    if (backend_ == reactor_backend::io_uring) {
+      return f(io_uring_);
+    }
+#endif
+    return f(epoll_);
+  }
+
+ public:
+  using none = void;
+
+  explicit reactor(const reactor_options &options = {}) : completions_(options.batch ? options.batch : 1) {
+#if defined(BOOST_SML_REACTOR_IO_URING)
+    if (options.backend != reactor_backend::epoll && io_uring_.open(completions_.size() * 2)) {
+      backend_ = reactor_backend::io_uring;
+      return;
+    }
+    if (options.backend == reactor_backend::io_uring) {
+      return;
+    }
+#else
+    if (options.backend == reactor_backend::io_uring) {
+      return;
+    }
+#endif
+    if (epoll_.open()) {
+      backend_ = reactor_backend::epoll;
+    }
+  }
+
+  reactor(const reactor &) = delete;
+  reactor &operator=(const reactor &) = delete;
+
+  /// backend in use, `none` when the requested one isn't available
+  reactor_backend backend() const { return backend_; }
+
+  std::size_t size() const { return size_; }
+
+  template <class TReadable, class TWritable = none, class THangup = none, class SM>
+  bool add(const int fd, SM &sm) {
+    if (fd < 0 || backend_ == reactor_backend::none) {
+      return false;
+    }
+    if (static_cast<std::size_t>(fd) >= registrations_.size()) {
+      registrations_.resize(fd + 1);
+    }
+    auto &r = registrations_[fd];
+    if (r.sm) {
+      return false;
+    }
+    r.readable = handler<SM>(aux::type<TReadable>{});
+    r.writable = handler<SM>(aux::type<TWritable>{});
+    r.hangup = handler<SM>(aux::type<THangup>{});
+    r.events = (r.readable ? unsigned(POLLIN) : 0u) | (r.writable ? unsigned(POLLOUT) : 0u) |
+               (r.hangup ? unsigned(POLLRDHUP) : 0u);
+    if (!call([&](auto &backend) { return backend.add(fd, r.events, user_data(fd, r.generation)); })) {
+      return false;
+    }
+    r.sm = &sm;
+    ++size_;
+    return true;
+  }
+
+  bool remove(const int fd) {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= registrations_.size() || !registrations_[fd].sm) {
+      return false;
+    }
+    auto &r = registrations_[fd];
+    call([&](auto &backend) {
+      backend.remove(fd, user_data(fd, r.generation));
+      return true;
+    });
+    r.sm = nullptr;
+    ++r.generation;
+    --size_;
+    return true;
+  }
+
+  /// waits up to `timeout_ms` (-1 - infinitely, 0 - doesn't block) for readiness and dispatches a batch of it,
+  /// returns the number of processed events
+  std::size_t run_once(const int timeout_ms = -1) {
+    if (!size_) {
+      return 0;
+    }
+    const auto n = call([&](auto &backend) { return backend.wait(completions_, timeout_ms); });
+    std::size_t processed = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto fd = static_cast<int>(completions_[i].user_data & 0xffffffffu);
+      const auto generation = static_cast<std::uint32_t>(completions_[i].user_data >> 32);
+      const auto events = completions_[i].events;
+      const auto registered = [&] {
+        return static_cast<std::size_t>(fd) < registrations_.size() && registrations_[fd].sm &&
+               registrations_[fd].generation == generation;
+      };
+      if (registered() && (events & POLLIN) && registrations_[fd].readable) {
+        registrations_[fd].readable(registrations_[fd].sm, fd);
+        ++processed;
+      }
+      if (registered() && (events & POLLOUT) && registrations_[fd].writable) {
+        registrations_[fd].writable(registrations_[fd].sm, fd);
+        ++processed;
+      }
+      if (registered() && (events & (POLLHUP | POLLERR | POLLRDHUP)) && registrations_[fd].hangup) {
+        registrations_[fd].hangup(registrations_[fd].sm, fd);
+        ++processed;
+      }
+      if (registered()) {
+        call([&](auto &backend) {
+          backend.rearm(fd, registrations_[fd].events, user_data(fd, generation));
+          return true;
+        });
+      }
+    }
+    return processed;
+  }
+
+ private:
+  std::vector<detail::reactor_completion> completions_;
+  std::vector<registration> registrations_{};
+  std::size_t size_ = 0;
+  reactor_backend backend_ = reactor_backend::none;
+  detail::epoll_backend epoll_{};
+#if defined(BOOST_SML_REACTOR_IO_URING)
+  detail::io_uring_backend io_uring_{};
+#endif
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
@@ -0,0 +1,278 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_SESSION_TABLE_HPP
+#define BOOST_SML_UTILITY_SESSION_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+/// Open addressing map from a session key to state machines stored inline in the table
+///   - linear probing over one control byte per slot (empty/deleted or 7 bits of the hash)
+///   - sessions whose regions all reach the terminate state (`sml::X`) are destroyed by `dispatch`
+///   - SM has to be move constructible for the table to grow, `reserve` up front otherwise
+///
+///   sml::utility::session_table<sml::sm<session>, std::uint64_t> sessions{};
+///   sessions.emplace(id, deps...);
+///   sessions.dispatch(id, event);
+template <class SM, class Key, class THash = std::hash<Key>, class TKeyEqual = std::equal_to<Key>>
+class session_table {
+  static_assert(!SM::has_timeouts::value, "`after` transitions aren't supported, moving sessions would drop their timers");
+
+  static constexpr std::uint8_t empty_slot = 0x80;
+  static constexpr std::uint8_t deleted_slot = 0xfe;
+  static constexpr std::size_t prefetch_distance = 8;
+
+  struct slot {
+    Key key;
+    alignas(SM) unsigned char storage[sizeof(SM)];
+  };
+
+  static void prefetch(const void *ptr) {
+#if defined(__GNUC__)
+    __builtin_prefetch(ptr);
+#else
+    (void)ptr;
+#endif
+  }
+
+ public:
+  explicit session_table(const std::size_t capacity = 0, const THash &hash = {}, const TKeyEqual &equal = {})
+      : hash_(hash), equal_(equal) {
+    rehash(capacity_for(capacity));
+  }
+
+  session_table(const session_table &) = delete;
+  session_table &operator=(const session_table &) = delete;
+
+  ~session_table() { clear(); }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return !size_; }
+  std::size_t capacity() const { return mask_ + 1; }
+
+  /// makes room for `size` sessions without further rehashing
+  void reserve(const std::size_t size) {
+    if (capacity_for(size) > capacity()) {
+      rehash(capacity_for(size));
+    }
+  }
+
+  /// returns the session for the key, creates it from `deps` if there is none
+  template <class... TDeps>
+  SM &emplace(const Key &key, TDeps &&... deps) {
+    const auto hash = mix(key);
+    if (const auto sm = find(key, hash)) {
+      return *sm;
+    }
+    if ((size_ + deleted_ + 1) * 8 > capacity() * 7) {
+      rehash((size_ + 1) * 2 > capacity() ? capacity() * 2 : capacity());
+    }
+    auto i = index(hash);
+    while (control_[i] != empty_slot && control_[i] != deleted_slot) {
+      i = (i + 1) & mask_;
+    }
+    auto sm = new (slots_[i].storage) SM(static_cast<TDeps &&>(deps)...);
+    deleted_ -= control_[i] == deleted_slot;
+    slots_[i].key = key;
+    control_[i] = tag(hash);
+    ++size_;
+    return *sm;
+  }
+
+  SM *find(const Key &key) { return find(key, mix(key)); }
+
+  bool erase(const Key &key) {
+    const auto i = lookup(key, mix(key));
+    if (i > mask_) {
+      return false;
+    }
+    erase_at(i);
+    return true;
+  }
+
+  /// processes the event by the session with given key, returns false when there is no such session
+  template <class TEvent>
+  bool dispatch(const Key &key, const TEvent &event) {
+    return dispatch_at(lookup(key, mix(key)), event);
+  }
+
+  /// processes the event by the session with given key, which is created by `create(*this, key)` first when missing
+  template <class TEvent, class TCreate>
+  bool dispatch_or_create(const Key &key, const TEvent &event, const TCreate &create) {
+    const auto hash = mix(key);
+    auto i = lookup(key, hash);
+    if (i > mask_) {
+      create(*this, key);
+      i = lookup(key, hash);
+    }
+    return dispatch_at(i, event);
+  }
+
+  /// dispatches `events[i]` to `keys[i]` for the whole range, hashing and prefetching the slots
+  /// `prefetch_distance` events ahead so that lookups overlap with processing
+  /// returns the number of handled events
+  template <class TKeyIt, class TEventIt>
+  std::size_t dispatch(TKeyIt first, const TKeyIt last, TEventIt events) {
+    std::uint64_t hashes[prefetch_distance]{};
+    auto ahead = first;
+    auto n = std::size_t{};
+    for (; n < prefetch_distance && ahead != last; ++n, ++ahead) {
+      hashes[n] = prefetch_key(*ahead);
+    }
+    auto handled = std::size_t{};
+    for (auto i = std::size_t{}; first != last; ++first, ++events, ++i) {
+      const auto hash = hashes[i % prefetch_distance];
+      if (ahead != last) {
+        hashes[i % prefetch_distance] = prefetch_key(*ahead);
+        ++ahead;
+      }
+      handled += dispatch_at(lookup(*first, hash), *events);
+    }
+    return handled;
+  }
+
+  void clear() {
+    for (auto i = std::size_t{}; size_ && i <= mask_; ++i) {
+      if (!(control_[i] & empty_slot)) {
+        erase_at(i);
+      }
+    }
+    for (auto i = std::size_t{}; i <= mask_; ++i) {
+      control_[i] = empty_slot;
+    }
+    deleted_ = 0;
+  }
+
+ private:
+  static std::size_t capacity_for(const std::size_t size) {
+    auto capacity = std::size_t{8};
+    while (capacity * 7 < size * 8) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  /// std::hash is the identity for integers, fibonacci hashing spreads sequential ids over the table
+  std::uint64_t mix(const Key &key) const { return static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ull; }
+  std::size_t index(const std::uint64_t hash) const { return static_cast<std::size_t>(hash >> shift_); }
+  static std::uint8_t tag(const std::uint64_t hash) { return static_cast<std::uint8_t>(hash & 0x7f); }
+
+  std::uint64_t prefetch_key(const Key &key) const {
+    const auto hash = mix(key);
+    prefetch(&control_[index(hash)]);
+    prefetch(&slots_[index(hash)]);
+    return hash;
+  }
+
+  std::size_t lookup(const Key &key, const std::uint64_t hash) const {
+    const auto t = tag(hash);
+    for (auto i = index(hash);; i = (i + 1) & mask_) {
+      if (control_[i] == t && equal_(slots_[i].key, key)) {
+        return i;
+      }
+      if (control_[i] == empty_slot) {
+        return mask_ + 1;
+      }
+    }
+  }
+
+  SM *find(const Key &key, const std::uint64_t hash) {
+    const auto i = lookup(key, hash);
+    return i > mask_ ? nullptr : at(i);
+  }
+
+  SM *at(const std::size_t i) { return reinterpret_cast<SM *>(slots_[i].storage); }
+
+  template <class TEvent>
+  bool dispatch_at(const std::size_t i, const TEvent &event) {
+    if (i > mask_) {
+      return false;
+    }
+    auto &sm = *at(i);
+    const auto handled = sm.process_event(event);
+    if (terminated(sm)) {
+      erase_at(i);
+    }
+    return handled;
+  }
+
+  /// `is(X)` is true as soon as any region is terminated, whereas a session is reclaimed once all of them are
+  static bool terminated(const SM &sm) {
+    auto terminated = true;
+    sm.visit_current_states([&](const auto state) {
+      terminated &= aux::is_same<typename decltype(state)::type, typename decltype(X)::type>::value;
+    });
+    return terminated;
+  }
+
+  void erase_at(const std::size_t i) {
+    at(i)->~SM();
+    --size_;
+    if (control_[(i + 1) & mask_] == empty_slot) {
+      control_[i] = empty_slot;
+    } else {
+      control_[i] = deleted_slot;
+      ++deleted_;
+    }
+  }
+
+  void rehash(const std::size_t capacity) {
+    auto control = static_cast<std::unique_ptr<std::uint8_t[]> &&>(control_);
+    auto slots = static_cast<std::unique_ptr<slot[]> &&>(slots_);
+    const auto size = control ? mask_ + 1 : 0;
+    control_.reset(new std::uint8_t[capacity]);
+    slots_.reset(new slot[capacity]);
+    mask_ = capacity - 1;
+    shift_ = 64;
+    for (auto c = capacity; c > 1; c >>= 1) {
+      --shift_;
+    }
+    for (auto i = std::size_t{}; i < capacity; ++i) {
+      control_[i] = empty_slot;
+    }
+    deleted_ = 0;
+    for (auto i = std::size_t{}; i < size; ++i) {
+      if (control[i] & empty_slot) {
+        continue;
+      }
+      auto &from = *reinterpret_cast<SM *>(slots[i].storage);
+      const auto hash = mix(slots[i].key);
+      auto j = index(hash);
+      while (control_[j] != empty_slot) {
+        j = (j + 1) & mask_;
+      }
+      new (slots_[j].storage) SM(static_cast<SM &&>(from));
+      from.~SM();
+      slots_[j].key = slots[i].key;
+      control_[j] = tag(hash);
+    }
+  }
+
+  THash hash_;
+  TKeyEqual equal_;
+  std::unique_ptr<std::uint8_t[]> control_{};
+  std::unique_ptr<slot[]> slots_{};
+  std::size_t mask_ = 0;
+  unsigned shift_ = 64;
+  std::size_t size_ = 0;
+  std::size_t deleted_ = 0;
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
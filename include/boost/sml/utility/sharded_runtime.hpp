@@ -0,0 +1,491 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_SHARDED_RUNTIME_HPP
+#define BOOST_SML_UTILITY_SHARDED_RUNTIME_HPP
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/sml.hpp"
+#include "boost/sml/utility/session_table.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+struct sharded_runtime_options {
+  std::size_t shards_per_node = 1;
+  std::size_t channel_capacity = 1024;  /// events in flight per pair of shards
+  std::size_t sessions_per_shard = 0;   /// sessions reserved up front
+  std::size_t batch = 64;               /// events processed from one channel before moving to the next one
+  std::size_t max_nodes = 0;            /// 0 - all detected nodes
+};
+
+namespace detail {
+
+/// parses the sysfs list format, for example "0-3,8,10-11"
+inline std::vector<int> parse_cpu_list(const std::string &list) {
+  std::vector<int> cpus{};
+  std::size_t i = 0;
+  const auto number = [&] {
+    auto n = 0;
+    for (; i < list.size() && list[i] >= '0' && list[i] <= '9'; ++i) {
+      n = n * 10 + (list[i] - '0');
+    }
+    return n;
+  };
+  while (i < list.size() && list[i] >= '0' && list[i] <= '9') {
+    const auto first = number();
+    auto last = first;
+    if (i < list.size() && list[i] == '-') {
+      ++i;
+      last = number();
+    }
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+    if (i < list.size() && list[i] == ',') {
+      ++i;
+    }
+  }
+  return cpus;
+}
+
+/// cpus of each NUMA node the process is allowed to run on
+///   - read from sysfs, so that neither libnuma nor its headers are required
+///   - a single node with no cpus (no pinning) when the topology isn't available
+inline std::vector<std::vector<int>> numa_nodes() {
+  std::vector<std::vector<int>> nodes{};
+#if defined(__linux__)
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  const auto restricted = !sched_getaffinity(0, sizeof(allowed), &allowed);
+  std::string online{};
+  std::getline(std::ifstream{"/sys/devices/system/node/online"}, online);
+  for (const auto node : parse_cpu_list(online)) {
+    std::string list{};
+    std::getline(std::ifstream{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"}, list);
+    std::vector<int> cpus{};
+    for (const auto cpu : parse_cpu_list(list)) {
+      if (!restricted || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      nodes.push_back(static_cast<std::vector<int> &&>(cpus));
+    }
+  }
+#endif
+  if (nodes.empty()) {
+    nodes.emplace_back();
+  }
+  return nodes;
+}
+
+/// restricts the calling thread to given cpus, best effort
+inline void pin_thread(const std::vector<int> &cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const auto cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)cpus;
+#endif
+}
+
+/// bounded single-producer/single-consumer ring, slots are reserved and committed in place
+template <class T>
+class spsc_ring {
+  static std::size_t capacity_for(const std::size_t capacity) {
+    auto n = std::size_t{2};
+    while (n < capacity) {
+      n *= 2;
+    }
+    return n;
+  }
+
+ public:
+  explicit spsc_ring(const std::size_t capacity) : mask_(capacity_for(capacity) - 1), slots_(new T[mask_ + 1]) {}
+  spsc_ring(const spsc_ring &) = delete;
+  spsc_ring &operator=(const spsc_ring &) = delete;
+
+  /// producer: returns nullptr when full, the slot is published by `commit`
+  T *reserve() {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) {
+        return nullptr;
+      }
+    }
+    return &slots_[tail & mask_];
+  }
+
+  void commit() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  /// consumer: returns nullptr when empty, the slot is released by `pop`
+  T *front() {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return nullptr;
+      }
+    }
+    return &slots_[head & mask_];
+  }
+
+  void pop() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  bool empty() const { return head_.load() == tail_.load(); }
+
+ private:
+  std::atomic<std::size_t> head_{0};
+  std::size_t tail_cache_ = 0;
+  char consumer_padding_[64 - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];  /// head/tail on separate cache lines
+  std::atomic<std::size_t> tail_{0};
+  std::size_t head_cache_ = 0;
+  char producer_padding_[64 - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+  const std::size_t mask_;
+  std::unique_ptr<T[]> slots_;
+};
+
+}  // namespace detail
+
+/// Partitions state machine sessions by key into shards, each one owned by a single worker thread
+///   - shards are spread over NUMA nodes, workers are pinned to the cpus of their node
+///   - a shard (session table and inbound channels) is allocated by its pinned worker, so that the first touch places
+///     it in node-local memory
+///   - events travel through a bounded SPSC channel per pair of shards (plus one for threads outside the runtime),
+///     events posted by a worker to a full channel are kept in its overflow until there is room, so workers never block
+///   - an event for a key without a session creates one from `deps`, sessions which reach `sml::X` are destroyed
+///   - events are stored inline in channel slots and have to fit in `EventSize` bytes
+///   - without NUMA information (or off Linux) all shards belong to one node and workers are not pinned
+///
+///   sml::utility::sharded_runtime<sml::sm<session>, std::uint64_t> runtime{{}, deps...};
+///   runtime.post(id, connect{});
+///   runtime.wait_idle();
+template <class SM, class Key, std::size_t EventSize = 64, class THash = std::hash<Key>>
+class sharded_runtime {
+  using sessions_t = session_table<SM, Key, THash>;
+
+  struct shard;
+
+  struct message {
+    void (*process)(shard &, message &) = nullptr;
+    void (*relocate)(message &, message &) = nullptr;
+    void (*destroy)(message &) = nullptr;
+    Key key{};
+    alignas(std::max_align_t) unsigned char event[EventSize];
+  };
+
+  struct shard {
+    shard(sharded_runtime &runtime, const std::size_t id)
+        : runtime(runtime), id(id), sessions(runtime.options_.sessions_per_shard), overflow(runtime.shards_.size()) {
+      for (auto i = 0u; i <= runtime.shards_.size(); ++i) {
+        channels.emplace_back(new detail::spsc_ring<message>(runtime.options_.channel_capacity));
+      }
+    }
+
+    sharded_runtime &runtime;
+    const std::size_t id;
+    sessions_t sessions;
+    std::vector<std::unique_ptr<detail::spsc_ring<message>>> channels{};  /// inbound, indexed by the sending shard
+    std::vector<std::deque<message>> overflow;                            /// outbound, indexed by the receiving shard
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex{};
+    std::condition_variable cv{};
+  };
+
+  template <class TEvent>
+  static void process(shard &s, message &m) {
+    auto &event = *reinterpret_cast<TEvent *>(m.event);
+    s.sessions.dispatch_or_create(m.key, event, s.runtime.create_);
+    event.~TEvent();
+  }
+
+  template <class TEvent>
+  static void relocate(message &to, message &from) {
+    to.process = from.process;
+    to.relocate = from.relocate;
+    to.destroy = from.destroy;
+    to.key = from.key;
+    auto &event = *reinterpret_cast<TEvent *>(from.event);
+    new (to.event) TEvent(static_cast<TEvent &&>(event));
+    event.~TEvent();
+  }
+
+  template <class TEvent>
+  static void destroy(message &m) {
+    reinterpret_cast<TEvent *>(m.event)->~TEvent();
+  }
+
+ public:
+  template <class... TDeps>
+  explicit sharded_runtime(const sharded_runtime_options &options, TDeps &... deps)
+      : options_(options),
+        nodes_(detail::numa_nodes()),
+        create_([&deps...](sessions_t &sessions, const Key &key) { sessions.emplace(key, deps...); }) {
+    if (options_.max_nodes && nodes_.size() > options_.max_nodes) {
+      nodes_.resize(options_.max_nodes);
+    }
+    if (!options_.shards_per_node) {
+      options_.shards_per_node = 1;
+    }
+    if (!options_.batch) {
+      options_.batch = 1;
+    }
+    shards_.resize(nodes_.size() * options_.shards_per_node);
+    for (auto i = 0u; i < shards_.size(); ++i) {
+      threads_.emplace_back([this, i] { run(i); });
+    }
+    std::unique_lock<std::mutex> lock{idle_mutex_};
+    idle_cv_.wait(lock, [this] { return ready_ == shards_.size(); });
+  }
+
+  sharded_runtime(const sharded_runtime &) = delete;
+  sharded_runtime &operator=(const sharded_runtime &) = delete;
+
+  ~sharded_runtime() {
+    stop_ = true;
+    for (auto &s : shards_) {
+      { std::lock_guard<std::mutex> lock{s->mutex}; }
+      s->cv.notify_one();
+    }
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+    for (auto &s : shards_) {
+      for (auto &channel : s->channels) {
+        while (const auto m = channel->front()) {
+          m->destroy(*m);
+          channel->pop();
+        }
+      }
+      for (auto &overflow : s->overflow) {
+        for (auto &m : overflow) {
+          m.destroy(m);
+        }
+      }
+    }
+  }
+
+  /// queues the event for the session with given key, may be called from any thread including actions of sessions
+  template <class TEvent>
+  void post(const Key &key, TEvent &&event) {
+    using event_t = aux::remove_const_t<aux::remove_reference_t<TEvent>>;
+    static_assert(sizeof(event_t) <= EventSize, "Event doesn't fit in the channel slot, increase EventSize");
+    static_assert(alignof(event_t) <= alignof(std::max_align_t), "Over-aligned events are not supported");
+    const auto to = shard_of(key);
+    auto &target = *shards_[to];
+    ++pending_;
+    if (const auto from = current() && &current()->runtime == this ? current() : nullptr) {
+      auto &overflow = from->overflow[to];
+      if (const auto m = overflow.empty() ? target.channels[from->id]->reserve() : nullptr) {
+        make_message(*m, key, static_cast<TEvent &&>(event));
+        target.channels[from->id]->commit();
+        wake(target);
+      } else {
+        overflow.emplace_back();
+        make_message(overflow.back(), key, static_cast<TEvent &&>(event));
+      }
+    } else {
+      std::lock_guard<std::mutex> lock{post_mutex_};
+      auto &channel = *target.channels[shards_.size()];
+      message *m = nullptr;
+      while (!(m = channel.reserve())) {
+        std::this_thread::yield();
+      }
+      make_message(*m, key, static_cast<TEvent &&>(event));
+      channel.commit();
+      wake(target);
+    }
+  }
+
+  /// blocks until all posted events have been processed
+  void wait_idle() {
+    std::unique_lock<std::mutex> lock{idle_mutex_};
+    idle_cv_.wait(lock, [this] { return !pending_.load(); });
+  }
+
+  std::size_t nodes() const { return nodes_.size(); }
+  std::size_t shards() const { return shards_.size(); }
+  std::size_t node_of_shard(const std::size_t shard) const { return shard / options_.shards_per_node; }
+  /// cpus the worker of the shard is pinned to, empty when it isn't pinned
+  const std::vector<int> &cpus(const std::size_t shard) const { return nodes_[node_of_shard(shard)]; }
+
+  std::size_t shard_of(const Key &key) const {
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ull) >> 32) %
+           shards_.size();
+  }
+
+  /// only safe to use while idle, for example after `wait_idle`
+  SM *find(const Key &key) { return shards_[shard_of(key)]->sessions.find(key); }
+
+  /// number of live sessions, only safe to use while idle
+  std::size_t sessions() const {
+    auto size = std::size_t{};
+    for (const auto &s : shards_) {
+      size += s->sessions.size();
+    }
+    return size;
+  }
+
+ private:
+  template <class TEvent>
+  void make_message(message &m, const Key &key, TEvent &&event) {
+    using event_t = aux::remove_const_t<aux::remove_reference_t<TEvent>>;
+    m.process = &sharded_runtime::process<event_t>;
+    m.relocate = &sharded_runtime::relocate<event_t>;
+    m.destroy = &sharded_runtime::destroy<event_t>;
+    m.key = key;
+    new (m.event) event_t(static_cast<TEvent &&>(event));
+  }
+
+  void wake(shard &s) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (s.sleeping.load(std::memory_order_relaxed)) {
+      { std::lock_guard<std::mutex> lock{s.mutex}; }
+      s.cv.notify_one();
+    }
+  }
+
+  void done(const std::size_t n) {
+    if (n && !(pending_ -= n)) {
+      { std::lock_guard<std::mutex> lock{idle_mutex_}; }
+      idle_cv_.notify_all();
+    }
+  }
+
+  /// moves overflowed events to the channels which have room, returns true when nothing is left behind
+  bool flush(shard &s) {
+    auto flushed = true;
+    for (auto to = 0u; to < s.overflow.size(); ++to) {
+      auto &overflow = s.overflow[to];
+      if (overflow.empty()) {
+        continue;
+      }
+      auto &target = *shards_[to];
+      auto &channel = *target.channels[s.id];
+      auto moved = false;
+      while (!overflow.empty()) {
+        const auto m = channel.reserve();
+        if (!m) {
+          flushed = false;
+          break;
+        }
+        overflow.front().relocate(*m, overflow.front());
+        overflow.pop_front();
+        channel.commit();
+        moved = true;
+      }
+      if (moved) {
+        wake(target);
+      }
+    }
+    return flushed;
+  }
+
+  std::size_t drain(shard &s) {
+    auto processed = std::size_t{};
+    for (auto &channel : s.channels) {
+      auto n = std::size_t{};
+      for (message *m = nullptr; n < options_.batch && (m = channel->front()); ++n) {
+        m->process(s, *m);
+        channel->pop();
+      }
+      done(n);
+      processed += n;
+    }
+    return processed;
+  }
+
+  bool has_work(const shard &s) const {
+    for (const auto &channel : s.channels) {
+      if (!channel->empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(const std::size_t id) {
+    detail::pin_thread(cpus(id));
+    shards_[id].reset(new shard(*this, id));
+    auto &s = *shards_[id];
+    {
+      std::lock_guard<std::mutex> lock{idle_mutex_};
+      ++ready_;
+    }
+    idle_cv_.notify_all();
+
+    current() = &s;
+    auto spins = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+      const auto flushed = flush(s);
+      if (drain(s)) {
+        spins = 0;
+      } else if (!flushed || ++spins < 64) {
+        std::this_thread::yield();
+      } else {
+        std::unique_lock<std::mutex> lock{s.mutex};
+        s.sleeping = true;
+        s.cv.wait(lock, [&] { return stop_.load() || has_work(s); });
+        s.sleeping = false;
+        spins = 0;
+      }
+    }
+    current() = nullptr;
+  }
+
+  static shard *&current() {
+    static thread_local shard *s = nullptr;
+    return s;
+  }
+
+  sharded_runtime_options options_;
+  std::vector<std::vector<int>> nodes_;
+  std::function<void(sessions_t &, const Key &)> create_;
+  THash hash_{};
+  std::vector<std::unique_ptr<shard>> shards_{};
+  std::vector<std::thread> threads_{};
+  std::atomic<bool> stop_{false};
+  std::atomic<std::size_t> pending_{0};
+  std::size_t ready_ = 0;
+  std::mutex idle_mutex_{};
+  std::condition_variable idle_cv_{};
+  std::mutex post_mutex_{};
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
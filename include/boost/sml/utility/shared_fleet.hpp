@@ -0,0 +1,392 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_SHARED_FLEET_HPP
+#define BOOST_SML_UTILITY_SHARED_FLEET_HPP
+
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "boost/sml.hpp"
+#include "boost/sml/utility/fleet.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+/// Shared mapping of a file descriptor (`memfd_create`, `shm_open`, file), grown to `size` bytes when smaller
+///   - mappings of the same descriptor by different processes (or of the same name) share the memory, which can be
+///     placed at different addresses in each of them
+class shared_segment {
+ public:
+  shared_segment(const int fd, const std::size_t size) {
+    struct stat st {};
+    if (fd < 0 || ::fstat(fd, &st) || (static_cast<std::size_t>(st.st_size) < size && ::ftruncate(fd, size))) {
+      return;
+    }
+    const auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      data_ = data;
+      size_ = size;
+    }
+  }
+
+  shared_segment(shared_segment &&other) : data_(other.data_), size_(other.size_) { other.data_ = nullptr; }
+  shared_segment(const shared_segment &) = delete;
+  shared_segment &operator=(const shared_segment &) = delete;
+
+  ~shared_segment() {
+    if (data_) {
+      ::munmap(data_, size_);
+    }
+  }
+
+  explicit operator bool() const { return data_ != nullptr; }
+  void *data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+ private:
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+/// Dependency of the state machines of a shared fleet, the instance being processed
+template <class TData>
+struct shared_instance {
+  std::size_t index;
+  TData *data;
+};
+
+template <>
+struct shared_instance<void> {
+  std::size_t index;
+};
+
+namespace detail {
+inline long futex(std::uint32_t *word, const int op, const std::uint32_t value) {
+  return ::syscall(SYS_futex, word, op, value, nullptr, nullptr, 0);
+}
+
+/// sleeps while `*word == value`, up to `timeout_ms` (-1 - infinitely)
+inline void futex_wait(std::uint32_t *word, const std::uint32_t value, const int timeout_ms) {
+  timespec ts{timeout_ms / 1000, (timeout_ms % 1000) * 1000000l};
+  ::syscall(SYS_futex, word, FUTEX_WAIT, value, timeout_ms < 0 ? nullptr : &ts, nullptr, 0);
+}
+
+/// status word of a shared segment, 0 - uninitialized, `initializing | pid` - being initialized by the process `pid`,
+/// any other value - initialized
+constexpr std::uint32_t segment_initializing = 0x80000000u;
+
+/// returns true when the calling process has to initialize the segment, which is the case when it's uninitialized
+/// or the process initializing it doesn't exist anymore, otherwise waits until it's initialized by another process
+inline bool acquire_segment(std::uint32_t *status) {
+  const auto token = segment_initializing | static_cast<std::uint32_t>(::getpid());
+  auto current = __atomic_load_n(status, __ATOMIC_ACQUIRE);
+  for (;;) {
+    if (!current || (current & segment_initializing && ::kill(static_cast<int>(current & ~segment_initializing), 0) &&
+                     errno == ESRCH)) {
+      if (__atomic_compare_exchange_n(status, &current, token, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        return true;
+      }
+      continue;
+    }
+    if (!(current & segment_initializing)) {
+      return false;
+    }
+    futex_wait(status, current, 10);  /// the creator which died never wakes waiters up
+    current = __atomic_load_n(status, __ATOMIC_ACQUIRE);
+  }
+}
+
+inline void release_segment(std::uint32_t *status, const std::uint32_t value) {
+  __atomic_store_n(status, value, __ATOMIC_RELEASE);
+  futex(status, FUTEX_WAKE, INT32_MAX);
+}
+
+template <class T>
+struct column_size : aux::integral_constant<std::size_t, sizeof(T)> {};
+
+template <>
+struct column_size<void> : aux::integral_constant<std::size_t, 0> {};
+
+template <class T>
+struct column_align : aux::integral_constant<std::size_t, alignof(T)> {};
+
+template <>
+struct column_align<void> : aux::integral_constant<std::size_t, 1> {};
+}  // namespace detail
+
+/// Fleet (see utility::fleet) whose current states, user data (`TData`, one per instance) and locks live in a segment
+/// of memory shared by processes
+///   - the segment is addressed by offsets only, so that processes can map it at different addresses
+///   - the first process creates the instances, the following ones (and the restarted ones) attach to them as they
+///     are, without processing anything
+///   - a process attaching while the creating one died before the instances were created creates them instead
+///   - each instance has a process-shared lock, the owner token is the pid of the process holding it (futex based,
+///     waiters sleep), locks of crashed processes are released by `recover`
+///   - transitions, dependencies and data members of the state machine class are process local, entry actions of the
+///     initial states are executed by each process, when its state machine is constructed
+///   - the state machine gets `shared_instance<TData>&` dependency, the index and the user data of the instance being
+///     processed
+///   - not thread safe within a process, each thread has to attach its own shared_fleet
+///
+///   const auto fd = ::memfd_create("sessions", 0); // inherited by the worker processes
+///   sml::utility::shared_segment segment{fd, sml::utility::shared_fleet<sml::sm<session>, data>::segment_size(1'000'000)};
+///   sml::utility::shared_fleet<sml::sm<session>, data> sessions{segment.data(), segment.size(), 1'000'000, deps...};
+///   sessions.process_event(i, packet{});
+template <class SM, class TData = void>
+class shared_fleet {
+  static_assert(aux::is_same<back::no_policy, typename SM::deferred_t>::value, "deferred events can't be shared");
+  static_assert(!SM::has_timeouts::value, "`after` transitions aren't supported, instances would share one set of timers");
+  static_assert(std::is_trivially_copyable<aux::conditional_t<aux::is_same<void, TData>::value, int, TData>>::value,
+                "user data has to be trivially copyable");
+
+  static constexpr std::uint64_t magic = 0x736d6c2d666c7431ull;
+  static constexpr std::uint32_t waiters = 0x80000000u;
+  static constexpr std::uint32_t uninitialized = 0, ready = 2;
+
+  struct header {
+    std::uint64_t magic;
+    std::uint64_t layout;
+    std::uint64_t size;
+    std::uint64_t locks;
+    std::uint64_t states;
+    std::uint64_t data;
+    std::uint32_t status;
+  };
+
+  static constexpr std::size_t align(const std::size_t offset, const std::size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+  static constexpr std::size_t locks_offset() { return align(sizeof(header), 64); }
+  static constexpr std::size_t states_offset(const std::size_t size) {
+    return align(locks_offset() + size * sizeof(std::uint32_t), 64);
+  }
+  static constexpr std::size_t data_offset(const std::size_t size) {
+    return align(states_offset(size) + size * SM::instance_size(),
+                 detail::column_align<TData>::value > 64 ? detail::column_align<TData>::value : 64);
+  }
+
+  /// instances can only be shared by the same state machine (states) with the same user data
+  static std::uint64_t layout() {
+    using impl_t = typename detail::sm_impl_of<SM>::type;
+    return std::uint64_t(SM::instance_size()) << 48 | std::uint64_t(aux::size<typename impl_t::states_t>::value) << 32 |
+           detail::column_size<TData>::value;
+  }
+
+ public:
+  using data_t = TData;
+  using instance_t = shared_instance<TData>;
+
+  /// bytes of the segment required by `size` instances
+  static constexpr std::size_t segment_size(const std::size_t size) {
+    return data_offset(size) + size * detail::column_size<TData>::value;
+  }
+
+  /// attaches to the instances of the segment or creates `size` instances (when the segment has none)
+  template <class... TDeps>
+  shared_fleet(void *segment, const std::size_t bytes, const std::size_t size, TDeps &&... deps)
+      : instance_{}, sm_(new SM(instance_, static_cast<TDeps &&>(deps)...)), segment_(static_cast<aux::byte *>(segment)) {
+    if (!segment_ || bytes < sizeof(header)) {
+      return;
+    }
+    auto &h = *reinterpret_cast<header *>(segment_);
+    if (detail::acquire_segment(&h.status)) {
+      if (segment_size(size) > bytes) {
+        detail::release_segment(&h.status, uninitialized);
+        return;
+      }
+      create(h, size);
+      detail::release_segment(&h.status, ready);
+    } else {
+      attached_ = true;
+    }
+    if (h.magic != magic || h.layout != layout() || segment_size(h.size) > bytes) {
+      return;
+    }
+    size_ = h.size;
+    locks_ = reinterpret_cast<std::uint32_t *>(segment_ + h.locks);
+    states_ = segment_ + h.states;
+    data_ = segment_ + h.data;
+  }
+
+  shared_fleet(const shared_fleet &) = delete;
+  shared_fleet &operator=(const shared_fleet &) = delete;
+
+  /// false when the segment is too small or holds instances of a different state machine
+  bool valid() const { return locks_ != nullptr; }
+
+  /// true when the instances were created by another process (or a previous run)
+  bool attached() const { return attached_; }
+
+  std::size_t size() const { return size_; }
+
+  /// blocks until the instance is owned by the calling process
+  void lock(const std::size_t i) {
+    const auto token = static_cast<std::uint32_t>(::getpid());
+    auto word = &locks_[i];
+    auto owner = std::uint32_t{};
+    if (__atomic_compare_exchange_n(word, &owner, token, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      return;
+    }
+    for (;;) {
+      if (!owner) {
+        if (__atomic_compare_exchange_n(word, &owner, token | waiters, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+          return;
+        }
+        continue;
+      }
+      if (!(owner & waiters) &&
+          !__atomic_compare_exchange_n(word, &owner, owner | waiters, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        continue;
+      }
+      detail::futex(word, FUTEX_WAIT, owner | waiters);
+      owner = __atomic_load_n(word, __ATOMIC_RELAXED);
+    }
+  }
+
+  bool try_lock(const std::size_t i) {
+    auto owner = std::uint32_t{};
+    return __atomic_compare_exchange_n(&locks_[i], &owner, static_cast<std::uint32_t>(::getpid()), false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+  }
+
+  void unlock(const std::size_t i) {
+    if (__atomic_exchange_n(&locks_[i], 0u, __ATOMIC_RELEASE) & waiters) {
+      detail::futex(&locks_[i], FUTEX_WAKE, 1);
+    }
+  }
+
+  /// pid of the process owning the instance, 0 when it isn't locked
+  int owner(const std::size_t i) const { return static_cast<int>(__atomic_load_n(&locks_[i], __ATOMIC_RELAXED) & ~waiters); }
+
+  /// releases locks owned by processes which don't exist anymore, returns the number of released locks,
+  /// instances are left in the states stored by the last completed `process_event`
+  std::size_t recover() {
+    std::size_t released = 0;
+    for (auto i = std::size_t{}; i < size_; ++i) {
+      auto word = __atomic_load_n(&locks_[i], __ATOMIC_RELAXED);
+      const auto pid = static_cast<int>(word & ~waiters);
+      if (pid && ::kill(pid, 0) && errno == ESRCH &&
+          __atomic_compare_exchange_n(&locks_[i], &word, 0u, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        detail::futex(&locks_[i], FUTEX_WAKE, INT32_MAX);
+        ++released;
+      }
+    }
+    return released;
+  }
+
+  /// user data of the instance, it has to be locked by the caller unless the data is immutable
+  template <class T = TData>
+  T &data(const std::size_t i) {
+    return reinterpret_cast<T *>(data_)[i];
+  }
+
+  /// locks the instance, processes the event and stores the new states before the lock is released
+  template <class TEvent>
+  bool process_event(const std::size_t i, TEvent &&event) {
+    lock(i);
+    const auto handled = process_event_locked(i, static_cast<TEvent &&>(event));
+    unlock(i);
+    return handled;
+  }
+
+  /// processes the event by the instance locked by the caller
+  template <class TEvent>
+  bool process_event_locked(const std::size_t i, TEvent &&event) {
+    auto &sm = load(i);
+    const auto handled = sm.process_event(static_cast<TEvent &&>(event));
+    sm.store_instance(&states_[i * SM::instance_size()]);
+    return handled;
+  }
+
+  template <class... TStates>
+  bool is(const std::size_t i, const TStates &... states) const {
+    aux::byte current[SM::instance_size()];
+    load_states(i, current);
+    sm_->load_instance(current);
+    return sm_->is(states...);
+  }
+
+  template <class TVisitor>
+  void visit_current_states(const std::size_t i, const TVisitor &visitor) const {
+    aux::byte current[SM::instance_size()];
+    load_states(i, current);
+    sm_->load_instance(current);
+    sm_->visit_current_states(visitor);
+  }
+
+ private:
+  void create(header &h, const std::size_t size) {
+    aux::byte initial[SM::instance_size()]{};
+    sm_->store_instance(initial);
+    h.magic = magic;
+    h.layout = layout();
+    h.size = size;
+    h.locks = locks_offset();
+    h.states = states_offset(size);
+    h.data = data_offset(size);
+    const auto locks = reinterpret_cast<std::uint32_t *>(segment_ + h.locks);
+    for (auto i = std::size_t{}; i < size; ++i) {
+      locks[i] = 0;
+      for (auto s = 0; s < SM::instance_size(); ++s) {
+        segment_[h.states + i * SM::instance_size() + s] = initial[s];
+      }
+    }
+    create_data(segment_ + h.data, size, aux::is_same<void, TData>{});
+  }
+
+  static void create_data(aux::byte *data, const std::size_t size, aux::false_type) {
+    for (auto i = std::size_t{}; i < size; ++i) {
+      new (reinterpret_cast<TData *>(data) + i) TData{};
+    }
+  }
+
+  static void create_data(aux::byte *, std::size_t, aux::true_type) {}
+
+  /// states can be read without the lock, while they are being stored by another process
+  void load_states(const std::size_t i, aux::byte *states) const {
+    for (auto s = 0; s < SM::instance_size(); ++s) {
+      states[s] = __atomic_load_n(&states_[i * SM::instance_size() + s], __ATOMIC_RELAXED);
+    }
+  }
+
+  SM &load(const std::size_t i) {
+    instance_.index = i;
+    set_data(i, aux::is_same<void, TData>{});
+    sm_->load_instance(&states_[i * SM::instance_size()]);
+    return *sm_;
+  }
+
+  void set_data(const std::size_t i, aux::false_type) { instance_.data = &data(i); }
+  void set_data(std::size_t, aux::true_type) {}
+
+  instance_t instance_;
+  std::unique_ptr<SM> sm_;
+  aux::byte *segment_ = nullptr;
+  std::uint32_t *locks_ = nullptr;
+  aux::byte *states_ = nullptr;
+  aux::byte *data_ = nullptr;
+  std::size_t size_ = 0;
+  bool attached_ = false;
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_SM_POOL_HPP
+#define BOOST_SML_UTILITY_SM_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+/// Free list of pre-constructed state machines
+///   - `acquire` hands out an instance being in the initial states, a new one is constructed only when the list is empty
+///   - instances are `reset` when they are released (the returned pointer goes out of scope), so that neither
+///     allocation nor construction happens on the acquire path
+///   - dependencies are kept by reference and have to outlive the pool, the pool has to outlive acquired instances
+///
+///   sml::utility::sm_pool<sml::sm<session>> sessions{1024, deps...};
+///   auto session = sessions.acquire();
+///   session->process_event(connect{});
+template <class SM>
+class sm_pool {
+  struct releaser {
+    void operator()(SM *sm) const { pool->release(sm); }
+    sm_pool *pool;
+  };
+
+ public:
+  using pointer = std::unique_ptr<SM, releaser>;
+
+  template <class... TDeps>
+  explicit sm_pool(const std::size_t size, TDeps &... deps) : create_([&deps...] { return new SM(deps...); }) {
+    reserve(size);
+  }
+
+  sm_pool(const sm_pool &) = delete;
+  sm_pool &operator=(const sm_pool &) = delete;
+
+  /// number of constructed instances
+  std::size_t size() const { return sms_.size(); }
+  /// number of instances ready to be acquired
+  std::size_t available() const { return free_.size(); }
+
+  /// constructs instances until `size` of them are available
+  void reserve(const std::size_t size) {
+    free_.reserve(sms_.size() - free_.size() + size);
+    while (free_.size() < size) {
+      sms_.emplace_back(create_());
+      free_.push_back(sms_.back().get());
+    }
+  }
+
+  pointer acquire() {
+    if (free_.empty()) {
+      reserve(1);
+    }
+    const auto sm = free_.back();
+    free_.pop_back();
+    return pointer{sm, releaser{this}};
+  }
+
+ private:
+  void release(SM *sm) {
+    sm->reset();
+    free_.push_back(sm);
+  }
+
+  std::function<SM *()> create_;
+  std::vector<std::unique_ptr<SM>> sms_{};
+  std::vector<SM *> free_{};
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
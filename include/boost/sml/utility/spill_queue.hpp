@@ -0,0 +1,365 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_SPILL_QUEUE_HPP
+#define BOOST_SML_UTILITY_SPILL_QUEUE_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+/// Codec requirements
+///   template <class T> std::size_t size(const T &) const;
+///   template <class T> void encode(const T &, void *) const;
+///   template <class T> T decode(const void *, std::size_t) const;
+template <class TCodec>
+struct spill_options {
+  std::string directory = "/tmp";
+  std::size_t high_water_mark = 1024; /// events kept in memory
+  std::size_t capacity = 1 << 20;     /// initial size of the spill file in bytes
+  TCodec codec{};
+};
+
+namespace detail {
+
+template <class T, class TCodec, template <class...> class TDeque>
+class spill_deque;
+
+template <template <class...> class TQueueEvent, class... TEvents, class TCodec, template <class...> class TDeque>
+class spill_deque<TQueueEvent<TEvents...>, TCodec, TDeque> {
+  using memory_t = TDeque<TQueueEvent<TEvents...>>;
+
+  struct header {
+    int id;
+    std::uint32_t size;
+  };
+
+  static constexpr std::size_t align(const std::size_t size) {
+    return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+  template <class TEvent>
+  static std::size_t size_impl(const TCodec &codec, const void *event) {
+    return codec.size(*static_cast<const TEvent *>(event));
+  }
+
+  template <class TEvent>
+  static void encode_impl(const TCodec &codec, const void *event, void *out) {
+    codec.encode(*static_cast<const TEvent *>(event), out);
+  }
+
+  template <class TEvent>
+  static TQueueEvent<TEvents...> decode_impl(const TCodec &codec, const void *data, const std::size_t size) {
+    return codec.template decode<TEvent>(data, size);
+  }
+
+ public:
+  using value_type = TQueueEvent<TEvents...>;
+  using allocator_type = typename memory_t::allocator_type;
+  using iterator = typename memory_t::iterator;
+  using const_iterator = typename memory_t::const_iterator;
+
+  explicit spill_deque(const spill_options<TCodec> &options) : options_(options) {
+    if (!options_.high_water_mark) {
+      options_.high_water_mark = 1;
+    }
+  }
+
+  spill_deque(spill_deque &&other)
+      : memory_(static_cast<memory_t &&>(other.memory_)),
+        offsets_(static_cast<offsets_t &&>(other.offsets_)),
+        options_(static_cast<spill_options<TCodec> &&>(other.options_)),
+        fd_(other.fd_),
+        map_(other.map_),
+        mapped_(other.mapped_),
+        read_(other.read_),
+        write_(other.write_),
+        next_(other.next_),
+        spilled_(other.spilled_) {
+    other.fd_ = -1;
+    other.map_ = nullptr;
+    other.mapped_ = other.read_ = other.write_ = other.next_ = other.spilled_ = 0;
+  }
+
+  spill_deque(const spill_deque &) = delete;
+  spill_deque &operator=(const spill_deque &) = delete;
+
+  ~spill_deque() {
+    if (map_) {
+      ::munmap(map_, mapped_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  iterator begin() { return memory_.begin(); }
+  iterator end() { return memory_.end(); }
+  const_iterator begin() const { return memory_.begin(); }
+  const_iterator end() const { return memory_.end(); }
+
+  bool empty() const { return memory_.empty(); }
+  std::size_t size() const { return spilled_ ? spilled_ : memory_.size(); }
+  std::size_t spilled() const { return spilled_; }
+  std::size_t resident() const { return memory_.size(); }
+
+  /// once the high water mark is reached, all events (the in-memory ones included) are kept in the spill file
+  /// and the memory holds a window of decoded copies of consecutive ones
+  void push_back(value_type &&event) {
+    if (!spilled_) {
+      if (memory_.size() < options_.high_water_mark || !spill_memory()) {
+        memory_.push_back(static_cast<value_type &&>(event));
+        return;
+      }
+    }
+    const auto offset = write_;
+    if (!spill(event)) {
+      unspill_all();
+      memory_.push_back(static_cast<value_type &&>(event));
+    } else if (memory_.size() < options_.high_water_mark && next_ == offset) {
+      memory_.push_back(static_cast<value_type &&>(event));
+      offsets_.push_back(offset);
+      next_ = write_;
+    }
+  }
+
+  /// the record of an erased spilled event is marked as removed in place, the window goes back to the first
+  /// event when it isn't there already, so that processing restarted from `begin` sees the events in order
+  iterator erase(const_iterator it) {
+    const auto index = it - memory_.cbegin();
+    memory_.erase(it);
+    if (!spilled_) {
+      return memory_.begin() + index;
+    }
+    const auto offset = offsets_[static_cast<std::size_t>(index)];
+    offsets_.erase(offsets_.begin() + index);
+    remove(offset);
+    if (!spilled_) {
+      reset();
+      return memory_.begin();
+    }
+    if (offsets_.empty() || offsets_.front() != read_) {
+      load(read_);
+      return memory_.begin();
+    }
+    top_up();
+    return memory_.begin() + index;
+  }
+
+  /// moves the window to the next spilled events once `it` reached its end, so that events deferred again
+  /// don't leave the spilled ones behind, after the last one the window goes back to the first event (`it` = end)
+  friend bool refill(spill_deque &queue, const_iterator &it) {
+    if (!queue.spilled_ || it != queue.memory_.cend()) {
+      return false;
+    }
+    if (queue.next_ < queue.write_) {
+      queue.load(queue.next_);
+      if (!queue.memory_.empty()) {
+        it = queue.memory_.cbegin();
+        return true;
+      }
+    }
+    queue.load(queue.read_);
+    it = queue.memory_.cend();
+    return true;
+  }
+
+ private:
+  using offsets_t = TDeque<std::size_t>;
+
+  static constexpr int removed = -1;
+
+  bool spill(const value_type &event) {
+    using size_impl_t = std::size_t (*)(const TCodec &, const void *);
+    using encode_t = void (*)(const TCodec &, const void *, void *);
+    const static size_impl_t sizes[] = {&spill_deque::size_impl<TEvents>...};
+    const static encode_t encoders[] = {&spill_deque::encode_impl<TEvents>...};
+
+    const auto size = sizes[event.id](options_.codec, event.data);
+    const auto record = align(sizeof(header)) + align(size);
+    if (!reserve(write_ + record)) {
+      return false;
+    }
+    const header h{event.id, static_cast<std::uint32_t>(size)};
+    std::memcpy(map_ + write_, &h, sizeof(h));
+    encoders[event.id](options_.codec, event.data, map_ + write_ + align(sizeof(header)));
+    release(write_, write_ + record);
+    write_ += record;
+    ++spilled_;
+    return true;
+  }
+
+  /// the in-memory events become the window over the beginning of the spill file
+  bool spill_memory() {
+    for (const auto &event : memory_) {
+      const auto offset = write_;
+      if (!spill(event)) {
+        offsets_.clear();
+        reset();
+        return false;
+      }
+      offsets_.push_back(offset);
+    }
+    next_ = write_;
+    return true;
+  }
+
+  header at(const std::size_t offset) const {
+    header h{};
+    std::memcpy(&h, map_ + offset, sizeof(h));
+    return h;
+  }
+
+  static std::size_t record_size(const header &h) { return align(sizeof(header)) + align(h.size); }
+
+  value_type decode(const std::size_t offset, const header &h) {
+    using decode_t = value_type (*)(const TCodec &, const void *, std::size_t);
+    const static decode_t decoders[] = {&spill_deque::decode_impl<TEvents>...};
+    auto event = decoders[h.id](options_.codec, map_ + offset + align(sizeof(header)), h.size);
+    release(offset, offset + record_size(h));
+    return event;
+  }
+
+  void remove(const std::size_t offset) {
+    auto h = at(offset);
+    h.id = removed;
+    std::memcpy(map_ + offset, &h, sizeof(h));
+    --spilled_;
+    while (read_ < write_ && at(read_).id == removed) {
+      const auto begin = read_;
+      read_ += record_size(at(read_));
+      release(begin, read_);
+    }
+  }
+
+  /// decodes events following the window until it has `high_water_mark` of them
+  void top_up() {
+    while (memory_.size() < options_.high_water_mark && next_ < write_) {
+      const auto h = at(next_);
+      if (h.id != removed) {
+        memory_.push_back(decode(next_, h));
+        offsets_.push_back(next_);
+      }
+      next_ += record_size(h);
+    }
+    if (memory_.size() == spilled_) {
+      offsets_.clear();
+      reset();
+    }
+  }
+
+  void load(const std::size_t offset) {
+    memory_.clear();
+    offsets_.clear();
+    next_ = offset;
+    top_up();
+  }
+
+  /// falls back to memory (when the spill file can't be grown) without losing or reordering events
+  void unspill_all() {
+    memory_.clear();
+    offsets_.clear();
+    for (auto offset = read_; offset < write_;) {
+      const auto h = at(offset);
+      if (h.id != removed) {
+        memory_.push_back(decode(offset, h));
+      }
+      offset += record_size(h);
+    }
+    reset();
+  }
+
+  /// the window holds all events, the spill file isn't needed anymore
+  void reset() {
+    release(0, mapped_);
+    read_ = write_ = next_ = spilled_ = 0;
+  }
+
+  /// drops completely written/read pages from the mapping, so that RSS stays flat
+  void release(const std::size_t begin, const std::size_t end) {
+#if defined(MADV_DONTNEED)
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const auto first = begin / page * page;
+    const auto last = end / page * page;
+    if (first < last) {
+      ::madvise(map_ + first, last - first, MADV_DONTNEED);
+    }
+#else
+    (void)begin;
+    (void)end;
+#endif
+  }
+
+  bool reserve(const std::size_t size) {
+    if (size <= mapped_) {
+      return true;
+    }
+    if (fd_ < 0) {
+      auto path = options_.directory + "/sml-spill-XXXXXX";
+      fd_ = ::mkstemp(&path[0]);
+      if (fd_ < 0) {
+        return false;
+      }
+      ::unlink(path.c_str());
+    }
+    auto mapped = mapped_ ? mapped_ : align(options_.capacity ? options_.capacity : 1);
+    while (mapped < size) {
+      mapped *= 2;
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(mapped))) {
+      return false;
+    }
+    auto map = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    if (map_) {
+      ::munmap(map_, mapped_);
+    }
+    map_ = static_cast<aux::byte *>(map);
+    mapped_ = mapped;
+    return true;
+  }
+
+  memory_t memory_{};
+  offsets_t offsets_{};  /// positions of the in-memory events in the spill file
+  spill_options<TCodec> options_;
+  int fd_ = -1;
+  aux::byte *map_ = nullptr;
+  std::size_t mapped_ = 0;
+  std::size_t read_ = 0;
+  std::size_t write_ = 0;
+  std::size_t next_ = 0;  /// position following the window
+  std::size_t spilled_ = 0;
+};
+}  // namespace detail
+
+/// Defer queue which keeps at most `high_water_mark` events in memory, past it the events are appended
+/// to a memory-mapped spill file and the memory holds a window of decoded ones which moves over the file
+///
+///   sml::sm<c, sml::defer_queue<sml::utility::spill_queue<codec>::type, sml::utility::spill_options<codec>>> sm{options};
+template <class TCodec, template <class...> class TDeque = std::deque>
+struct spill_queue {
+  template <class T>
+  using type = detail::spill_deque<T, TCodec, TDeque>;
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
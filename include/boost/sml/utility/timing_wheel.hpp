@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#ifndef BOOST_SML_UTILITY_TIMING_WHEEL_HPP
+#define BOOST_SML_UTILITY_TIMING_WHEEL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "boost/sml.hpp"
+
+BOOST_SML_NAMESPACE_BEGIN
+
+namespace utility {
+
+/// Hierarchical timing wheel, timer service of the `after(duration)` transitions (sml::timer_service policy)
+///   - 6 wheels of 64 slots, a slot of each wheel spans the whole previous one, so that timers due within 64^6 ticks
+///     are kept (further ones are put into the last slot and re-inserted once they get closer)
+///   - timers are intrusive (embedded into the state machines), arming and cancelling are O(1) and allocation free
+///   - `tick(now)` advances the wheel calling the expiry callbacks of due timers, timers of the next 64 ticks are in
+///     the first wheel, the later ones are cascaded down as the time advances
+///   - timers are armed relatively to the last tick, with the resolution of a tick (rounded up)
+///   - not thread safe, it has to be driven by the thread processing events of the state machines and it has to
+///     outlive them
+///
+///   sml::utility::timing_wheel<> timers{std::chrono::milliseconds{1}};
+///   sml::sm<connection, sml::timer_service<sml::utility::timing_wheel<>>> sm{timers};
+///   for (;;) {
+///     timers.tick(std::chrono::steady_clock::now());
+///   }
+template <class Clock = std::chrono::steady_clock>
+class timing_wheel {
+  static constexpr auto levels = 6;
+  static constexpr auto slot_bits = 6;
+  static constexpr auto slots = 1 << slot_bits;
+  static constexpr std::uint64_t slot_mask = slots - 1;
+  static constexpr std::uint64_t max_delta = (std::uint64_t{1} << (slot_bits * levels)) - 1;
+
+  struct link {
+    void unlink() {
+      if (next) {
+        prev->next = next;
+        next->prev = prev;
+        prev = next = nullptr;
+      }
+    }
+
+    link *prev = nullptr;
+    link *next = nullptr;
+  };
+
+  struct list : link {
+    list() { this->prev = this->next = this; }
+    list(const list &) = delete;
+    list &operator=(const list &) = delete;
+
+    bool empty() const { return this->next == this; }
+
+    void push_back(link &l) {
+      l.prev = this->prev;
+      l.next = this;
+      this->prev->next = &l;
+      this->prev = &l;
+    }
+
+    /// moves all links into `to` (which has to be empty)
+    void splice(list &to) {
+      if (!empty()) {
+        to.next = this->next;
+        to.prev = this->prev;
+        to.next->prev = &to;
+        to.prev->next = &to;
+        this->prev = this->next = this;
+      }
+    }
+  };
+
+ public:
+  using clock = Clock;
+  using duration = typename Clock::duration;
+  using time_point = typename Clock::time_point;
+
+  class timer : link {
+    friend class timing_wheel;
+
+   public:
+    timer() = default;
+    timer(const timer &) : link{} {}
+    timer &operator=(const timer &) { return *this; }
+    ~timer() { this->unlink(); }
+
+    bool armed() const { return this->next != nullptr; }
+
+   private:
+    std::uint64_t deadline_ = 0;
+    void (*expired_)(timer &) = nullptr;
+  };
+
+  explicit timing_wheel(const duration resolution = std::chrono::milliseconds{1}, const time_point now = Clock::now())
+      : resolution_(resolution), origin_(now) {}
+
+  timing_wheel(const timing_wheel &) = delete;
+  timing_wheel &operator=(const timing_wheel &) = delete;
+
+  ~timing_wheel() {
+    for (auto &wheel : wheels_) {
+      for (auto &slot : wheel) {
+        while (!slot.empty()) {
+          slot.next->unlink();
+        }
+      }
+    }
+  }
+
+  duration resolution() const { return resolution_; }
+
+  /// time of the last tick
+  time_point now() const { return origin_ + resolution_ * static_cast<typename duration::rep>(next_ - 1); }
+
+  /// `expired(t)` is called by `tick` once `timeout` elapses, unless the timer is cancelled or armed again before
+  template <class TDuration>
+  void arm(timer &t, const TDuration &timeout, void (*expired)(timer &)) {
+    t.unlink();
+    const auto ticks = (std::chrono::duration_cast<duration>(timeout) + resolution_ - duration{1}) / resolution_;
+    t.deadline_ = next_ - 1 + (ticks > 0 ? static_cast<std::uint64_t>(ticks) : 1u);
+    t.expired_ = expired;
+    insert(t);
+  }
+
+  void cancel(timer &t) { t.unlink(); }
+
+  /// expires timers due until `now`, returns the number of expired timers
+  std::size_t tick(const time_point now) {
+    if (now < origin_) {
+      return 0;
+    }
+    const auto last = static_cast<std::uint64_t>((now - origin_) / resolution_);
+    std::size_t expired = 0;
+    while (next_ <= last) {
+      const auto index = next_ & slot_mask;
+      if (!index) {
+        cascade(1);
+      }
+      ++next_;
+      list due{};
+      wheels_[0][index].splice(due);
+      while (!due.empty()) {
+        auto &t = static_cast<timer &>(*due.next);
+        t.unlink();
+        ++expired;
+        t.expired_(t);
+      }
+    }
+    return expired;
+  }
+
+ private:
+  void insert(timer &t) {
+    const auto deadline = t.deadline_ < next_ ? next_ : t.deadline_;
+    const auto delta = deadline - next_;
+    if (delta > max_delta) {
+      wheels_[levels - 1][((next_ + max_delta) >> (slot_bits * (levels - 1))) & slot_mask].push_back(t);
+      return;
+    }
+    auto level = 0;
+    while (delta >> (slot_bits * (level + 1))) {
+      ++level;
+    }
+    wheels_[level][(deadline >> (slot_bits * level)) & slot_mask].push_back(t);
+  }
+
+  /// timers of the current slot of the `level` wheel are moved down, once the wheel wraps around the next one follows
+  void cascade(const int level) {
+    if (level == levels) {
+      return;
+    }
+    const auto index = (next_ >> (slot_bits * level)) & slot_mask;
+    list timers{};
+    wheels_[level][index].splice(timers);
+    while (!timers.empty()) {
+      auto &t = static_cast<timer &>(*timers.next);
+      t.unlink();
+      insert(t);
+    }
+    if (!index) {
+      cascade(level + 1);
+    }
+  }
+
+  duration resolution_;
+  time_point origin_;
+  std::uint64_t next_ = 1;
+  list wheels_[levels][slots];
+};
+
+}  // namespace utility
+
+BOOST_SML_NAMESPACE_END
+
+#endif
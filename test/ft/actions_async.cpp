@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct write_block {
+  int bytes{};
+};
+struct written {};
+struct close_file {};
+
+const auto idle = sml::state<class idle>;
+const auto writing_done = sml::state<class writing_done>;
+const auto closed = sml::state<class closed>;
+
+/// completes the actions once their futures are ready, on the thread calling `run`
+struct executor {
+  template <class T, class F>
+  void async_wait(T&& future, F&& completion) {
+    pending.emplace_back(std::forward<T>(future), std::forward<F>(completion));
+  }
+
+  void run() {
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (it->first.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+        auto completion = std::move(it->second);
+        it = pending.erase(it);
+        completion();
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::vector<std::pair<std::future<void>, std::function<void()>>> pending{};
+};
+
+struct disk {
+  std::future<void> write(const int bytes) {
+    written.push_back(bytes);
+    requests.emplace_back();
+    return requests.back().get_future();
+  }
+
+  void complete() {
+    requests.front().set_value();
+    requests.pop_front();
+  }
+
+  std::vector<int> written{};
+  std::deque<std::promise<void>> requests{};
+};
+
+test async_action_defers_events_until_completed = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<write_block> / async_action([](const write_block& w, disk& d) { return d.write(w.bytes); }) = writing_done
+        , writing_done + event<write_block> / async_action([](const write_block& w, disk& d) { return d.write(w.bytes); })
+        , writing_done + event<close_file> = closed
+      );
+      // clang-format on
+    }
+  };
+
+  executor e{};
+  disk d{};
+  sml::sm<c, sml::defer_queue<std::deque>, sml::async_executor<executor>> sm{e, d};
+  expect(!sm.pending());
+
+  expect(sm.process_event(write_block{1}));
+  expect(sm.pending());
+  expect(sm.is(writing_done));
+  expect(1u == e.pending.size());
+
+  expect(sm.process_event(write_block{2}));
+  expect(sm.process_event(close_file{}));
+  expect((std::vector<int>{1}) == d.written);
+
+  e.run();  // not resolved yet
+  expect(sm.pending());
+
+  d.complete();
+  e.run();
+  expect(sm.pending());  // the deferred write started another asynchronous action
+  expect((std::vector<int>{1, 2}) == d.written);
+  expect(sm.is(writing_done));
+
+  d.complete();
+  e.run();
+  expect(!sm.pending());
+  expect(sm.is(closed));
+};
+
+test async_action_completion_after_reset_is_ignored = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<write_block> / async_action([](const write_block& w, disk& d) { return d.write(w.bytes); }) = writing_done
+        , writing_done + event<close_file> = closed
+      );
+      // clang-format on
+    }
+  };
+
+  executor e{};
+  disk d{};
+  sml::sm<c, sml::defer_queue<std::deque>, sml::async_executor<executor>> sm{e, d};
+
+  expect(sm.process_event(write_block{1}));
+  expect(sm.pending());
+  sm.reset();
+  expect(!sm.pending());
+  expect(sm.is(idle));
+
+  expect(sm.process_event(write_block{2}));
+  expect(sm.pending());
+  expect(2u == e.pending.size());
+
+  d.complete();
+  e.run();  // completion of the action started before reset
+  expect(sm.pending());
+
+  d.complete();
+  e.run();
+  expect(!sm.pending());
+  expect(sm.process_event(close_file{}));
+  expect(sm.is(closed));
+};
+
+test async_action_completes_anonymous_transitions = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<write_block> / async_action([](disk& d) { return d.write(0); }) = writing_done
+        , writing_done = closed
+      );
+      // clang-format on
+    }
+  };
+
+  executor e{};
+  disk d{};
+  sml::sm<c, sml::defer_queue<std::deque>, sml::async_executor<executor>> sm{e, d};
+  sm.process_event(write_block{});
+  expect(sm.pending());
+  expect(sm.is(writing_done));
+
+  d.complete();
+  e.run();
+  expect(!sm.pending());
+  expect(sm.is(closed));
+};
+
+test async_action_many_state_machines = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<write_block> / async_action([](const write_block& w, disk& d) { return d.write(w.bytes); }) = writing_done
+        , writing_done + event<written> = closed
+      );
+      // clang-format on
+    }
+  };
+
+  using sm_t = sml::sm<c, sml::defer_queue<std::deque>, sml::async_executor<executor>>;
+  constexpr auto sms = 100;
+  executor e{};
+  disk d{};
+  std::deque<sm_t> machines{};
+  for (auto i = 0; i < sms; ++i) {
+    machines.emplace_back(e, d);
+    machines.back().process_event(write_block{i});
+    machines.back().process_event(written{});
+  }
+  expect(sms == static_cast<int>(e.pending.size()));
+
+  for (auto i = 0; i < sms; ++i) {
+    d.complete();
+  }
+  e.run();
+
+  auto all = true;
+  for (const auto& sm : machines) {
+    all &= !sm.pending() && sm.is(closed);
+  }
+  expect(all);
+};
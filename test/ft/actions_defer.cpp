@@ -288,4 +288,107 @@ test defer_queue_event_move_dtor = [] {
   expect(e1data2.use_count() == 1);
   expect(e1data3.use_count() == 1);
   expect(e1data4.use_count() == 1);
-};
\ No newline at end of file
+};
+test defer_move_only_event = [] {
+  struct e1 {
+    std::unique_ptr<int> data;
+  };
+
+  struct c {
+    auto operator()() {
+      using namespace sml;
+
+      // clang-format off
+      return make_transition_table(
+        * state1 + event<e1> / defer
+        , state1 + event<event1> = state2
+        , state2 + event<e1> / [this](const e1& e) { value = *e.data; } = X
+      );
+      // clang-format on
+    }
+
+    int value = 0;
+  };
+
+  sml::sm<c, sml::defer_queue<std::deque>> sm{};
+  sm.process_event(e1{std::make_unique<int>(42)});
+  expect(sm.is(state1));
+
+  sm.process_event(event1{});
+  expect(sm.is(sml::X));
+
+  const c& c_ = sm;
+  expect(42 == c_.value);
+};
+
+test defer_rvalue_event_without_copies = [] {
+  struct e1 {
+    explicit e1(int& copies) : copies(&copies) {}
+    e1(const e1& other) : copies(other.copies) { ++*copies; }
+    e1(e1&&) = default;
+    int* copies;
+  };
+
+  struct c {
+    auto operator()() {
+      using namespace sml;
+
+      // clang-format off
+      return make_transition_table(
+        * state1 + event<e1> [([](const e1&) { return true; })] / defer
+        , state1 + event<event1> = state2
+        , state2 + event<e1> = X
+      );
+      // clang-format on
+    }
+  };
+
+  auto copies = 0;
+  sml::sm<c, sml::defer_queue<std::deque>> sm{};
+  sm.process_event(e1{copies});
+  sm.process_event(event1{});
+  expect(sm.is(sml::X));
+  expect(0 == copies);
+
+  sml::sm<c, sml::defer_queue<std::deque>> sm2{};
+  const auto event = e1{copies};
+  sm2.process_event(event);
+  sm2.process_event(event1{});
+  expect(sm2.is(sml::X));
+  expect(1 == copies);
+};
+
+struct refresh {
+  static constexpr auto coalesce = true;
+  int value{};
+};
+
+test defer_coalescing_event = [] {
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * state1 + event<refresh> / defer
+        , state1 + event<event2> / defer
+        , state1 + event<event1> = state2
+        , state2 + event<refresh> / [this](const refresh& e) { values.push_back(e.value); }
+        , state2 + event<event2> / [this] { values.push_back(0); }
+      );
+      // clang-format on
+    }
+
+    std::vector<int> values{};
+  };
+
+  sml::sm<c, sml::defer_queue<std::deque>> sm{};
+  sm.process_event(refresh{1});
+  sm.process_event(event2{});
+  sm.process_event(refresh{2});
+  sm.process_event(refresh{3});
+  sm.process_event(event1{});
+  expect(sm.is(state2));
+
+  const c& c_ = sm;
+  expect(std::vector<int>{0, 3} == c_.values);
+};
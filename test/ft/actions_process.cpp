@@ -6,6 +6,7 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 //
 #include <boost/sml.hpp>
+#include <memory>
 #include <queue>
 #include <string>
 #include <utility>
@@ -332,3 +333,90 @@ test process_between_substates = [] {
   expect(sm.is<decltype(sml::state<sub1>)>(sml::X));
   expect(sm.is<decltype(sml::state<sub2>)>(sml::X));
 };
+
+test queue_process_move_only_event = [] {
+  struct e5 {
+    std::unique_ptr<int> data;
+  };
+
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * s1 + event<e1> / [](sml::back::process<e5> processEvent) { processEvent(e5{std::make_unique<int>(42)}); }
+        , s1 + event<e5> / [this](const e5& e) { value = *e.data; } = X
+      );
+      // clang-format on
+    }
+
+    int value = 0;
+  };
+
+  sml::sm<c, sml::process_queue<std::queue>> sm{};
+  sm.process_event(e1{});
+  expect(sm.is(sml::X));
+
+  const c& c_ = sm;
+  expect(42 == c_.value);
+};
+
+struct bulk {};
+struct control {
+  static constexpr auto priority = 1;
+};
+struct emergency {
+  static constexpr auto priority = 2;
+};
+
+test queue_process_events_by_priority = [] {
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * s1 + event<e1> / (process(bulk{}), process(control{}), process(bulk{}), process(emergency{}))
+        , s1 + event<bulk> / [this] { calls.push_back(0); }
+        , s1 + event<control> / [this] { calls.push_back(1); }
+        , s1 + event<emergency> / (process(control{}), [this] { calls.push_back(2); })
+      );
+      // clang-format on
+    }
+
+    std::vector<int> calls{};
+  };
+
+  sml::sm<c, sml::priority_process_queue<std::queue>> sm{};
+  sm.process_event(e1{});
+
+  const c& c_ = sm;
+  expect(std::vector<int>{2, 1, 1, 0, 0} == c_.calls);
+};
+
+struct dirty {
+  static constexpr auto coalesce = true;
+};
+
+test queue_process_coalescing_events = [] {
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * s1 + event<e1> / (process(dirty{}), process(e2{}), process(dirty{}), process(dirty{}))
+        , s1 + event<e2> / [this] { calls.push_back(2); }
+        , s1 + event<dirty> / [this] { calls.push_back(0); }
+      );
+      // clang-format on
+    }
+
+    std::vector<int> calls{};
+  };
+
+  sml::sm<c, sml::process_queue<std::queue>> sm{};
+  sm.process_event(e1{});
+  sm.process_event(e1{});
+
+  const c& c_ = sm;
+  expect(std::vector<int>{2, 0, 2, 0} == c_.calls);
+};
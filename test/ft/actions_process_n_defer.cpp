@@ -1,5 +1,7 @@
 #include <boost/sml.hpp>
+#include <cstddef>
 #include <deque>
+#include <memory>
 #include <queue>
 
 namespace sml = boost::sml;
@@ -16,6 +18,38 @@ const auto s5 = sml::state<class s5>;
 const auto s6 = sml::state<class s6>;
 const auto s7 = sml::state<class s7>;
 
+template <class T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(int& allocations) : allocations(&allocations) {}
+  template <class U>
+  counting_allocator(const counting_allocator<U>& other) : allocations(other.allocations) {}
+
+  T* allocate(std::size_t n) {
+    ++*allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* ptr, std::size_t n) { std::allocator<T>{}.deallocate(ptr, n); }
+
+  template <class U>
+  bool operator==(const counting_allocator<U>& other) const {
+    return allocations == other.allocations;
+  }
+  template <class U>
+  bool operator!=(const counting_allocator<U>& other) const {
+    return allocations != other.allocations;
+  }
+
+  int* allocations;
+};
+
+template <class T>
+using counting_deque = std::deque<T, counting_allocator<T>>;
+
+template <class T>
+using counting_queue = std::queue<T, counting_deque<T>>;
+
 test mix_process_n_defer_at_init = [] {
   struct c {
     auto operator()() {
@@ -64,4 +98,62 @@ test mix_process_n_defer = [] {
   sml::sm<c, sml::process_queue<std::queue>, sml::defer_queue<std::deque>> sm{};
   sm.process_event(e1{});
   expect(sm.is(sml::X));
-};
\ No newline at end of file
+};
+test mix_process_n_defer_move_only_event = [] {
+  struct e4 {
+    std::unique_ptr<int> data;
+  };
+
+  struct c {
+    auto operator()() {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * s1 + event<e1> / [](sml::back::process<e4> processEvent) { processEvent(e4{std::make_unique<int>(42)}); }
+        , s1 + event<e4> / defer
+        , s1 + event<e2> = s2
+        , s2 + event<e4> [([](const e4& e) { return 42 == *e.data; })] = X
+      );
+      // clang-format on
+    }
+  };
+
+  sml::sm<c, sml::process_queue<std::queue>, sml::defer_queue<std::deque>> sm{};
+  sm.process_event(e1{});
+  expect(sm.is(s1));
+  sm.process_event(e2{});
+  expect(sm.is(sml::X));
+};
+
+test mix_process_n_defer_with_allocator = [] {
+  struct c {
+    auto operator()() {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * s1 + event<e1> / defer = s2
+        , s2 / defer = s3
+        , s3 + event<e1> / process(e2{})
+        , s3 + event<e2> / defer = s4
+        , s4 + event<e2> = s5
+        , s5 = s6
+        , s6 + on_entry<_> / process(e3{})
+        , s6 + event<e3> = s7
+        , s7 = X
+      );
+      // clang-format on
+    }
+  };
+
+  auto defer_allocations = 0;
+  auto process_allocations = 0;
+  using defer_allocator = counting_allocator<struct defer>;
+  using process_allocator = counting_allocator<struct process>;
+
+  sml::sm<c, sml::process_queue<counting_queue, process_allocator>, sml::defer_queue<counting_deque, defer_allocator>> sm{
+      defer_allocator{defer_allocations}, process_allocator{process_allocations}};
+  sm.process_event(e1{});
+  expect(sm.is(sml::X));
+  expect(defer_allocations > 0);
+  expect(process_allocations > 0);
+};
@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/actor_runtime.hpp"
+#include <boost/sml.hpp>
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct tick {};
+struct token {
+  int hops{};
+};
+
+test actor_runtime_process_events_sent_from_many_threads = [] {
+  struct counter {
+    int ticks = 0;
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      return make_transition_table(*"idle"_s + event<tick> / [](counter& c) { ++c.ticks; });
+    }
+  };
+
+  constexpr auto actors = 100;
+  constexpr auto senders = 4;
+  constexpr auto ticks = 100;
+
+  sml::utility::actor_runtime runtime{4};
+  std::vector<counter> counters(actors);
+  std::vector<sml::utility::actor<sml::sm<c>>*> refs{};
+  for (auto& counter : counters) {
+    refs.push_back(&runtime.spawn<sml::sm<c>>(counter));
+  }
+
+  std::vector<std::thread> threads{};
+  for (auto i = 0; i < senders; ++i) {
+    threads.emplace_back([&] {
+      for (auto t = 0; t < ticks; ++t) {
+        for (auto actor : refs) {
+          actor->send(tick{});
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  runtime.wait_idle();
+
+  auto all = true;
+  for (const auto& counter : counters) {
+    all &= senders * ticks == counter.ticks;
+  }
+  expect(all);
+};
+
+test actor_runtime_actors_send_to_actors = [] {
+  struct link {
+    std::function<void(int)> send{};
+    int received = 0;
+  };
+
+  struct ring {
+    auto operator()() const {
+      using namespace sml;
+      const auto forward = [](const token& t, link& l) {
+        ++l.received;
+        if (t.hops) {
+          l.send(t.hops - 1);
+        }
+      };
+      return make_transition_table(*"idle"_s + event<token> / forward);
+    }
+  };
+
+  constexpr auto actors = 16;
+  constexpr auto hops = 10000;
+
+  sml::utility::actor_runtime runtime{4};
+  std::vector<link> links(actors);
+  std::vector<sml::utility::actor<sml::sm<ring>>*> refs{};
+  for (auto& l : links) {
+    refs.push_back(&runtime.spawn<sml::sm<ring>>(l));
+  }
+  for (auto i = 0; i < actors; ++i) {
+    const auto next = refs[(i + 1) % actors];
+    links[i].send = [next](const int hops) { next->send(token{hops}); };
+  }
+
+  for (auto actor : refs) {
+    actor->send(token{hops});
+  }
+  runtime.wait_idle();
+
+  auto received = 0;
+  for (const auto& l : links) {
+    received += l.received;
+  }
+  expect(actors * (hops + 1) == received);
+
+  using namespace sml;
+  expect(refs[0]->sm().is("idle"_s));
+};
+
+test actor_runtime_despawn_drains_mailbox = [] {
+  struct counter {
+    int ticks = 0;
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      return make_transition_table(*"idle"_s + event<tick> / [](counter& c) { ++c.ticks; });
+    }
+  };
+
+  constexpr auto actors = 10;
+  constexpr auto ticks = 100;
+
+  sml::utility::actor_runtime runtime{2};
+  std::vector<counter> counters(actors);
+  std::vector<sml::utility::actor<sml::sm<c>>*> refs{};
+  for (auto& counter : counters) {
+    refs.push_back(&runtime.spawn<sml::sm<c>>(counter));
+  }
+  expect(actors == runtime.actors());
+
+  for (auto i = 0; i < actors; ++i) {
+    for (auto t = 0; t < ticks; ++t) {
+      refs[i]->send(tick{});
+    }
+    if (i % 2) {
+      runtime.despawn(*refs[i]);
+    }
+  }
+  runtime.wait_idle();
+
+  auto all = true;
+  for (const auto& counter : counters) {
+    all &= ticks == counter.ticks;
+  }
+  expect(all);
+  expect(actors / 2 == runtime.actors());
+
+  refs[0]->send(tick{});
+  runtime.despawn(*refs[0]);
+  runtime.wait_idle();
+  expect(ticks + 1 == counters[0].ticks);
+  expect(actors / 2 - 1 == runtime.actors());
+};
+
+#if defined(__cpp_impl_coroutine)
+struct detached {
+  struct promise_type : sml::utility::pooled_frame {
+    detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() {}
+  };
+};
+
+test actor_runtime_async_process_event = [] {
+  struct open {};
+  struct close {};
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *"closed"_s + event<open> = "opened"_s
+        , "opened"_s + event<close> = "closed"_s
+        , "opened"_s + event<tick> / defer
+      );
+      // clang-format on
+    }
+  };
+
+  using sm_t = sml::sm<c, sml::defer_queue<std::deque>>;
+  struct results {
+    std::vector<bool> handled{};
+    int done = 0;
+  };
+
+  const auto client = [](sml::utility::actor<sm_t>& a, results& r) -> detached {
+    r.handled.push_back(co_await a.async_process_event(close{}));
+    r.handled.push_back(co_await a.async_process_event(open{}));
+    r.handled.push_back(co_await a.async_process_event(tick{}));
+    r.handled.push_back(co_await a.async_process_event(close{}));
+    ++r.done;
+  };
+
+  sml::utility::actor_runtime runtime{2};
+  auto& a = runtime.spawn<sm_t>();
+  results r{};
+  client(a, r);
+  runtime.wait_idle();
+
+  expect(1 == r.done);
+  expect((std::vector<bool>{false, true, true, true}) == r.handled);
+  using namespace sml;
+  expect(a.sm().is("closed"_s));
+};
+
+test actor_runtime_async_process_event_many_clients = [] {
+  struct counter {
+    int ticks = 0;
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      return make_transition_table(*"idle"_s + event<tick> / [](counter& c) { ++c.ticks; });
+    }
+  };
+
+  constexpr auto clients = 64;
+  constexpr auto ticks = 100;
+
+  const auto client = [](sml::utility::actor<sml::sm<c>>& a, std::atomic<int>& handled) -> detached {
+    for (auto i = 0; i < ticks; ++i) {
+      handled += co_await a.async_process_event(tick{});
+    }
+  };
+
+  sml::utility::actor_runtime runtime{4};
+  counter counter{};
+  auto& a = runtime.spawn<sml::sm<c>>(counter);
+  std::atomic<int> handled{0};
+  for (auto i = 0; i < clients; ++i) {
+    client(a, handled);
+  }
+  runtime.wait_idle();
+
+  expect(clients * ticks == handled);
+  expect(clients * ticks == counter.ticks);
+};
+
+test actor_runtime_frame_pool = [] {
+  using sml::utility::detail::frame_pool;
+  const auto frame = frame_pool::allocate(100);
+  frame_pool::deallocate(frame, 100);
+  expect(frame == frame_pool::allocate(128));
+  frame_pool::deallocate(frame, 128);
+
+  const auto large = frame_pool::allocate(4096);
+  frame_pool::deallocate(large, 4096);
+};
+#endif
@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/fleet.hpp"
+#include <boost/sml.hpp>
+#include <deque>
+#include <string>
+
+namespace sml = boost::sml;
+
+struct e1 {};
+struct e2 {};
+struct e3 {};
+
+const auto idle = sml::state<class idle>;
+const auto s1 = sml::state<class s1>;
+const auto s2 = sml::state<class s2>;
+
+test fleet_instances_are_independent = [] {
+  struct counter {
+    int entries = 0;
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+       *idle + event<e1> = s1,
+        s1 + sml::on_entry<_> / [](counter& c) { ++c.entries; },
+        s1 + event<e2> = s2,
+        s2 + event<e3> = X
+      );
+      // clang-format on
+    }
+  };
+
+  counter cnt{};
+  sml::utility::fleet<sml::sm<c>> fleet{3, cnt};
+  expect(3u == fleet.size());
+  expect(1 == sml::sm<c>::instance_size());
+
+  expect(fleet.process_event(0, e1{}));
+  expect(fleet.process_event(2, e1{}));
+  expect(fleet.process_event(2, e2{}));
+  expect(!fleet.process_event(1, e2{}));
+  expect(2 == cnt.entries);
+
+  expect(fleet.is(0, s1));
+  expect(fleet.is(1, idle));
+  expect(fleet.is(2, s2));
+
+  fleet.resize(4);
+  expect(fleet.is(3, idle));
+  expect(fleet.process_event(2, e3{}));
+  expect(fleet.is(2, sml::X));
+  expect(fleet.is(0, s1));
+};
+
+test fleet_orthogonal_regions_and_sub_state_machines = [] {
+  struct sub {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+       *idle + event<e2> = s1,
+        s1 + event<e2> = s2
+      );
+      // clang-format on
+    }
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+       *idle + event<e1> = state<sub>,
+        state<sub> + event<e3> = idle,
+       *s1 + event<e3> = s2
+      );
+      // clang-format on
+    }
+  };
+
+  using sm_t = sml::sm<c>;
+  expect(3 == sm_t::instance_size());
+
+  sml::utility::fleet<sm_t> fleet{2};
+  fleet.process_event(0, e1{});
+  fleet.process_event(0, e2{});
+  fleet.process_event(1, e1{});
+  fleet.process_event(1, e2{});
+  fleet.process_event(1, e2{});
+
+  expect(fleet.is(0, sml::state<sub>, s1));
+  expect(fleet.is(1, sml::state<sub>, s1));
+
+  std::string states{};
+  fleet.visit_current_states(1, [&](auto state) { states += state.c_str(); });
+  expect(states.find("sub") != std::string::npos);
+
+  fleet.process_event(0, e3{});
+  expect(fleet.is(0, idle, s2));
+  expect(fleet.is(1, sml::state<sub>, s1));
+
+  fleet.process_event(1, e3{});
+  fleet.process_event(1, e1{});
+  expect(fleet.is(1, sml::state<sub>, s2));
+};
+
+test fleet_deferred_events_per_instance = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+       *idle + event<e1> / defer,
+        idle + event<e2> = s1,
+        s1 + event<e1> = s2
+      );
+      // clang-format on
+    }
+  };
+
+  sml::utility::fleet<sml::sm<c, sml::defer_queue<std::deque>>> fleet{2};
+  fleet.process_event(0, e1{});
+  fleet.process_event(1, e2{});
+  expect(fleet.is(1, s1));
+
+  fleet.process_event(0, e2{});
+  expect(fleet.is(0, s2));
+  expect(fleet.is(1, s1));
+};
+
+struct heartbeat {};
+
+test fleet_broadcast = [] {
+  struct counter {
+    int alarms = 0;
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+       *idle + event<heartbeat> = s1,
+        s1 + event<heartbeat> = s2,
+        s2 + event<heartbeat> / [](counter& c) { ++c.alarms; } = idle,
+        s2 + event<e1> = idle
+      );
+      // clang-format on
+    }
+  };
+
+  constexpr auto size = 100u;
+  counter cnt{};
+  sml::utility::fleet<sml::sm<c>> fleet{size, cnt};
+  for (auto i = 0u; i < size; i += 3) {
+    fleet.process_event(i, heartbeat{});
+  }
+
+  fleet.broadcast(heartbeat{});
+  expect(0 == cnt.alarms);
+  for (auto i = 0u; i < size; ++i) {
+    expect(i % 3 ? fleet.is(i, s1) : fleet.is(i, s2));
+  }
+
+  fleet.broadcast(heartbeat{});
+  expect(34 == cnt.alarms);
+  for (auto i = 0u; i < size; ++i) {
+    expect(i % 3 ? fleet.is(i, s2) : fleet.is(i, idle));
+  }
+
+  fleet.broadcast(e1{});
+  for (auto i = 0u; i < size; ++i) {
+    expect(fleet.is(i, idle));
+  }
+};
+
+test fleet_broadcast_orthogonal_regions = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+       *idle + event<heartbeat> = s1,
+       *s2 + event<heartbeat> [([] { return true; })] = X
+      );
+      // clang-format on
+    }
+  };
+
+  sml::utility::fleet<sml::sm<c>> fleet{10};
+  fleet.broadcast(heartbeat{});
+  for (auto i = 0u; i < fleet.size(); ++i) {
+    expect(fleet.is(i, s1, sml::X));
+  }
+};
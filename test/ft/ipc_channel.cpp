@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/ipc_channel.hpp"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/sml.hpp>
+#include <string>
+#include <type_traits>
+
+namespace sml = boost::sml;
+
+struct packet {
+  long sequence{};
+  int bytes{};
+};
+struct reset_stream {};
+struct label {  // not trivially copyable, can't be sent
+  std::string name{};
+};
+
+struct stream {
+  long expected = 0;
+  long bytes = 0;
+  long resets = 0;
+  bool in_order = true;
+};
+
+const auto receiving = sml::state<class receiving>;
+
+struct protocol {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *receiving + event<packet> / [](const packet& p, stream& s) {
+          s.in_order &= p.sequence == s.expected++;
+          s.bytes += p.bytes;
+        }
+      , receiving + event<reset_stream> / [](stream& s) { ++s.resets; }
+      , receiving + event<label> / [] {}
+    );
+    // clang-format on
+  }
+};
+
+using protocol_sm = sml::sm<protocol>;
+
+test ipc_channel_events = [] {
+  using channel_t = sml::utility::ipc_channel<protocol_sm, 4>;
+  static_assert(std::is_same<sml::aux::type_list<packet, reset_stream>, channel_t::events>::value, "");
+  const auto fd = ::memfd_create("channel", 0);
+  sml::utility::shared_segment segment{fd, channel_t::segment_size()};
+  channel_t producer{segment.data(), segment.size()};
+  channel_t consumer{segment.data(), segment.size()};
+  expect(producer.valid() && consumer.valid());
+  expect(4u == channel_t::capacity());
+
+  stream s{};
+  protocol_sm sm{s};
+  expect(0u == consumer.poll(sm));
+  expect(0u == consumer.run_once(sm, 1));  // timed out
+
+  expect(producer.try_send(packet{0, 10}));
+  expect(producer.try_send(reset_stream{}));
+  expect(producer.try_send(packet{1, 20}));
+  expect(producer.try_send(packet{2, 30}));
+  expect(!producer.try_send(packet{3, 40}));  // full
+  expect(4u == consumer.size());
+
+  expect(1u == consumer.poll(sm, 1));
+  expect(10 == s.bytes);
+  expect(producer.try_send(packet{3, 40}));
+  expect(4u == consumer.run_once(sm));
+  expect(100 == s.bytes);
+  expect(1 == s.resets);
+  expect(s.in_order);
+  expect(0u == consumer.size());
+
+  using other_t = sml::utility::ipc_channel<protocol_sm, 8>;
+  sml::utility::shared_segment other_segment{fd, other_t::segment_size()};
+  other_t other{other_segment.data(), other_segment.size()};  // different layout
+  expect(!other.valid());
+  ::close(fd);
+};
+
+test ipc_channel_drops_slots_with_unknown_event_id = [] {
+  using channel_t = sml::utility::ipc_channel<protocol_sm, 4>;
+  const auto fd = ::memfd_create("channel", 0);
+  sml::utility::shared_segment segment{fd, channel_t::segment_size()};
+  channel_t producer{segment.data(), segment.size()};
+  channel_t consumer{segment.data(), segment.size()};
+
+  stream s{};
+  protocol_sm sm{s};
+  expect(producer.try_send(packet{0, 10}));
+  expect(producer.try_send(packet{1, 20}));
+  auto& id = *reinterpret_cast<int*>(static_cast<char*>(segment.data()) + 3 * 64);  // first slot, after the indexes
+  expect(0 == id);
+  id = 42;
+
+  expect(2u == consumer.poll(sm));
+  expect(1u == consumer.dropped());
+  expect(20 == s.bytes);
+  expect(0u == consumer.size());
+  ::close(fd);
+};
+
+test ipc_channel_between_processes = [] {
+  constexpr long events = 1'000'000;
+  using channel_t = sml::utility::ipc_channel<protocol_sm, 256>;
+  const auto fd = ::memfd_create("channel", 0);
+  const auto producer = ::fork();
+  if (!producer) {
+    sml::utility::shared_segment segment{fd, channel_t::segment_size()};
+    channel_t channel{segment.data(), segment.size()};
+    for (auto i = 0l; i < events; ++i) {
+      channel.send(packet{i, 1});
+      if (!(i % 100'000)) {
+        channel.send(reset_stream{});
+        ::usleep(1000);  // lets the consumer fall asleep
+      }
+    }
+    ::_exit(channel.valid() ? 0 : 1);
+  }
+
+  sml::utility::shared_segment segment{fd, channel_t::segment_size()};
+  channel_t channel{segment.data(), segment.size()};
+  stream s{};
+  protocol_sm sm{s};
+  auto processed = 0l;
+  while (processed < events + events / 100'000) {
+    const auto n = channel.run_once(sm);
+    expect(n <= channel_t::capacity());
+    processed += static_cast<long>(n);
+  }
+  int status{};
+  ::waitpid(producer, &status, 0);
+  expect(WIFEXITED(status) && !WEXITSTATUS(status));
+  expect(events == s.expected);
+  expect(events == s.bytes);
+  expect(events / 100'000 == s.resets);
+  expect(s.in_order);
+  ::close(fd);
+};
@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include <boost/sml.hpp>
+#include <boost/sml/utility/fleet.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct e1 {};
+struct e2 {};
+
+const auto idle = sml::state<class idle>;
+const auto s1 = sml::state<class s1>;
+const auto s2 = sml::state<class s2>;
+
+test occupancy_counts_instances = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> = s1
+        , s1 + event<e1> = s1
+        , s1 + event<e2> = s2
+      );
+      // clang-format on
+    }
+  };
+
+  using sm_t = sml::sm<c, sml::occupancy<std::atomic>>;
+  expect(0 == sm_t::occupancy(idle));
+
+  {
+    sm_t sm1{};
+    sm_t sm2{};
+    expect(2 == sm_t::occupancy(idle));
+    expect(0 == sm_t::occupancy(s1));
+
+    sm1.process_event(e1{});
+    expect(1 == sm_t::occupancy(idle));
+    expect(1 == sm1.occupancy(s1));
+
+    sm1.process_event(e1{});
+    expect(1 == sm_t::occupancy(s1));
+
+    sm1.process_event(e2{});
+    sm2.process_event(e1{});
+    expect(0 == sm_t::occupancy(idle));
+    expect(1 == sm_t::occupancy(s1));
+    expect(1 == sm_t::occupancy(s2));
+  }
+
+  expect(0 == sm_t::occupancy(idle));
+  expect(0 == sm_t::occupancy(s1));
+  expect(0 == sm_t::occupancy(s2));
+};
+
+test occupancy_orthogonal_regions_and_sub_sms = [] {
+  struct sub {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *"s1"_s + event<e1> = "s2"_s
+      );
+      // clang-format on
+    }
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> = state<sub>
+        , state<sub> + event<e2> = idle
+        ,*"a"_s + event<e2> = "b"_s
+      );
+      // clang-format on
+    }
+  };
+
+  using namespace sml;
+  using sm_t = sml::sm<c, sml::occupancy<std::atomic>>;
+  sm_t sm{};
+  expect(1 == sm_t::occupancy(idle));
+  expect(1 == sm_t::occupancy("a"_s));
+  expect(1 == sm_t::occupancy<decltype(state<sub>)>("s1"_s));
+
+  sm.process_event(e1{});
+  expect(1 == sm_t::occupancy(state<sub>));
+  sm.process_event(e1{});
+  expect(0 == sm_t::occupancy<decltype(state<sub>)>("s1"_s));
+  expect(1 == sm_t::occupancy<decltype(state<sub>)>("s2"_s));
+
+  sm.process_event(e2{});
+  expect(1 == sm_t::occupancy(idle));
+  expect(1 == sm_t::occupancy("b"_s));
+
+  sm.process_event(e1{});  // enters sub from its initial state
+  expect(1 == sm_t::occupancy<decltype(state<sub>)>("s1"_s));
+  expect(0 == sm_t::occupancy<decltype(state<sub>)>("s2"_s));
+};
+
+test occupancy_sharded_counters = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> = s1
+        , s1 + event<e1> = idle
+      );
+      // clang-format on
+    }
+  };
+
+  using sm_t = sml::sm<c, sml::occupancy<std::atomic, 4>>;
+  constexpr auto threads = 4;
+  constexpr auto instances = 64;
+  std::vector<std::unique_ptr<sm_t>> sms{};
+  for (auto i = 0; i < threads * instances; ++i) {
+    sms.emplace_back(new sm_t{});
+  }
+
+  std::vector<std::thread> workers{};
+  for (auto t = 0; t < threads; ++t) {
+    workers.emplace_back([&sms, t] {
+      for (auto i = 0; i < instances; ++i) {
+        for (auto n = 0; n < 1 + i % 2; ++n) {
+          sms[t * instances + i]->process_event(e1{});
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  expect(threads * instances / 2 == sm_t::occupancy(idle));
+  expect(threads * instances / 2 == sm_t::occupancy(s1));
+  sms.clear();
+  expect(0 == sm_t::occupancy(idle));
+  expect(0 == sm_t::occupancy(s1));
+};
+
+test occupancy_fleet = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> = s1
+        , s1 + event<e2> = s2
+      );
+      // clang-format on
+    }
+  };
+
+  using sm_t = sml::sm<c, sml::occupancy<std::atomic>>;
+  {
+    sml::utility::fleet<sm_t> fleet{8};
+    expect(8 == sm_t::occupancy(idle));
+
+    fleet.process_event(3, e1{});
+    fleet.process_event(5, e1{});
+    fleet.process_event(5, e2{});
+    expect(6 == sm_t::occupancy(idle));
+    expect(1 == sm_t::occupancy(s1));
+    expect(1 == sm_t::occupancy(s2));
+
+    fleet.broadcast(e1{});
+    expect(0 == sm_t::occupancy(idle));
+    expect(7 == sm_t::occupancy(s1));
+
+    fleet.resize(4);
+    expect(4 == sm_t::occupancy(s1));
+    expect(0 == sm_t::occupancy(s2));
+
+    fleet.resize(6);
+    expect(2 == sm_t::occupancy(idle));
+  }
+
+  expect(0 == sm_t::occupancy(idle));
+  expect(0 == sm_t::occupancy(s1));
+  expect(0 == sm_t::occupancy(s2));
+};
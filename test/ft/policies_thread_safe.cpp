@@ -6,9 +6,12 @@
 // http://www.boost.org/LICENSE_1_0.txt)
 //
 #include <boost/sml.hpp>
+#include <atomic>
+#include <functional>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace sml = boost::sml;
 
@@ -66,3 +69,377 @@ test process_event_reentrant = [] {
   // Hangs forever awaiting lock if mutex is not reentrant.
   sm.process_event(e1{});
 };
+
+test seqlock_snapshot_states = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *"a1"_s + event<e1> = "a2"_s
+        , "a2"_s + event<e1> = "a1"_s
+        ,*"b1"_s + event<e1> = "b2"_s
+        , "b2"_s + event<e1> = "b1"_s
+      );
+      // clang-format on
+    }
+  };
+
+  using namespace sml;
+  sml::sm<c, sml::thread_safe<std::mutex>, sml::seqlock<std::atomic>> sm{};
+  expect(sm.is("a1"_s, "b1"_s));
+
+  std::atomic<bool> done{false};
+  std::thread writer{[&] {
+    for (auto i = 0; i < 10000; ++i) {
+      sm.process_event(e1{});
+    }
+    done = true;
+  }};
+
+  auto consistent = true;
+  while (!done) {
+    const auto snapshot = sm.snapshot_states();
+    consistent &= snapshot.is("a1"_s, "b1"_s) || snapshot.is("a2"_s, "b2"_s);
+  }
+  writer.join();
+
+  expect(consistent);
+  expect(sm.is("a1"_s, "b1"_s));
+};
+
+test seqlock_snapshot_states_wider_than_word = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *"a1"_s + event<e1> = "a2"_s
+        , "a2"_s + event<e1> = "a1"_s
+        ,*"b1"_s + event<e1> = "b2"_s
+        , "b2"_s + event<e1> = "b1"_s
+        ,*"c1"_s + event<e1> = "c2"_s
+        , "c2"_s + event<e1> = "c1"_s
+        ,*"d1"_s + event<e1> = "d2"_s
+        , "d2"_s + event<e1> = "d1"_s
+        ,*"e1"_s + event<e1> = "e2"_s
+        , "e2"_s + event<e1> = "e1"_s
+        ,*"f1"_s + event<e1> = "f2"_s
+        , "f2"_s + event<e1> = "f1"_s
+        ,*"g1"_s + event<e1> = "g2"_s
+        , "g2"_s + event<e1> = "g1"_s
+        ,*"h1"_s + event<e1> = "h2"_s
+        , "h2"_s + event<e1> = "h1"_s
+        ,*"i1"_s + event<e1> = "i2"_s
+        , "i2"_s + event<e1> = "i1"_s
+      );
+      // clang-format on
+    }
+  };
+
+  using namespace sml;
+  sml::sm<c, sml::thread_safe<std::mutex>, sml::seqlock<std::atomic>> sm{};
+
+  std::atomic<bool> done{false};
+  std::thread writer{[&] {
+    for (auto i = 0; i < 10000; ++i) {
+      sm.process_event(e1{});
+    }
+    done = true;
+  }};
+
+  auto consistent = true;
+  while (!done) {
+    const auto snapshot = sm.snapshot_states();
+    consistent &= snapshot.is("a1"_s, "b1"_s, "c1"_s, "d1"_s, "e1"_s, "f1"_s, "g1"_s, "h1"_s, "i1"_s) ||
+                  snapshot.is("a2"_s, "b2"_s, "c2"_s, "d2"_s, "e2"_s, "f2"_s, "g2"_s, "h2"_s, "i2"_s);
+  }
+  writer.join();
+
+  expect(consistent);
+  expect(sm.is("a1"_s, "b1"_s, "c1"_s, "d1"_s, "e1"_s, "f1"_s, "g1"_s, "h1"_s, "i1"_s));
+};
+
+test thread_safe_regions_lock_only_affected_regions = [] {
+  struct flags {
+    std::atomic<bool> linking{false};
+    std::atomic<bool> powered{false};
+  };
+
+  struct link_up {};
+  struct power_on {};
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      const auto wait_for_power = [](flags& f) {
+        f.linking = true;
+        while (!f.powered) {
+          std::this_thread::yield();
+        }
+      };
+      // clang-format off
+      return make_transition_table(
+         *"link_down"_s + event<link_up> / wait_for_power = "link_up"_s
+        ,*"power_off"_s + event<power_on> / [](flags& f) { f.powered = true; } = "power_on"_s
+      );
+      // clang-format on
+    }
+  };
+
+  flags f{};
+  sml::sm<c, sml::thread_safe_regions<std::mutex>> sm{f};
+
+  // Hangs forever if processing `link_up` holds the lock of the power region.
+  std::thread link{[&] { sm.process_event(link_up{}); }};
+  while (!f.linking) {
+    std::this_thread::yield();
+  }
+  sm.process_event(power_on{});
+  link.join();
+
+  using namespace sml;
+  expect(sm.is("link_up"_s, "power_on"_s));
+};
+
+struct thread_per_region {
+  template <class F>
+  void bulk_execute(F&& f, const int n) {
+    std::vector<std::thread> threads{};
+    for (auto i = 0; i < n; ++i) {
+      threads.emplace_back([&f, i] { f(i); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+struct rendezvous {
+  static constexpr auto thread_safe = true;
+  std::atomic<int> arrived{0};
+};
+
+test parallel_regions_dispatch = [] {
+  struct physics {
+    int steps = 0;
+  };
+  struct render {
+    int frames = 0;
+  };
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // wait for the other region, which only returns if regions are dispatched in parallel
+      const auto meet = [](rendezvous& r) {
+        ++r.arrived;
+        while (r.arrived != 2) {
+          std::this_thread::yield();
+        }
+      };
+      // clang-format off
+      return make_transition_table(
+         *"idle"_s + event<e1> / (meet, [](physics& p) { ++p.steps; }) = "simulating"_s
+        ,*"blank"_s + event<e1> / (meet, [](render& r) { ++r.frames; }) = "rendering"_s
+      );
+      // clang-format on
+    }
+  };
+
+  thread_per_region executor{};
+  rendezvous r{};
+  physics p{};
+  render rr{};
+  sml::sm<c, sml::parallel_regions<thread_per_region>> sm{executor, r, p, rr};
+  expect(sm.process_event(e1{}));
+
+  using namespace sml;
+  expect(sm.is("simulating"_s, "rendering"_s));
+  expect(2 == r.arrived);
+  expect(1 == p.steps);
+  expect(1 == rr.frames);
+};
+
+struct counting_mutex {
+  void lock() {
+    ++locks;
+    mutex.lock();
+  }
+  void unlock() { mutex.unlock(); }
+
+  static std::atomic<int> locks;
+  std::mutex mutex{};
+};
+std::atomic<int> counting_mutex::locks{0};
+
+test process_events_takes_the_lock_once = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> / [](int& n) { ++n; } = s1
+        , s1 + event<e2> / [](int& n) { ++n; } = idle
+        , *"a"_s + event<e1> = "b"_s
+      );
+      // clang-format on
+    }
+  };
+
+  int n = 0;
+  sml::sm<c, sml::thread_safe<counting_mutex>> sm{n};
+  std::vector<e1> events(100);
+  counting_mutex::locks = 0;
+  expect(1 == sm.process_events(events.begin(), events.end()));
+  expect(1 == counting_mutex::locks);
+
+  std::vector<e2> others(100);
+  std::thread t{[&] {
+    for (auto i = 0; i < 100; ++i) {
+      sm.process_event(e1{});
+    }
+  }};
+  sm.process_events(others.begin(), others.end());
+  t.join();
+  expect(1 + 100 + 1 == counting_mutex::locks);
+  using namespace sml;
+  expect(sm.is(idle, "b"_s) || sm.is(s1, "b"_s));
+};
+
+struct counting_recursive_mutex {
+  void lock() {
+    ++locks;
+    mutex.lock();
+  }
+  void unlock() { mutex.unlock(); }
+
+  static std::atomic<int> locks;
+  std::recursive_mutex mutex{};
+};
+std::atomic<int> counting_recursive_mutex::locks{0};
+
+test process_events_locks_reentrant_and_concurrent_calls = [] {
+  struct hooks {
+    std::function<void()> reenter{};
+    int reentered = 0;
+    int others = 0;
+  };
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> / [](hooks& h) { ++h.reentered; h.reenter(); } = s1
+        , s1 + event<e1> / [](hooks& h) { ++h.reentered; h.reenter(); } = idle
+        , *"a"_s + event<e2> / [](hooks& h) { ++h.others; }
+      );
+      // clang-format on
+    }
+  };
+
+  constexpr auto events = 100;
+  hooks h{};
+  sml::sm<c, sml::thread_safe<counting_recursive_mutex>> sm{h};
+  h.reenter = [&] { sm.process_event(e2{}); };
+  counting_recursive_mutex::locks = 0;
+
+  std::vector<e1> batch(events);
+  std::thread t{[&] {
+    for (auto i = 0; i < events; ++i) {
+      sm.process_event(e2{});
+    }
+  }};
+  expect(events == sm.process_events(batch.begin(), batch.end()));
+  t.join();
+
+  expect(events == h.reentered);
+  expect(2 * events == h.others);
+  // the batch lock covers the events of the range only, re-entrant and concurrent calls lock as usual
+  expect(1 + events + events == counting_recursive_mutex::locks);
+  using namespace sml;
+  expect(sm.is(idle, "a"_s));
+};
+
+test optimistic_thread_safe_commits_action_free_transitions = [] {
+  struct e3 {};
+  struct status {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> = s1
+        , s1 + event<e2> [([](const int& n) { return n >= 0; })] = idle
+        , s1 + event<e3> / [](int& n) { ++n; } = s2
+        , s2 + event<e2> = idle
+        , *"a"_s + event<e1> = "b"_s
+        , "b"_s + event<e2> = "a"_s
+      );
+      // clang-format on
+    }
+  };
+
+  constexpr auto threads = 4;
+  constexpr auto events = 10000;
+  int n = 0;
+  sml::sm<status, sml::optimistic_thread_safe<counting_mutex, std::atomic>> sm{n};
+  counting_mutex::locks = 0;
+
+  std::atomic<int> opened{0}, closed{0};
+  std::vector<std::thread> workers{};
+  for (auto t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      for (auto i = 0; i < events; ++i) {
+        opened += sm.process_event(e1{});
+        closed += sm.process_event(e2{});
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  expect(0 == counting_mutex::locks);  // lock-free
+  expect(opened == closed);
+  using namespace sml;
+  expect(sm.is(idle, "a"_s));
+
+  expect(sm.process_event(e1{}));
+  expect(sm.process_event(e3{}));  // the action takes the lock
+  expect(1 == counting_mutex::locks);
+  expect(1 == n);
+  expect(sm.is(s2, "b"_s));
+  expect(sm.process_event(e2{}));  // the lock-free commit sees states of the locked one
+  expect(sm.is(idle, "a"_s));
+  expect(1 == counting_mutex::locks);
+
+  std::vector<e1> batch(3);
+  expect(1 == sm.process_events(batch.begin(), batch.end()));  // action-free events of the batch use its lock
+  expect(2 == counting_mutex::locks);
+  expect(sm.is(s1, "b"_s));
+};
+
+test optimistic_thread_safe_locks_generic_actions = [] {
+  struct status {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+         *idle + event<e1> = s1
+        , s1 + event<_> / [](int& n) { ++n; } = idle
+      );
+      // clang-format on
+    }
+  };
+
+  int n = 0;
+  sml::sm<status, sml::optimistic_thread_safe<counting_mutex, std::atomic>> sm{n};
+  counting_mutex::locks = 0;
+  expect(sm.process_event(e1{}));  // `_` transitions are mapped to `e1` as well
+  expect(1 == counting_mutex::locks);
+  using namespace sml;
+  expect(sm.is(s1));
+  expect(sm.process_event(e1{}));  // the action of `_` takes the lock
+  expect(2 == counting_mutex::locks);
+  expect(1 == n);
+  expect(sm.is(idle));
+};
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/process_batch.hpp"
+#include <boost/sml.hpp>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "boost/sml/utility/fleet.hpp"
+
+namespace sml = boost::sml;
+
+struct tick {};
+struct reset {};
+
+const auto idle = sml::state<class idle>;
+const auto s1 = sml::state<class s1>;
+const auto s2 = sml::state<class s2>;
+
+struct counter {
+  int entries = 0;
+  int alarms = 0;
+};
+
+struct c {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+     *idle + event<tick> = s1,
+      s1 + sml::on_entry<_> / [](counter& c) { ++c.entries; },
+      s1 + event<tick> [([](counter& c) { return c.entries > 0; })] = s2,
+      s2 + event<tick> / [](counter& c) { ++c.alarms; },
+      s2 + event<reset> = idle
+    );
+    // clang-format on
+  }
+};
+
+test process_batch_array_of_state_machines = [] {
+  counter cnt{};
+  std::vector<sml::sm<c>> sms(4, sml::sm<c>{cnt});
+  sms[1].process_event(tick{});
+  sms[2].process_event(tick{});
+  sms[2].process_event(tick{});
+  expect(2 == cnt.entries);
+
+  const std::vector<std::pair<std::size_t, tick>> batch = {{0, tick{}}, {1, tick{}}, {2, tick{}}, {0, tick{}}, {3, tick{}}};
+  bool handled[5]{};
+  sml::utility::process_batch(sms.data(), batch.begin(), batch.end(), handled);
+  for (const auto h : handled) {
+    expect(h);
+  }
+
+  expect(sms[0].is(s2));
+  expect(sms[1].is(s2));
+  expect(sms[2].is(s2));
+  expect(sms[3].is(s1));
+  expect(4 == cnt.entries);
+  expect(1 == cnt.alarms);
+
+  const std::vector<std::pair<std::size_t, reset>> resets = {{0, reset{}}, {3, reset{}}};
+  std::vector<bool> reset_handled(2);
+  sml::utility::process_batch(sms.data(), resets.begin(), resets.end(), reset_handled.begin());
+  expect(reset_handled[0] && !reset_handled[1]);
+  expect(sms[0].is(idle));
+  expect(sms[3].is(s1));
+};
+
+test process_batch_fleet = [] {
+  counter cnt{};
+  sml::utility::fleet<sml::sm<c>> fleet{100, cnt};
+
+  std::vector<std::pair<std::size_t, tick>> batch{};
+  for (auto i = 0u; i < fleet.size(); ++i) {
+    for (auto n = 0u; n < i % 4; ++n) {
+      batch.emplace_back(i, tick{});
+    }
+  }
+  std::vector<char> handled(batch.size());
+  fleet.process_batch(batch.begin(), batch.end(), handled.begin());
+
+  for (const auto h : handled) {
+    expect(h);
+  }
+  for (auto i = 0u; i < fleet.size(); ++i) {
+    switch (i % 4) {
+      case 0:
+        expect(fleet.is(i, idle));
+        break;
+      case 1:
+        expect(fleet.is(i, s1));
+        break;
+      default:
+        expect(fleet.is(i, s2));
+    }
+  }
+  expect(75 == cnt.entries);
+  expect(25 == cnt.alarms);
+};
+
+/// runs `race` on another thread right before the lock is taken, as if that thread had won the lock
+struct racing_mutex {
+  void lock() {
+    if (race) {
+      const auto r = race;
+      race = nullptr;
+      std::thread{r}.join();
+    }
+    mutex.lock();
+  }
+  void unlock() { mutex.unlock(); }
+
+  static std::function<void()> race;
+  std::mutex mutex{};
+};
+std::function<void()> racing_mutex::race{};
+
+test process_batch_rechecks_the_state_under_the_lock = [] {
+  counter cnt{};
+  sml::sm<c, sml::thread_safe<racing_mutex>> sm{cnt};
+  sm.process_event(tick{});
+  sm.process_event(tick{});
+  expect(sm.is(s2));
+
+  racing_mutex::race = [&] { sm.process_event(reset{}); };
+  const std::vector<std::pair<std::size_t, tick>> batch = {{0, tick{}}};
+  bool handled[1]{};
+  sml::utility::process_batch(&sm, batch.begin(), batch.end(), handled);  // grouped as s2, processed in idle
+  expect(handled[0]);
+  expect(!racing_mutex::race);
+  expect(sm.is(s1));
+  expect(2 == cnt.entries);
+  expect(0 == cnt.alarms);
+};
@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/reactor.hpp"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <boost/sml.hpp>
+#include <deque>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct data_ready {
+  int fd{};
+};
+struct space_ready {
+  int fd{};
+};
+struct peer_closed {
+  int fd{};
+};
+
+const auto connected = sml::state<class connected>;
+const auto disconnected = sml::state<class disconnected>;
+
+struct channel {
+  sml::utility::reactor& reactor;
+  int bytes = 0;
+  int writes = 0;
+};
+
+struct session {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *connected + event<data_ready> / [](const data_ready& e, channel& c) {
+          char buffer[64];
+          const auto n = ::read(e.fd, buffer, sizeof(buffer));
+          c.bytes += n > 0 ? static_cast<int>(n) : 0;
+        }
+      , connected + event<space_ready> / [](const space_ready& e, channel& c) {
+          ++c.writes;
+          c.reactor.remove(e.fd);
+        }
+      , connected + event<peer_closed> / [](const peer_closed& e, channel& c) { c.reactor.remove(e.fd); } = disconnected
+    );
+    // clang-format on
+  }
+};
+
+using session_sm = sml::sm<session>;
+using none = sml::utility::reactor::none;
+
+std::vector<sml::utility::reactor_backend> backends() {
+  std::vector<sml::utility::reactor_backend> backends{sml::utility::reactor_backend::epoll};
+  if (sml::utility::reactor{{sml::utility::reactor_backend::io_uring}}.backend() ==
+      sml::utility::reactor_backend::io_uring) {
+    backends.push_back(sml::utility::reactor_backend::io_uring);
+  }
+  return backends;
+}
+
+test reactor_selects_backend = [] {
+  sml::utility::reactor reactor{};
+  expect(reactor.backend() == sml::utility::reactor_backend::io_uring ||
+         reactor.backend() == sml::utility::reactor_backend::epoll);
+  expect(0u == reactor.size());
+  expect(0u == reactor.run_once(0));
+  expect(!reactor.remove(0));
+};
+
+test reactor_readable_and_hangup = [] {
+  for (const auto backend : backends()) {
+    sml::utility::reactor reactor{{backend}};
+    expect(backend == reactor.backend());
+    int fds[2];
+    expect(!::pipe(fds));
+    channel c{reactor};
+    session_sm sm{c};
+    expect(reactor.add<data_ready, none, peer_closed>(fds[0], sm));
+    expect(!reactor.add<data_ready>(fds[0], sm));
+    expect(1u == reactor.size());
+
+    expect(0u == reactor.run_once(0));
+    expect(5 == ::write(fds[1], "hello", 5));
+    expect(1u == reactor.run_once());
+    expect(5 == c.bytes);
+    expect(0u == reactor.run_once(0));  // consumed
+
+    expect(3 == ::write(fds[1], "sml", 3));
+    ::close(fds[1]);
+    while (reactor.size()) {
+      reactor.run_once(100);
+    }
+    expect(8 == c.bytes);
+    expect(sm.is(disconnected));
+    ::close(fds[0]);
+  }
+};
+
+test reactor_writable = [] {
+  for (const auto backend : backends()) {
+    sml::utility::reactor reactor{{backend}};
+    int fds[2];
+    expect(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    channel c{reactor};
+    session_sm sm{c};
+    expect(reactor.add<none, space_ready>(fds[0], sm));
+    expect(1u == reactor.run_once(100));
+    expect(1 == c.writes);
+    expect(0u == reactor.size());  // removed by the handler
+    expect(0u == reactor.run_once(0));
+    ::close(fds[0]);
+    ::close(fds[1]);
+  }
+};
+
+test reactor_batches_many_descriptors = [] {
+  constexpr auto sessions = 100;
+  for (const auto backend : backends()) {
+    sml::utility::reactor reactor{{backend, 8}};
+    std::vector<int> fds(sessions * 2);
+    std::vector<channel> channels(sessions, channel{reactor});
+    std::deque<session_sm> sms{};
+    for (auto i = 0; i < sessions; ++i) {
+      expect(!::socketpair(AF_UNIX, SOCK_STREAM, 0, &fds[i * 2]));
+      sms.emplace_back(channels[i]);
+      expect(reactor.add<data_ready, none, peer_closed>(fds[i * 2], sms.back()));
+    }
+    for (auto i = 0; i < sessions; ++i) {
+      expect(1 == ::write(fds[i * 2 + 1], "x", 1));
+    }
+
+    std::size_t processed = 0;
+    while (processed < sessions) {
+      const auto n = reactor.run_once(100);
+      expect(n <= 8u);
+      processed += n;
+    }
+    expect(sessions == static_cast<int>(processed));
+
+    for (auto i = 0; i < sessions; ++i) {
+      ::close(fds[i * 2 + 1]);
+    }
+    while (reactor.size()) {
+      reactor.run_once(100);
+    }
+    auto all = true;
+    for (auto i = 0; i < sessions; ++i) {
+      all &= 1 == channels[i].bytes && sms[i].is(disconnected);
+      ::close(fds[i * 2]);
+    }
+    expect(all);
+  }
+};
+
+test reactor_skips_removed_descriptors = [] {
+  struct remover {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        *connected + event<data_ready> / [](channel& c, std::vector<int>& fds) {
+            ++c.bytes;
+            for (const auto fd : fds) {
+              c.reactor.remove(fd);
+            }
+          }
+      );
+      // clang-format on
+    }
+  };
+
+  for (const auto backend : backends()) {
+    sml::utility::reactor reactor{{backend}};
+    int a[2], b[2];
+    expect(!::pipe(a));
+    expect(!::pipe(b));
+    std::vector<int> fds{a[0], b[0]};
+    channel c{reactor};
+    sml::sm<remover> sm{c, fds};
+    expect(reactor.add<data_ready>(a[0], sm));
+    expect(reactor.add<data_ready>(b[0], sm));
+    expect(1 == ::write(a[1], "x", 1));
+    expect(1 == ::write(b[1], "x", 1));
+    ::usleep(1000);
+
+    expect(1u == reactor.run_once(100));  // the other one was removed by the first handler
+    expect(1 == c.bytes);
+    expect(0u == reactor.size());
+
+    expect(reactor.add<data_ready>(b[0], sm));  // re-registered, stale readiness is skipped
+    expect(1u == reactor.run_once(100));
+    expect(2 == c.bytes);
+    for (const auto fd : {a[0], a[1], b[0], b[1]}) {
+      ::close(fd);
+    }
+  }
+};
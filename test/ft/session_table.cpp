@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/session_table.hpp"
+#include <boost/sml.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct open {};
+struct data {
+  int bytes{};
+};
+struct disconnect {};
+
+struct stats {
+  int bytes = 0;
+};
+
+struct session {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *"idle"_s + event<open> = "connected"_s,
+       "connected"_s + event<data> / [](const data& d, stats& s) { s.bytes += d.bytes; },
+       "connected"_s + event<disconnect> = X
+    );
+    // clang-format on
+  }
+};
+
+test session_table_dispatch_to_keyed_sessions = [] {
+  using namespace sml;
+  stats s{};
+  utility::session_table<sm<session>, std::uint64_t> sessions{};
+  expect(sessions.empty());
+
+  sessions.emplace(1, s);
+  sessions.emplace(2, s);
+  expect(2u == sessions.size());
+  expect(&sessions.emplace(1, s) == sessions.find(1));
+  expect(2u == sessions.size());
+
+  expect(sessions.dispatch(1, open{}));
+  expect(sessions.find(1)->is("connected"_s));
+  expect(sessions.find(2)->is("idle"_s));
+  expect(!sessions.dispatch(3, open{}));
+  expect(!sessions.find(3));
+
+  expect(sessions.dispatch(1, data{42}));
+  expect(!sessions.dispatch(2, data{1}));
+  expect(42 == s.bytes);
+
+  expect(sessions.erase(2));
+  expect(!sessions.erase(2));
+  expect(1u == sessions.size());
+};
+
+test session_table_reclaim_terminated_sessions = [] {
+  using namespace sml;
+  stats s{};
+  utility::session_table<sm<session>, std::uint64_t> sessions{};
+  sessions.emplace(7, s);
+  sessions.dispatch(7, open{});
+  expect(sessions.dispatch(7, disconnect{}));
+  expect(!sessions.find(7));
+  expect(sessions.empty());
+
+  sessions.emplace(7, s);
+  expect(sessions.find(7)->is("idle"_s));
+};
+
+test session_table_reclaim_sessions_once_all_regions_are_terminated = [] {
+  struct detach {};
+
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        *"connected"_s + event<disconnect> = X,
+        *"attached"_s + event<detach> = X
+      );
+      // clang-format on
+    }
+  };
+
+  using namespace sml;
+  utility::session_table<sm<c>, std::uint64_t> sessions{};
+  sessions.emplace(7);
+  expect(sessions.dispatch(7, disconnect{}));
+  expect(sessions.find(7));
+  expect(sessions.find(7)->is(X));
+
+  expect(sessions.dispatch(7, detach{}));
+  expect(!sessions.find(7));
+  expect(sessions.empty());
+};
+
+test session_table_dispatch_or_create = [] {
+  using namespace sml;
+  stats s{};
+  utility::session_table<sm<session>, std::uint64_t> sessions{};
+  auto created = 0;
+  const auto create = [&](utility::session_table<sm<session>, std::uint64_t>& table, const std::uint64_t key) {
+    ++created;
+    table.emplace(key, s);
+  };
+
+  expect(sessions.dispatch_or_create(1, open{}, create));
+  expect(1 == created);
+  expect(sessions.find(1)->is("connected"_s));
+
+  expect(!sessions.dispatch_or_create(1, open{}, create));
+  expect(1 == created);
+  expect(sessions.dispatch_or_create(1, data{42}, create));
+  expect(42 == s.bytes);
+  expect(!sessions.dispatch_or_create(2, data{1}, create));
+  expect(2 == created);
+  expect(sessions.find(2)->is("idle"_s));
+  expect(42 == s.bytes);
+};
+
+test session_table_grow_keeps_sessions = [] {
+  using namespace sml;
+  constexpr auto n = 10'000u;
+  stats s{};
+  utility::session_table<sm<session>, std::uint64_t> sessions{};
+  for (auto i = 0u; i < n; ++i) {
+    sessions.emplace(i, s);
+    if (i % 2) {
+      sessions.dispatch(i, open{});
+    }
+  }
+  expect(n == sessions.size());
+  expect(sessions.capacity() * 7 >= n * 8);
+  for (auto i = 0u; i < n; ++i) {
+    expect(i % 2 ? sessions.find(i)->is("connected"_s) : sessions.find(i)->is("idle"_s));
+  }
+
+  for (auto i = 1u; i < n; i += 2) {
+    sessions.dispatch(i, disconnect{});
+  }
+  expect(n / 2 == sessions.size());
+  for (auto i = 0u; i < n; ++i) {
+    expect(!(i % 2) == !!sessions.find(i));
+  }
+};
+
+test session_table_batch_dispatch = [] {
+  using namespace sml;
+  stats s{};
+  utility::session_table<sm<session>, std::uint64_t> sessions{100};
+  for (auto i = 0u; i < 100; ++i) {
+    sessions.emplace(i * 1'000'003, s);
+  }
+
+  std::vector<std::uint64_t> keys{};
+  std::vector<data> events{};
+  for (auto i = 0u; i < 100; ++i) {
+    sessions.dispatch(i * 1'000'003, open{});
+  }
+  for (auto i = 0u; i < 1'000; ++i) {
+    keys.push_back((i * 7 % 101) * 1'000'003);
+    events.push_back(data{1});
+  }
+
+  expect(990u == sessions.dispatch(keys.begin(), keys.end(), events.begin()));
+  expect(990 == s.bytes);
+};
@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/sharded_runtime.hpp"
+#include <boost/sml.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct connect {};
+struct data {
+  int bytes{};
+};
+struct disconnect {};
+struct hop {
+  int left{};
+};
+
+struct session;
+using runtime_t = sml::utility::sharded_runtime<sml::sm<session>, std::uint64_t>;
+
+struct router {
+  void forward(const hop&);
+
+  runtime_t* runtime = nullptr;
+  std::uint64_t keys = 1;
+  std::atomic<std::uint64_t> next{0};
+};
+
+struct stats {
+  std::atomic<int> connections{0};
+  std::atomic<int> bytes{0};
+  std::atomic<int> hops{0};
+  std::atomic<int> rejected{0};
+};
+
+struct session {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *"idle"_s + event<connect> / [](stats& s) { ++s.connections; } = "connected"_s,
+       "connected"_s + event<data> / [](const data& d, stats& s) { s.bytes += d.bytes; },
+       "connected"_s + event<connect> [([](stats& s) { ++s.rejected; return false; })],
+       "connected"_s + event<disconnect> = X,
+       "idle"_s + event<hop> / [](const hop& h, stats& s, router& r) { ++s.hops; r.forward(h); }
+    );
+    // clang-format on
+  }
+};
+
+void router::forward(const hop& h) {
+  if (h.left) {
+    runtime->post(next++ % keys, hop{h.left - 1});
+  }
+}
+
+test sharded_runtime_parse_cpu_list = [] {
+  using sml::utility::detail::parse_cpu_list;
+  expect(parse_cpu_list("").empty());
+  expect((std::vector<int>{0}) == parse_cpu_list("0\n"));
+  expect((std::vector<int>{0, 1, 2, 3, 8, 10, 11}) == parse_cpu_list("0-3,8,10-11"));
+};
+
+test sharded_runtime_topology = [] {
+  stats s{};
+  router r{};
+  sml::utility::sharded_runtime_options options{};
+  options.shards_per_node = 2;
+  runtime_t runtime{options, s, r};
+  expect(runtime.nodes() >= 1u);
+  expect(runtime.shards() == 2 * runtime.nodes());
+  for (auto i = 0u; i < runtime.shards(); ++i) {
+    expect(runtime.node_of_shard(i) == i / 2);
+    expect(runtime.cpus(i) == runtime.cpus(i / 2 * 2));
+  }
+
+  options.shards_per_node = 1;
+  options.max_nodes = 1;
+  runtime_t single{options, s, r};
+  expect(1u == single.nodes());
+  expect(1u == single.shards());
+  expect(0u == single.shard_of(42));
+};
+
+test sharded_runtime_sessions_by_key = [] {
+  using namespace sml;
+  constexpr auto senders = 4;
+  constexpr auto keys = 256;
+  stats s{};
+  router r{};
+  utility::sharded_runtime_options options{};
+  options.shards_per_node = 4;
+  options.channel_capacity = 16;
+  runtime_t runtime{options, s, r};
+
+  std::vector<std::thread> threads{};
+  for (auto t = 0; t < senders; ++t) {
+    threads.emplace_back([&runtime, t] {
+      for (auto key = t; key < keys; key += senders) {
+        runtime.post(key, connect{});
+        runtime.post(key, data{key});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  runtime.wait_idle();
+
+  expect(keys == s.connections);
+  expect(keys * (keys - 1) / 2 == s.bytes);
+  expect(keys == static_cast<int>(runtime.sessions()));
+  auto connected = true;
+  for (auto key = 0; key < keys; ++key) {
+    const auto sm = runtime.find(key);
+    connected &= sm && sm->is("connected"_s);
+  }
+  expect(connected);
+
+  for (auto key = 0; key < keys; key += 2) {
+    runtime.post(key, disconnect{});
+  }
+  runtime.wait_idle();
+  expect(keys / 2 == static_cast<int>(runtime.sessions()));
+  expect(!runtime.find(0));
+  expect(nullptr != runtime.find(1));
+
+  runtime.post(1, connect{});
+  runtime.wait_idle();
+  expect(keys == s.connections);
+  expect(1 == s.rejected);
+};
+
+test sharded_runtime_cross_shard_events = [] {
+  constexpr auto chains = 64;
+  constexpr auto length = 100;
+  stats s{};
+  router r{};
+  r.keys = 32;
+  sml::utility::sharded_runtime_options options{};
+  options.shards_per_node = 4;
+  options.channel_capacity = 2;  // forces the overflow of workers
+  runtime_t runtime{options, s, r};
+  r.runtime = &runtime;
+
+  for (auto i = 0; i < chains; ++i) {
+    runtime.post(i % r.keys, hop{length - 1});
+  }
+  runtime.wait_idle();
+  expect(chains * length == s.hops);
+  expect(r.keys == runtime.sessions());
+};
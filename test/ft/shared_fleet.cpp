@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/shared_fleet.hpp"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/sml.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct open_session {};
+struct packet {
+  int bytes{};
+};
+struct close_session {};
+
+struct session_data {
+  long bytes;
+  int packets;
+};
+
+const auto idle = sml::state<class idle>;
+const auto established = sml::state<class established>;
+const auto closed = sml::state<class closed>;
+
+struct session {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *idle + event<open_session> = established,
+       established + event<packet> / [](const packet& p, sml::utility::shared_instance<session_data>& self) {
+           self.data->bytes += p.bytes;
+           ++self.data->packets;
+         },
+       established + event<close_session> = closed
+    );
+    // clang-format on
+  }
+};
+
+using sessions_t = sml::utility::shared_fleet<sml::sm<session>, session_data>;
+
+int wait_for(const pid_t pid) {
+  int status{};
+  ::waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+test shared_fleet_is_shared_by_processes = [] {
+  constexpr auto size = 1000;
+  constexpr auto workers = 4;
+  const auto fd = ::memfd_create("sessions", 0);
+  expect(fd >= 0);
+  sml::utility::shared_segment segment{fd, sessions_t::segment_size(size)};
+  expect(static_cast<bool>(segment));
+  sessions_t sessions{segment.data(), segment.size(), size};
+  expect(sessions.valid());
+  expect(!sessions.attached());
+  expect(size == static_cast<int>(sessions.size()));
+  for (auto i = 0; i < size; ++i) {
+    sessions.process_event(i, open_session{});
+  }
+
+  std::vector<pid_t> pids{};
+  for (auto w = 0; w < workers; ++w) {
+    if (const auto pid = ::fork()) {
+      pids.push_back(pid);
+      continue;
+    }
+    sml::utility::shared_segment mapping{fd, sessions_t::segment_size(size)};  // mapped at a different address
+    sessions_t attached{mapping.data(), mapping.size(), 0};
+    auto ok = attached.valid() && attached.attached() && size == static_cast<int>(attached.size());
+    for (auto n = 0; n < 100; ++n) {
+      for (auto i = 0; i < size; ++i) {
+        ok &= attached.process_event(i, packet{w + 1});
+      }
+    }
+    ::_exit(ok ? 0 : 1);
+  }
+  for (const auto pid : pids) {
+    expect(0 == wait_for(pid));
+  }
+
+  auto all = true;
+  for (auto i = 0; i < size; ++i) {
+    all &= sessions.is(i, established) && 100 * workers == sessions.data(i).packets &&
+           100 * (1 + 2 + 3 + 4) == sessions.data(i).bytes && !sessions.owner(i);
+  }
+  expect(all);
+  ::close(fd);
+};
+
+test shared_fleet_reattaches_after_restart = [] {
+  constexpr auto size = 100;
+  const auto fd = ::memfd_create("sessions", 0);
+  {
+    sml::utility::shared_segment segment{fd, sessions_t::segment_size(size)};
+    sessions_t sessions{segment.data(), segment.size(), size};
+    sessions.process_event(1, open_session{});
+    sessions.process_event(1, packet{42});
+    sessions.process_event(2, open_session{});
+    sessions.process_event(2, close_session{});
+  }
+
+  sml::utility::shared_segment segment{fd, sessions_t::segment_size(size)};
+  sessions_t sessions{segment.data(), segment.size(), size};
+  expect(sessions.attached());
+  expect(sessions.is(0, idle));
+  expect(sessions.is(1, established));
+  expect(42 == sessions.data(1).bytes);
+  expect(sessions.is(2, closed));
+
+  struct other {
+    auto operator()() const {
+      using namespace sml;
+      return make_transition_table(*idle + event<open_session> = closed);
+    }
+  };
+  sml::utility::shared_fleet<sml::sm<other>, session_data> different{segment.data(), segment.size(), size};
+  expect(!different.valid());
+
+  const auto small_fd = ::memfd_create("small", 0);
+  sml::utility::shared_segment small{small_fd, sessions_t::segment_size(size) - 1};
+  sessions_t too_small{small.data(), small.size(), size};
+  expect(!too_small.valid());
+  ::close(small_fd);
+  ::close(fd);
+};
+
+test shared_fleet_takes_over_initialization_of_crashed_creator = [] {
+  using namespace sml::utility::detail;
+  auto status = static_cast<std::uint32_t *>(
+      ::mmap(nullptr, sizeof(std::uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+  *status = 0;
+
+  const auto creator = ::fork();
+  if (!creator) {
+    ::_exit(acquire_segment(status) ? 0 : 1);  // crashes before the segment is initialized
+  }
+  expect(0 == wait_for(creator));
+  expect((segment_initializing | static_cast<std::uint32_t>(creator)) == *status);
+
+  expect(acquire_segment(status));
+  expect((segment_initializing | static_cast<std::uint32_t>(::getpid())) == *status);
+  release_segment(status, 2);
+
+  const auto attaching = ::fork();
+  if (!attaching) {
+    ::_exit(acquire_segment(status) ? 1 : 0);
+  }
+  expect(0 == wait_for(attaching));
+  ::munmap(status, sizeof(std::uint32_t));
+};
+
+test shared_fleet_locks_instances = [] {
+  constexpr auto size = 10;
+  const auto fd = ::memfd_create("sessions", 0);
+  sml::utility::shared_segment segment{fd, sessions_t::segment_size(size)};
+  sessions_t sessions{segment.data(), segment.size(), size};
+  sessions.process_event(3, open_session{});
+
+  int ready[2];
+  expect(!::pipe(ready));
+  const auto holder = ::fork();
+  if (!holder) {
+    sml::utility::shared_segment mapping{fd, sessions_t::segment_size(size)};
+    sessions_t attached{mapping.data(), mapping.size(), 0};
+    attached.lock(3);
+    attached.lock(4);
+    ::write(ready[1], "x", 1);
+    ::usleep(50000);
+    attached.process_event_locked(3, packet{7});
+    attached.unlock(3);
+    ::_exit(0);  // crashes holding the lock of the instance 4
+  }
+  char c{};
+  expect(1 == ::read(ready[0], &c, 1));
+  expect(holder == sessions.owner(3));
+  expect(!sessions.try_lock(3));
+  sessions.process_event(3, packet{1});  // waits for the holder
+  expect(2 == sessions.data(3).packets);
+  expect(8 == sessions.data(3).bytes);
+
+  expect(0 == wait_for(holder));
+  expect(holder == sessions.owner(4));
+  expect(1u == sessions.recover());
+  expect(!sessions.owner(4));
+  expect(sessions.try_lock(4));
+  sessions.unlock(4);
+  ::close(ready[0]);
+  ::close(ready[1]);
+  ::close(fd);
+};
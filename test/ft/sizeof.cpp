@@ -478,4 +478,38 @@ test sm_sizeof_more_than_256_transitions = [] {
   };
   static_expect(2 /*current_state=2*/ == sizeof(sml::sm<c>));
 };
+
+test sm_sizeof_shared_transitions = [] {
+  struct limits {
+    int min;
+    int max;
+  };
+
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      constexpr limits l{1, 42};
+      // clang-format off
+      return make_transition_table(
+        *"idle"_s + "event1"_e [([l] { return l.min > 0; })] / [l] { (void)l; } = "s1"_s,
+         "s1"_s + "event2"_e [([l] { return l.max > 0; })] / [l] { (void)l; } = X
+      );
+      // clang-format on
+    }
+  };
+
+  static_expect(4 * sizeof(limits) < sizeof(sml::sm<c>));
+  static_expect(1 /*current_state=1*/ == sizeof(sml::sm<c, sml::shared_transitions>));
+
+  using namespace sml;
+  sml::sm<c, sml::shared_transitions> sm1{};
+  sml::sm<c, sml::shared_transitions> sm2{};
+  sm1.process_event("event1"_e());
+  expect(sm1.is("s1"_s));
+  expect(sm2.is("idle"_s));
+  sm2.process_event("event1"_e());
+  sm2.process_event("event2"_e());
+  expect(sm1.is("s1"_s));
+  expect(sm2.is(X));
+};
 #endif
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/sm_pool.hpp"
+#include <boost/sml.hpp>
+
+namespace sml = boost::sml;
+
+struct connect {};
+struct data {
+  int bytes{};
+};
+struct disconnect {};
+
+struct stats {
+  int connections = 0;
+  int bytes = 0;
+};
+
+struct session {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *"idle"_s + event<connect> / [](stats& s) { ++s.connections; } = "connected"_s,
+       "connected"_s + event<data> / [](const data& d, stats& s) { s.bytes += d.bytes; },
+       "connected"_s + event<disconnect> = X
+    );
+    // clang-format on
+  }
+};
+
+test sm_pool_reuses_reset_instances = [] {
+  using namespace sml;
+  stats s{};
+  utility::sm_pool<sm<session>> sessions{2, s};
+  expect(2u == sessions.size());
+  expect(2u == sessions.available());
+
+  const sm<session>* first = nullptr;
+  {
+    auto session = sessions.acquire();
+    first = session.get();
+    expect(1u == sessions.available());
+    expect(session->is("idle"_s));
+    session->process_event(connect{});
+    session->process_event(data{42});
+    expect(session->is("connected"_s));
+  }
+  expect(2u == sessions.available());
+  expect(1 == s.connections);
+  expect(42 == s.bytes);
+
+  auto session = sessions.acquire();
+  expect(first == session.get());
+  expect(session->is("idle"_s));
+  session->process_event(connect{});
+  session->process_event(disconnect{});
+  expect(session->is(X));
+  expect(2 == s.connections);
+};
+
+test sm_pool_grows_when_empty = [] {
+  using namespace sml;
+  stats s{};
+  utility::sm_pool<sm<session>> sessions{1, s};
+  auto session1 = sessions.acquire();
+  auto session2 = sessions.acquire();
+  expect(2u == sessions.size());
+  expect(0u == sessions.available());
+  expect(session1.get() != session2.get());
+  session2->process_event(connect{});
+  expect(1 == s.connections);
+
+  session1.reset();
+  session2.reset();
+  expect(2u == sessions.available());
+
+  sessions.reserve(4);
+  expect(4u == sessions.size());
+  expect(4u == sessions.available());
+};
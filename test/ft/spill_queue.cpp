@@ -0,0 +1,255 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/spill_queue.hpp"
+#include <boost/sml.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace sml = boost::sml;
+
+struct e1 {
+  int value{};
+};
+struct e2 {
+  std::string text{};
+};
+struct e3 {};
+struct e4 {
+  explicit e4(const int value = 0) : value{value} { ++live; }
+  e4(const e4 &other) : value{other.value} { ++live; }
+  e4(e4 &&other) : value{other.value} { ++live; }
+  ~e4() { --live; }
+  int value{};
+  static int live;
+};
+int e4::live = 0;
+
+const auto idle = sml::state<class idle>;
+const auto s1 = sml::state<class s1>;
+const auto s2 = sml::state<class s2>;
+
+struct codec {
+  std::size_t size(const e1 &) const { return sizeof(int); }
+  std::size_t size(const e2 &e) const { return e.text.size(); }
+  std::size_t size(const e3 &) const { return 0; }
+  std::size_t size(const e4 &) const { return sizeof(int); }
+
+  void encode(const e1 &e, void *out) const {
+    ++*encoded;
+    std::memcpy(out, &e.value, sizeof(int));
+  }
+  void encode(const e2 &e, void *out) const {
+    ++*encoded;
+    std::memcpy(out, e.text.data(), e.text.size());
+  }
+  void encode(const e3 &, void *) const { ++*encoded; }
+  void encode(const e4 &e, void *out) const {
+    ++*encoded;
+    std::memcpy(out, &e.value, sizeof(int));
+  }
+
+  template <class T>
+  T decode(const void *data, std::size_t size) const {
+    return decode(data, size, sml::aux::type<T>{});
+  }
+
+  e1 decode(const void *data, std::size_t, sml::aux::type<e1>) const {
+    e1 e{};
+    std::memcpy(&e.value, data, sizeof(int));
+    return e;
+  }
+  e2 decode(const void *data, std::size_t size, sml::aux::type<e2>) const {
+    return e2{std::string(static_cast<const char *>(data), size)};
+  }
+  e3 decode(const void *, std::size_t, sml::aux::type<e3>) const { return {}; }
+  e4 decode(const void *data, std::size_t, sml::aux::type<e4>) const {
+    auto value = 0;
+    std::memcpy(&value, data, sizeof(int));
+    return e4{value};
+  }
+
+  int *encoded{};
+};
+
+test spill_defer_queue_in_order = [] {
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * idle + event<e1> / defer
+        , idle + event<e2> / defer
+        , idle + event<e3> = s1
+        , s1 + event<e1> / [this](const e1& e) { values.push_back(std::to_string(e.value)); }
+        , s1 + event<e2> / [this](const e2& e) { values.push_back(e.text); }
+      );
+      // clang-format on
+    }
+
+    std::vector<std::string> values{};
+  };
+
+  auto encoded = 0;
+  sml::utility::spill_options<codec> options{};
+  options.high_water_mark = 2;
+  options.capacity = 64;
+  options.codec.encoded = &encoded;
+
+  sml::sm<c, sml::defer_queue<sml::utility::spill_queue<codec>::type, sml::utility::spill_options<codec>>> sm{options};
+
+  std::vector<std::string> expected{};
+  for (auto i = 0; i < 100; ++i) {
+    if (i % 3) {
+      sm.process_event(e1{i});
+    } else {
+      sm.process_event(e2{std::string(i, 'x')});
+    }
+    expected.push_back(i % 3 ? std::to_string(i) : std::string(i, 'x'));
+  }
+  expect(100 == encoded);  // the in-memory events are spilled as well once the high water mark is reached
+
+  sm.process_event(e3{});
+  expect(sm.is(s1));
+
+  const c &c_ = sm;
+  expect(expected == c_.values);
+};
+
+test spill_defer_queue_defer_again = [] {
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * idle + event<e1> / defer
+        , idle + event<e2> / defer
+        , idle + event<e3> = s1
+        , s1 + event<e1> / defer
+        , s1 + event<e2> / [this](const e2& e) { values.push_back(e.text); }
+        , s1 + event<e3> = s2
+        , s2 + event<e1> / [this](const e1& e) { values.push_back(std::to_string(e.value)); }
+      );
+      // clang-format on
+    }
+
+    std::vector<std::string> values{};
+  };
+
+  auto encoded = 0;
+  sml::utility::spill_options<codec> options{};
+  options.high_water_mark = 4;
+  options.capacity = 64;
+  options.codec.encoded = &encoded;
+
+  sml::sm<c, sml::defer_queue<sml::utility::spill_queue<codec>::type, sml::utility::spill_options<codec>>> sm{options};
+
+  for (auto i = 0; i < 4; ++i) {
+    sm.process_event(e1{i});
+  }
+  for (auto i = 0; i < 4; ++i) {
+    sm.process_event(e2{std::string(i + 1, 'x')});
+  }
+  expect(8 == encoded);
+
+  sm.process_event(e3{});
+  expect(sm.is(s1));
+
+  const c &c_ = sm;
+  expect(std::vector<std::string>{"x", "xx", "xxx", "xxxx"} == c_.values);
+
+  sm.process_event(e3{});
+  expect(sm.is(s2));
+  expect(std::vector<std::string>{"x", "xx", "xxx", "xxxx", "0", "1", "2", "3"} == c_.values);
+};
+
+test spill_defer_queue_stays_bounded_when_every_event_is_deferred = [] {
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        * idle + event<e4> / defer
+        , idle + event<e3> = s1
+        , s1 + event<e4> / [this](const e4& e) { values.push_back(e.value); }
+      );
+      // clang-format on
+    }
+
+    std::vector<int> values{};
+  };
+
+  constexpr auto events = 1000;
+  auto encoded = 0;
+  sml::utility::spill_options<codec> options{};
+  options.high_water_mark = 2;
+  options.capacity = 64;
+  options.codec.encoded = &encoded;
+
+  {
+    sml::sm<c, sml::defer_queue<sml::utility::spill_queue<codec>::type, sml::utility::spill_options<codec>>> sm{options};
+
+    std::vector<int> expected{};
+    auto max_live = 0;
+    for (auto i = 0; i < events; ++i) {
+      sm.process_event(e4{i});
+      max_live = e4::live > max_live ? e4::live : max_live;
+      expected.push_back(i);
+    }
+    expect(max_live <= 2);  // every event is deferred again, but only the window is decoded
+    expect(events == encoded);
+
+    sm.process_event(e3{});
+    expect(sm.is(s1));
+    const c &c_ = sm;
+    expect(expected == c_.values);
+  }
+  expect(0 == e4::live);
+};
+
+test spill_queue_window = [] {
+  using queue_t = sml::utility::spill_queue<codec>::type<sml::back::queue_event<e1>>;
+  constexpr auto events = 1000;
+  auto encoded = 0;
+  sml::utility::spill_options<codec> options{};
+  options.high_water_mark = 2;
+  options.capacity = 64;
+  options.codec.encoded = &encoded;
+  queue_t queue{options};
+
+  for (auto i = 0; i < events; ++i) {
+    queue.push_back(e1{i});
+    expect(queue.resident() <= 2);
+  }
+  expect(std::size_t(events) == queue.size());
+  expect(std::size_t(events) == queue.spilled());
+
+  // every event is deferred again
+  auto visited = 0;
+  queue_t::const_iterator it = queue.begin();
+  auto end = queue.end();
+  while (it != end) {
+    expect(visited++ == reinterpret_cast<const e1 *>(it->data)->value);
+    if (++it == end && refill(queue, it)) {
+      end = queue.end();
+    }
+    expect(queue.resident() <= 2);
+  }
+  expect(events == visited);
+  expect(std::size_t(events) == queue.spilled());
+
+  for (auto i = 0; i < events; ++i) {
+    expect(i == reinterpret_cast<const e1 *>(queue.begin()->data)->value);
+    queue.erase(queue.begin());
+    expect(queue.resident() <= 2);
+    expect(queue.spilled() <= std::size_t(events - i - 1));
+  }
+  expect(queue.empty());
+  expect(0u == queue.size());
+  expect(events == encoded);
+};
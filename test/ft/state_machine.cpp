@@ -7,9 +7,14 @@
 //
 #include <array>
 #include <boost/sml.hpp>
+#include <deque>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
+#if __has_include(<variant>)
+#include <variant>
+#endif
 
 namespace sml = boost::sml;
 
@@ -171,6 +176,63 @@ test sm_move_assignment = [] {
   expect(sm2.is("B"_s));
 };
 
+test sm_reset = [] {
+  struct sub {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        "S1"_s(H) + "e1"_e = "S2"_s
+      );
+      // clang-format on
+    }
+  };
+
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        *"A"_s + on_entry<_> / [this] { ++entries; }
+        ,"A"_s + "e1"_e = state<sub>
+        ,"A"_s + "e3"_e / defer
+        ,state<sub> + "e2"_e = "A"_s
+        ,state<sub> + "e3"_e = "C"_s
+      );
+      // clang-format on
+    }
+
+    int entries = 0;
+  };
+
+  using namespace sml;
+  sml::sm<c, sml::defer_queue<std::deque>> sm{};
+  const c& data = sm;
+  expect(1 == data.entries);
+
+  sm.process_event("e3"_e());
+  sm.process_event("e1"_e());
+  expect(sm.is("C"_s));
+  sm.reset();
+  expect(sm.is("A"_s));
+  expect(2 == data.entries);
+
+  sm.process_event("e3"_e());  // deferred
+  sm.process_event("e1"_e());  // processes deferred e3
+  expect(sm.is("C"_s));
+
+  sm.reset();
+  sm.process_event("e1"_e());
+  sm.process_event("e1"_e());
+  sm.process_event("e2"_e());
+  expect(sm.is<decltype(state<sub>)>("S2"_s));  // history
+  sm.reset();
+  expect(sm.is("A"_s));
+  expect(sm.is<decltype(state<sub>)>("S1"_s));
+  sm.process_event("e1"_e());
+  expect(sm.is<decltype(state<sub>)>("S1"_s));
+};
+
 test sm_events = [] {
   struct c {
     auto operator()() noexcept {
@@ -218,6 +280,40 @@ test sm_lambda_expr = [] {
   expect(sm.is(idle));
 };
 
+test sm_process_events = [] {
+  struct packet {
+    int bytes{};
+  };
+  struct flush {};
+  struct c {
+    auto operator()() noexcept {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        *idle + event<packet> [([](const packet& p) { return p.bytes > 0; })] / [](const packet& p, std::vector<int>& b) {
+            b.push_back(p.bytes);
+          },
+         idle + event<flush> / [](std::vector<int>& b) { b.push_back(0); } = X
+      );
+      // clang-format on
+    }
+  };
+
+  std::vector<int> bytes{};
+  sml::sm<c> sm{bytes};
+  const std::vector<packet> packets{{1}, {0}, {2}, {-1}, {3}};
+  expect(3 == sm.process_events(packets.begin(), packets.end()));
+  expect((std::vector<int>{1, 2, 3}) == bytes);
+  expect(0 == sm.process_events(packets.end(), packets.end()));
+
+#if defined(__cpp_lib_variant)
+  const std::vector<std::variant<packet, flush>> events{packet{4}, flush{}, packet{5}};
+  expect(2 == sm.process_events(events.begin(), events.end()));  // run to completion, `packet{5}` is unexpected in X
+  expect((std::vector<int>{1, 2, 3, 4, 0}) == bytes);
+  expect(sm.is(sml::X));
+#endif
+};
+
 #if !defined(_MSC_VER)
 test sm_current_state = [] {
   struct c {
@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2016-2019 Kris Jusiak (kris at jusiak dot net)
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "boost/sml/utility/timing_wheel.hpp"
+#include <boost/sml.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace sml = boost::sml;
+using namespace std::chrono_literals;
+
+using timing_wheel = sml::utility::timing_wheel<>;
+using time_point = timing_wheel::time_point;
+
+struct probe : timing_wheel::timer {
+  static void expired(timing_wheel::timer &t) {
+    auto &p = static_cast<probe &>(t);
+    p.expired_at = p.wheel->now();
+    ++p.expirations;
+  }
+
+  timing_wheel *wheel = nullptr;
+  time_point expired_at{};
+  int expirations = 0;
+};
+
+test timing_wheel_expires_timers_on_time = [] {
+  const auto t0 = time_point{};
+  timing_wheel wheel{1ms, t0};
+  probe timers[5]{};
+  const std::chrono::milliseconds timeouts[] = {1ms, 63ms, 64ms, 5000ms, 3600s};
+  for (auto i = 0; i < 5; ++i) {
+    timers[i].wheel = &wheel;
+    wheel.arm(timers[i], timeouts[i], &probe::expired);
+    expect(timers[i].armed());
+  }
+
+  expect(0u == wheel.tick(t0 + 500us));
+  expect(1u == wheel.tick(t0 + 1ms));
+  expect(t0 + 1ms == timers[0].expired_at);
+  expect(!timers[0].armed());
+
+  expect(1u == wheel.tick(t0 + 63ms));
+  expect(1u == wheel.tick(t0 + 64ms));
+  expect(0u == wheel.tick(t0 + 4999ms));
+  expect(1u == wheel.tick(t0 + 5001ms));
+  expect(1u == wheel.tick(t0 + 3601s));
+  for (auto i = 0; i < 5; ++i) {
+    expect(1 == timers[i].expirations);
+    expect(t0 + timeouts[i] == timers[i].expired_at);
+  }
+};
+
+test timing_wheel_cancels_timers = [] {
+  const auto t0 = time_point{};
+  timing_wheel wheel{1ms, t0};
+  probe cancelled{}, rearmed{};
+  cancelled.wheel = rearmed.wheel = &wheel;
+  wheel.arm(cancelled, 10ms, &probe::expired);
+  wheel.arm(rearmed, 10ms, &probe::expired);
+  {
+    probe destroyed{};
+    wheel.arm(destroyed, 10ms, &probe::expired);
+  }
+  wheel.cancel(cancelled);
+  expect(!cancelled.armed());
+  wheel.tick(t0 + 5ms);
+  wheel.arm(rearmed, 10ms, &probe::expired);
+  expect(0u == wheel.tick(t0 + 10ms));
+  expect(1u == wheel.tick(t0 + 15ms));
+  expect(0 == cancelled.expirations);
+  expect(t0 + 15ms == rearmed.expired_at);
+};
+
+test timing_wheel_random_timers = [] {
+  constexpr auto timers_count = 10000;
+  const auto t0 = time_point{};
+  timing_wheel wheel{1ms, t0};
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> timeout{1, 1 << 20};
+  std::vector<probe> timers(timers_count);
+  std::vector<std::chrono::milliseconds> deadlines{};
+  for (auto &t : timers) {
+    t.wheel = &wheel;
+    deadlines.emplace_back(timeout(gen));
+    wheel.arm(t, deadlines.back(), &probe::expired);
+  }
+
+  std::uniform_int_distribution<int> step{1, 5000};
+  auto now = t0;
+  std::size_t expired = 0;
+  while (now < t0 + std::chrono::milliseconds{1 << 20}) {
+    now += std::chrono::milliseconds{step(gen)};
+    expired += wheel.tick(now);
+  }
+  expect(timers_count == static_cast<int>(expired));
+  auto on_time = true;
+  for (auto i = 0; i < timers_count; ++i) {
+    on_time &= 1 == timers[i].expirations && t0 + deadlines[i] == timers[i].expired_at;
+  }
+  expect(on_time);
+};
+
+struct connect {};
+struct ping {};
+struct disconnect {};
+
+const auto idle = sml::state<class idle>;
+const auto connecting = sml::state<class connecting>;
+const auto connected = sml::state<class connected>;
+const auto timed_out = sml::state<class timed_out>;
+
+struct stats {
+  int timeouts = 0;
+  int pings = 0;
+};
+
+struct connection {
+  auto operator()() const {
+    using namespace sml;
+    // clang-format off
+    return make_transition_table(
+      *idle + event<connect> = connecting,
+       connecting + after(100ms) / [](stats& s) { ++s.timeouts; } = timed_out,
+       connecting + event<ping> = connected,
+       connected + event<ping> / [](stats& s) { ++s.pings; } = connected,
+       connected + after(1s) = idle,
+       connected + event<disconnect> = idle
+    );
+    // clang-format on
+  }
+};
+
+using connection_sm = sml::sm<connection, sml::timer_service<timing_wheel>>;
+
+test after_transitions = [] {
+  const auto t0 = time_point{};
+  timing_wheel wheel{1ms, t0};
+  stats s{};
+  connection_sm sm{wheel, s};
+
+  sm.process_event(connect{});
+  expect(sm.is(connecting));
+  wheel.tick(t0 + 99ms);
+  expect(sm.is(connecting));
+  wheel.tick(t0 + 100ms);
+  expect(sm.is(timed_out));
+  expect(1 == s.timeouts);
+
+  sm.reset();
+  sm.process_event(connect{});
+  sm.process_event(ping{});
+  expect(sm.is(connected));
+  wheel.tick(t0 + 1000ms);  // the timeout of connecting was cancelled
+  expect(sm.is(connected));
+  expect(1 == s.timeouts);
+
+  sm.process_event(ping{});  // re-entering the state restarts the timer
+  wheel.tick(t0 + 1100ms);
+  expect(sm.is(connected));
+  wheel.tick(t0 + 2000ms);
+  expect(sm.is(idle));
+  expect(1 == s.pings);
+
+  sm.process_event(connect{});
+  sm.process_event(ping{});
+  sm.process_event(disconnect{});
+  wheel.tick(t0 + 10s);
+  expect(sm.is(idle));
+  expect(1 == s.timeouts);
+};
+
+test after_initial_state_and_regions = [] {
+  struct c {
+    auto operator()() const {
+      using namespace sml;
+      // clang-format off
+      return make_transition_table(
+        *"a"_s + after(10ms) = "b"_s,
+         "b"_s + after(10ms) = "a"_s,
+        *"c"_s + event<ping> = "d"_s,
+         "d"_s + after(15ms) = "c"_s
+      );
+      // clang-format on
+    }
+  };
+
+  using namespace sml;
+  const auto t0 = time_point{};
+  timing_wheel wheel{1ms, t0};
+  sml::sm<c, sml::timer_service<timing_wheel>> sm{wheel};
+  expect(sm.is("a"_s, "c"_s));
+  sm.process_event(ping{});
+  wheel.tick(t0 + 10ms);
+  expect(sm.is("b"_s, "d"_s));
+  wheel.tick(t0 + 15ms);
+  expect(sm.is("b"_s, "c"_s));
+  wheel.tick(t0 + 20ms);
+  expect(sm.is("a"_s, "c"_s));
+};
+
+test after_many_state_machines = [] {
+  constexpr auto sms = 10000;
+  const auto t0 = time_point{};
+  timing_wheel wheel{1ms, t0};
+  stats s{};
+  std::deque<connection_sm> connections{};
+  for (auto i = 0; i < sms; ++i) {
+    connections.emplace_back(wheel, s);
+    connections.back().process_event(connect{});
+    if (i % 2) {
+      connections.back().process_event(ping{});
+    }
+  }
+
+  wheel.tick(t0 + 100ms);
+  expect(sms / 2 == s.timeouts);
+  wheel.tick(t0 + 1s);
+  auto all = true;
+  for (auto i = 0; i < sms; ++i) {
+    all &= i % 2 ? connections[i].is(idle) : connections[i].is(timed_out);
+  }
+  expect(all);
+
+  connections.clear();  // armed timers are cancelled by destruction
+  expect(0u == wheel.tick(t0 + 1h));
+};